@@ -1,5 +1,6 @@
 #include <catch2/catch_all.hpp>
 
+#include <algorithm>
 #include <span>
 
 #include <ao/schema/CodecCommon.h>
@@ -12,11 +13,12 @@
 
 #include "../CppTestHelpers.h"
 
-char const baseIr[] =
+unsigned char const baseIr[] =
 #include "simple/AoslCppSimple_messages.aoir.h"
     ;
 constexpr size_t baseIrSize = sizeof(baseIr);
 auto const irSpan = std::span{(std::byte const*)baseIr, baseIrSize};
+auto const& schema = aosl_schema::AoslCppSimple_messages::schema;
 
 // This function is here to ensure add is generated in TestMessage5
 namespace messages {
@@ -102,7 +104,7 @@ TEMPLATE_LIST_TEST_CASE("Simple message round trip 1",
 
         using WS = typename TestType::WS;
         using RS = typename TestType::RS;
-        cppRoundTrip<WS, RS>(irSpan, input, output);
+        cppRoundTrip<WS, RS>(schema, input, output);
 
         REQUIRE(input.value == output.value);
     }
@@ -119,7 +121,7 @@ TEMPLATE_LIST_TEST_CASE("Simple message 2 round trip 1",
 
     using WS = typename TestType::WS;
     using RS = typename TestType::RS;
-    cppRoundTrip<WS, RS>(irSpan, input, output);
+    cppRoundTrip<WS, RS>(schema, input, output);
 
     REQUIRE(input.value == output.value);
 }
@@ -136,7 +138,7 @@ TEMPLATE_LIST_TEST_CASE("Simple message 3 round trip 1",
 
     using WS = typename TestType::WS;
     using RS = typename TestType::RS;
-    cppRoundTrip<WS, RS>(irSpan, input, output);
+    cppRoundTrip<WS, RS>(schema, input, output);
 
     REQUIRE(input.value1 == output.value1);
     REQUIRE(input.value2 == output.value2);
@@ -154,7 +156,7 @@ TEMPLATE_LIST_TEST_CASE("Simple message 4 round trip 1",
 
     using WS = typename TestType::WS;
     using RS = typename TestType::RS;
-    cppRoundTrip<WS, RS>(irSpan, input, output);
+    cppRoundTrip<WS, RS>(schema, input, output);
 
     REQUIRE(input == output);
 }
@@ -186,7 +188,7 @@ TEMPLATE_LIST_TEST_CASE("Simple message 6 round trip 1",
 
         using WS = typename TestType::WS;
         using RS = typename TestType::RS;
-        cppRoundTrip<WS, RS>(irSpan, input, output);
+        cppRoundTrip<WS, RS>(schema, input, output);
 
         REQUIRE(input == output);
     }
@@ -210,7 +212,7 @@ TEMPLATE_LIST_TEST_CASE("Simple message 7 round trip 1",
 
         using WS = typename TestType::WS;
         using RS = typename TestType::RS;
-        cppRoundTrip<WS, RS>(irSpan, input, output);
+        cppRoundTrip<WS, RS>(schema, input, output);
 
         REQUIRE(input == output);
     }
@@ -235,7 +237,7 @@ TEMPLATE_LIST_TEST_CASE("Simple message 7 round trip 2",
 
         using WS = typename TestType::WS;
         using RS = typename TestType::RS;
-        cppRoundTrip<WS, RS>(irSpan, input, output);
+        cppRoundTrip<WS, RS>(schema, input, output);
 
         REQUIRE(input == output);
     }
@@ -259,6 +261,94 @@ TEMPLATE_LIST_TEST_CASE("Composed messages round trip",
 
     using WS = typename TestType::WS;
     using RS = typename TestType::RS;
-    cppRoundTrip<WS, RS>(irSpan, input, output);
+    cppRoundTrip<WS, RS>(schema, input, output);
     REQUIRE(input == output);
 }
+
+TEST_CASE("Generated schema tables match the IR", "[simple]") {
+    ao::pack::byte::ReadStream irRs{irSpan};
+    ao::schema::ir::IR ir;
+    REQUIRE(ao::schema::ir::deserializeIRFile(irRs, ir));
+
+    ao::schema::ErrorContext errs;
+    auto format = ao::schema::vm::generateProgram(ir, errs);
+    REQUIRE(errs.ok());
+    auto codecTable = ao::schema::codec::generateCodecTable(ir);
+
+    REQUIRE(std::ranges::equal(schema.encode.codeWords,
+                               format.encode.codeWords));
+    REQUIRE(std::ranges::equal(schema.encode.typeEntryPc,
+                               format.encode.typeEntryPc));
+    REQUIRE(std::ranges::equal(schema.decode.codeWords,
+                               format.decode.codeWords));
+    REQUIRE(std::ranges::equal(schema.decode.msgEntryPc,
+                               format.decode.msgEntryPc));
+    REQUIRE(schema.codec.types.size() == codecTable.types.size());
+    REQUIRE(schema.codec.fields.size() == codecTable.fields.size());
+    for (size_t i = 0; i < codecTable.fields.size(); ++i) {
+        REQUIRE(schema.codec.fields[i].fieldNumber ==
+                codecTable.fields[i].fieldNumber);
+        REQUIRE(schema.codec.fields[i].typeId == codecTable.fields[i].typeId);
+    }
+
+    for (auto const& [number, id] : format.msgs.messageNumberToId)
+        REQUIRE(schema.getId(number) == id);
+    for (auto const& [name, id] : format.msgs.messageNameToId)
+        REQUIRE(schema.getId(name) == id);
+}
+
+TEST_CASE("Disk decode resets fields missing from the input", "[simple]") {
+    // Writer side table numbering value2 and value1 of TestMessage5
+    ao::schema::codec::CodecTable writerTable;
+    writerTable.fields.push_back({.fieldNumber = 2, .typeId = 0});
+    writerTable.fields.push_back({.fieldNumber = 1, .typeId = 0});
+
+    // value2 comes before value1 and value3 is not written at all
+    std::vector<std::byte> data(1024);
+    ao::pack::byte::WriteStream ws{
+        std::span<std::byte>(data.data(), data.size())};
+    ao::schema::codec::disk::DiskEncodeCodec<ao::pack::byte::WriteStream> enc{
+        writerTable, ws};
+    enc.msgBegin(0);
+    enc.fieldBegin(0);
+    enc.fieldId(0);
+    enc.i64(0, -7);
+    enc.fieldEnd();
+    enc.fieldBegin(1);
+    enc.fieldId(1);
+    enc.u64(0, 11);
+    enc.fieldEnd();
+    enc.msgEnd();
+    REQUIRE(enc.ok());
+
+    messages::TestMessage5 output{
+        .value1 = 1,
+        .value2 = 2,
+        .value3 = 3,
+    };
+    ao::pack::byte::ReadStream rs{
+        std::span<std::byte const>(data.data(), ws.byteSize())};
+    auto decoded = decodeCpp(schema.decode, schema.codec, rs, output);
+    REQUIRE(decoded.error == ao::schema::vm::VMError::Ok);
+    REQUIRE(rs.remainingBytes() == 0);
+    REQUIRE(output.value1 == 11);
+    REQUIRE(output.value2 == -7);
+    REQUIRE_FALSE(output.value3.has_value());
+
+    SECTION("Every field missing") {
+        std::vector<std::byte> empty(1024);
+        ao::pack::byte::WriteStream emptyWs{
+            std::span<std::byte>(empty.data(), empty.size())};
+        ao::schema::codec::disk::DiskEncodeCodec<ao::pack::byte::WriteStream>
+            emptyEnc{writerTable, emptyWs};
+        emptyEnc.msgBegin(0);
+        emptyEnc.msgEnd();
+        REQUIRE(emptyEnc.ok());
+
+        ao::pack::byte::ReadStream emptyRs{
+            std::span<std::byte const>(empty.data(), emptyWs.byteSize())};
+        decoded = decodeCpp(schema.decode, schema.codec, emptyRs, output);
+        REQUIRE(decoded.error == ao::schema::vm::VMError::Ok);
+        REQUIRE(output == messages::TestMessage5{});
+    }
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <optional>
 #include <string>
 #include <variant>
 
@@ -55,8 +56,19 @@ struct IntParseProperties {
     Encoding encoding = ZIGZAG_VARINT;
 };
 
+struct FloatParseProperties {
+    bool parseProperties(ErrorContext& errs, AstTypeProperties const& props);
+    // Quantized floats are sent over the net as
+    // round((value - min) / precision) in the minimum number of bits. All of
+    // min, max and precision must be set to quantize.
+    std::optional<double> min;
+    std::optional<double> max;
+    std::optional<double> precision;
+
+    bool quantized() const { return min && max && precision; }
+};
+
 // TODO add parsing for these later
-struct FloatParseProperties : EmptyParseProperties {};
 struct ArrayParseProperties : EmptyParseProperties {};
 
 }  // namespace detail
@@ -0,0 +1,40 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include <ao/schema/Serializer.h>
+#include <ao/utils/Blake3Hasher.h>
+#include <ao/utils/Crc32cHasher.h>
+#include <ao/utils/Xxh3Hasher.h>
+
+namespace ao::schema {
+// Integrity check of a file or record format, written to its header so a
+// reader knows which hasher to use. BLAKE3 is the only cryptographic one,
+// XXH3-128 and CRC32C only catch corruption but cost far less.
+enum class ChecksumKind : uint8_t {
+    Blake3,
+    Xxh3_128,
+    Crc32c,
+    ChecksumKindMax,
+};
+
+// Calls `f` with a fresh hasher for `kind`. Out of range kinds get BLAKE3,
+// validate them first when they come from disk.
+template <class F>
+decltype(auto) withHasher(ChecksumKind kind, F&& f) {
+    switch (kind) {
+        case ChecksumKind::Xxh3_128:
+            return f(utils::hash::Xxh3Hasher{});
+        case ChecksumKind::Crc32c:
+            return f(utils::hash::Crc32cHasher{});
+        default:
+            return f(utils::hash::Blake3Hasher{});
+    }
+}
+
+template <>
+struct Serializer<ChecksumKind>
+    : public EnumSerializer<ChecksumKind,
+                            (size_t)ChecksumKind::ChecksumKindMax,
+                            uint8_t> {};
+}  // namespace ao::schema
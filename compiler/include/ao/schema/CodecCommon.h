@@ -1,6 +1,8 @@
 #pragma once
+#include <algorithm>
 #include <concepts>
 #include <cstdint>
+#include <span>
 #include <vector>
 
 #include "ao/pack/Error.h"
@@ -8,30 +10,154 @@
 
 namespace ao::schema::codec {
 
+// Codec records are plain data with explicit padding so a VM image can store
+// them byte for byte and use them in place
 struct CodecField {
     uint64_t fieldNumber;
     uint32_t typeId;
+    uint32_t _reserved = 0;
 };
+static_assert(sizeof(CodecField) == 16);
 struct CodecType {
+    enum Flags : uint8_t {
+        // Integer array elements are zigzag deltas of the previous element
+        NetDelta = 1 << 0,
+        DiskDelta = 1 << 1,
+        // Scalar array elements are packed behind a single element tag on
+        // disk, the flag names the encoding of the elements
+        DiskPackedVarint = 1 << 2,
+        DiskPackedFixed8 = 1 << 3,
+        DiskPackedFixed32 = 1 << 4,
+        DiskPackedFixed64 = 1 << 5,
+    };
     uint8_t bitWidth;
     uint8_t flags;
 };
+// Field number lookup of a message for decoders that accept fields in any
+// order. Compact field numbers use a dense table indexed by
+// fieldNumber - minFieldNumber, sparse ones a table sorted by field number.
 struct CodecMessage {
-    uint32_t fieldStart;
+    enum Lookup : uint32_t {
+        Dense,
+        Sorted,
+    };
+    uint64_t minFieldNumber;
+    uint32_t lookupStart;
+    uint32_t lookupCount;
     uint32_t fieldCount;
+    uint32_t lookup;
+};
+static_assert(sizeof(CodecMessage) == 24);
+struct CodecFieldLookup {
+    uint64_t fieldNumber;
+    // Index of the field within its message, fieldCount for holes in a
+    // dense table
+    uint32_t index;
+    uint32_t _reserved = 0;
 };
+static_assert(sizeof(CodecFieldLookup) == 16);
 struct CodecOneof {
     uint32_t fieldStart;
     uint32_t fieldCount;
     uint32_t indexWidth;
 };
 
+struct CodecQuantization {
+    double min;
+    double max;
+    double precision;
+    uint64_t maxSteps;
+    uint32_t bits;
+    uint32_t _reserved = 0;
+};
+static_assert(sizeof(CodecQuantization) == 40);
+
+// Net size of types without an upper bound, unbounded arrays and recursion
+inline constexpr uint64_t kUnboundedBits = ~uint64_t{0};
+
 struct CodecTable {
     std::vector<CodecType> types;
     std::vector<CodecOneof> oneofs;
     std::vector<uint32_t> oneofFieldNumbers;
+    // Quantized float scalars in type order, scalar instructions refer to
+    // these by 1 based index
+    std::vector<CodecQuantization> quantizations;
 
     std::vector<CodecField> fields;
+    // Indexed by message id
+    std::vector<CodecMessage> messages;
+    std::vector<CodecFieldLookup> fieldLookups;
+    // Worst case net encoded size of each type in bits, kUnboundedBits when
+    // there is none
+    std::vector<uint64_t> netMaxBits;
+};
+
+// Non-owning view of a codec table, codecs read through this so the tables
+// can live in a CodecTable, a mapped VM image or generated static tables
+struct CodecTableView {
+    constexpr CodecTableView() = default;
+    CodecTableView(CodecTable const& table)
+        : types(table.types),
+          oneofs(table.oneofs),
+          oneofFieldNumbers(table.oneofFieldNumbers),
+          quantizations(table.quantizations),
+          fields(table.fields),
+          messages(table.messages),
+          fieldLookups(table.fieldLookups),
+          netMaxBits(table.netMaxBits) {}
+    constexpr CodecTableView(std::span<CodecType const> types,
+                             std::span<CodecOneof const> oneofs,
+                             std::span<uint32_t const> oneofFieldNumbers,
+                             std::span<CodecQuantization const> quantizations,
+                             std::span<CodecField const> fields,
+                             std::span<CodecMessage const> messages,
+                             std::span<CodecFieldLookup const> fieldLookups,
+                             std::span<uint64_t const> netMaxBits)
+        : types(types),
+          oneofs(oneofs),
+          oneofFieldNumbers(oneofFieldNumbers),
+          quantizations(quantizations),
+          fields(fields),
+          messages(messages),
+          fieldLookups(fieldLookups),
+          netMaxBits(netMaxBits) {}
+
+    std::span<CodecType const> types;
+    std::span<CodecOneof const> oneofs;
+    std::span<uint32_t const> oneofFieldNumbers;
+    std::span<CodecQuantization const> quantizations;
+    std::span<CodecField const> fields;
+    std::span<CodecMessage const> messages;
+    std::span<CodecFieldLookup const> fieldLookups;
+    std::span<uint64_t const> netMaxBits;
+
+    bool hasFlag(uint32_t typeId, CodecType::Flags flag) const {
+        return typeId < types.size() && (types[typeId].flags & flag) != 0;
+    }
+    // kUnboundedBits for unknown types
+    uint64_t netMaxBitsOf(uint32_t typeId) const {
+        return typeId < netMaxBits.size() ? netMaxBits[typeId]
+                                          : kUnboundedBits;
+    }
+
+    // Index of `fieldNumber` within message `msgId`, the message's field
+    // count when it has no such field. The message id must be in range.
+    uint32_t findField(uint32_t msgId, uint64_t fieldNumber) const {
+        auto const& msg = messages[msgId];
+        auto const table = fieldLookups.subspan(msg.lookupStart,
+                                                msg.lookupCount);
+        if (msg.lookup == CodecMessage::Dense) {
+            auto const offset = fieldNumber - msg.minFieldNumber;
+            if (fieldNumber < msg.minFieldNumber || offset >= table.size())
+                return msg.fieldCount;
+            return table[offset].index;
+        }
+        auto it = std::ranges::lower_bound(table, fieldNumber, {},
+                                           &CodecFieldLookup::fieldNumber);
+        if (it == table.end() || it->fieldNumber != fieldNumber)
+            return msg.fieldCount;
+        return it->index;
+    }
 };
 
 struct CodecBytes {};
@@ -66,8 +192,8 @@ concept CodecEncode = requires(T codec,
     codec.boolean(b);
     codec.u64(u32, u64);  // width, value
     codec.i64(u32, i64);  // width, value
-    codec.f32(f);
-    codec.f64(d);
+    codec.f32(u32, f);  // quantization, value
+    codec.f64(u32, d);  // quantization, value
 
     // Optionals
     codec.optBegin();
@@ -109,8 +235,8 @@ concept CodecDecode = requires(T codec, uint32_t u32) {
     { codec.boolean() } -> std::same_as<bool>;
     { codec.u64(u32) } -> std::same_as<uint64_t>;
     { codec.i64(u32) } -> std::same_as<int64_t>;
-    { codec.f32() } -> std::same_as<float>;
-    { codec.f64() } -> std::same_as<double>;
+    { codec.f32(u32) } -> std::same_as<float>;   // quantization
+    { codec.f64(u32) } -> std::same_as<double>;  // quantization
 
     // Optionals
     codec.optBegin();
@@ -129,5 +255,7 @@ concept CodecDecode = requires(T codec, uint32_t u32) {
 };
 
 CodecTable generateCodecTable(ir::IR const& ir);
+// Width of the signed field enum values are encoded in
+size_t enumWidth(ir::IR const& ir, ir::Enum const& desc);
 
 }  // namespace ao::schema::codec
@@ -104,6 +104,9 @@ struct DecodeTypeOps {
                        MutPtr ptr,
                        uint32_t fieldId) = nullptr;
     void (*fieldEnd)(CppDecodeRuntime& runtime, MutPtr ptr) = nullptr;
+    void (*fieldDefault)(CppDecodeRuntime& runtime,
+                         MutPtr ptr,
+                         uint32_t fieldId) = nullptr;
 
     void (*optionalEnter)(CppDecodeRuntime& runtime, MutPtr ptr) = nullptr;
     void (*optionalExit)(CppDecodeRuntime& runtime, MutPtr ptr) = nullptr;
@@ -244,6 +247,8 @@ class CppDecodeAdapter {
     // Field navigation:
     void fieldBegin(uint32_t fieldId);
     void fieldEnd();
+    // Resets a field of the current message to its default value
+    void fieldDefault(uint32_t fieldId);
 
     // Optional:
     // For optional decode, codec typically reads "present bit" and VM branches;
@@ -0,0 +1,724 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "ao/pack/BitStream.h"
+#include "ao/pack/Error.h"
+
+#include "ao/schema/CodecCommon.h"
+#include "ao/schema/NetCodec.h"
+#include "ao/schema/VM.h"
+
+// Delta encoding of net messages against a baseline.
+//
+// A snapshot is the net encoding of an object together with the value tree
+// the VM reported while producing it (MSG/FIELD/OPT/ARRAY/ONEOF boundaries and
+// scalar spans). Diffing two snapshots of the same message type gives, for
+// every message, a changed bitmask over its fields followed by the delta of
+// each changed field:
+//
+//   message  : <changed bit per field> <delta of each changed field>
+//   field    : <delta of value>
+//   optional : <present> then <delta of value> when present in both,
+//              otherwise the full value
+//   oneof    : <arm> then <delta of value> when the arm is unchanged,
+//              otherwise the full value
+//   array    : <len> then <changed bit per elem> <delta of each changed elem>
+//              when the length is unchanged, otherwise the full elements
+//   scalar   : the full value
+//
+// Headers (present, arm, len) and full values use the regular net encoding.
+// The decoder runs the normal decode program and serves every unchanged value
+// from the baseline snapshot, so deltas work for any schema without a
+// dedicated program. An empty baseline encodes/decodes the whole message.
+namespace ao::schema::codec::delta {
+
+enum class DeltaNodeKind : uint8_t {
+    Scalar,
+    Message,
+    Field,
+    Optional,
+    Array,
+    Oneof,
+};
+
+struct DeltaNode {
+    DeltaNodeKind kind;
+    // Index one past the last node in this subtree (nodes are in pre-order)
+    uint32_t subtreeEnd;
+    uint32_t childCount;
+    // Bit offsets into the snapshot data
+    uint64_t begin;
+    uint64_t headerEnd;
+    uint64_t end;
+    // present flag, oneof arm or array length
+    uint64_t aux;
+};
+
+struct DeltaSnapshot {
+    std::vector<std::byte> data;
+    size_t bitSize = 0;
+    std::vector<DeltaNode> nodes;
+
+    bool empty() const { return nodes.empty(); }
+    void clear() {
+        data.clear();
+        bitSize = 0;
+        nodes.clear();
+    }
+};
+
+namespace detail {
+inline uint64_t loadBits(std::span<std::byte const> data,
+                         uint64_t pos,
+                         size_t count) {
+    uint64_t out = 0;
+    size_t produced = 0;
+    while (produced < count) {
+        auto const bitIdx = pos % 8;
+        auto const take = std::min<size_t>(8 - bitIdx, count - produced);
+        uint64_t byte = static_cast<uint8_t>(data[pos / 8]);
+        out |= ((byte >> bitIdx) & ((1ull << take) - 1)) << produced;
+        produced += take;
+        pos += take;
+    }
+    return out;
+}
+
+inline bool spanEqual(DeltaSnapshot const& a,
+                      DeltaNode const& an,
+                      DeltaSnapshot const& b,
+                      DeltaNode const& bn) {
+    auto const len = an.end - an.begin;
+    if (len != bn.end - bn.begin)
+        return false;
+    for (uint64_t off = 0; off < len; off += 64) {
+        auto const count = std::min<uint64_t>(64, len - off);
+        if (loadBits(a.data, an.begin + off, count) !=
+            loadBits(b.data, bn.begin + off, count))
+            return false;
+    }
+    return true;
+}
+
+template <class OutStream>
+void copyBits(DeltaSnapshot const& src,
+              uint64_t begin,
+              uint64_t end,
+              OutStream& out) {
+    for (uint64_t pos = begin; pos < end && out.ok(); pos += 64) {
+        auto const count = std::min<uint64_t>(64, end - pos);
+        out.bits(loadBits(src.data, pos, count), count);
+    }
+}
+
+template <class OutStream>
+void writeMask(std::vector<bool> const& mask, OutStream& out) {
+    for (size_t i = 0; i < mask.size() && out.ok(); i += 64) {
+        auto const count = std::min<size_t>(64, mask.size() - i);
+        uint64_t word = 0;
+        for (size_t bit = 0; bit < count; ++bit)
+            word |= uint64_t(mask[i + bit]) << bit;
+        out.bits(word, count);
+    }
+}
+
+template <class OutStream>
+void encodeNode(DeltaSnapshot const& baseline,
+                uint32_t bIdx,
+                DeltaSnapshot const& current,
+                uint32_t cIdx,
+                OutStream& out) {
+    auto const& b = baseline.nodes[bIdx];
+    auto const& c = current.nodes[cIdx];
+    if (!out.ok())
+        return;
+    if (b.kind != c.kind) {
+        out.require(false, ao::pack::Error::BadArg);
+        return;
+    }
+    if (c.kind == DeltaNodeKind::Scalar) {
+        copyBits(current, c.begin, c.end, out);
+        return;
+    }
+
+    copyBits(current, c.begin, c.headerEnd, out);
+    switch (c.kind) {
+        case DeltaNodeKind::Field:
+            encodeNode(baseline, bIdx + 1, current, cIdx + 1, out);
+            return;
+        case DeltaNodeKind::Optional:
+        case DeltaNodeKind::Oneof:
+            if (b.aux == c.aux && c.childCount == 1 && b.childCount == 1) {
+                encodeNode(baseline, bIdx + 1, current, cIdx + 1, out);
+            } else {
+                copyBits(current, c.headerEnd, c.end, out);
+            }
+            return;
+        case DeltaNodeKind::Array:
+            if (b.aux != c.aux || b.childCount != c.childCount) {
+                copyBits(current, c.headerEnd, c.end, out);
+                return;
+            }
+            break;
+        default:
+            break;
+    }
+
+    // Message fields and same length array elements
+    if (b.childCount != c.childCount) {
+        out.require(false, ao::pack::Error::BadArg);
+        return;
+    }
+    std::vector<bool> changed(c.childCount);
+    for (uint32_t i = 0, bc = bIdx + 1, cc = cIdx + 1; i < c.childCount; ++i) {
+        changed[i] = !spanEqual(baseline, baseline.nodes[bc], current,
+                                current.nodes[cc]);
+        bc = baseline.nodes[bc].subtreeEnd;
+        cc = current.nodes[cc].subtreeEnd;
+    }
+    writeMask(changed, out);
+    for (uint32_t i = 0, bc = bIdx + 1, cc = cIdx + 1; i < c.childCount; ++i) {
+        if (changed[i])
+            encodeNode(baseline, bc, current, cc, out);
+        bc = baseline.nodes[bc].subtreeEnd;
+        cc = current.nodes[cc].subtreeEnd;
+    }
+}
+}  // namespace detail
+
+// Growable bit sink used to record snapshots, same bit order as
+// bit::WriteStream.
+class SnapshotWriteStream {
+   public:
+    SnapshotWriteStream(DeltaSnapshot& snapshot) : m_snapshot(snapshot) {}
+
+    SnapshotWriteStream& bits(uint64_t v, size_t count) {
+        if (!ok())
+            return *this;
+        if (count > 64)
+            return fail(ao::pack::Error::BadArg);
+        auto& data = m_snapshot.data;
+        auto pos = m_snapshot.bitSize;
+        data.resize((pos + count + 7) / 8);
+        while (count > 0) {
+            auto const bitIdx = pos % 8;
+            auto const take = std::min<size_t>(8 - bitIdx, count);
+            auto const mask = static_cast<uint8_t>(((1u << take) - 1) << bitIdx);
+            auto byte = static_cast<uint8_t>(data[pos / 8]);
+            byte = static_cast<uint8_t>((byte & ~mask) |
+                                        ((uint8_t(v) << bitIdx) & mask));
+            data[pos / 8] = std::byte{byte};
+            v >>= take;
+            pos += take;
+            count -= take;
+        }
+        m_snapshot.bitSize = pos;
+        return *this;
+    }
+    SnapshotWriteStream& bytes(std::span<std::byte> in, size_t count) {
+        if (in.size() < count)
+            return fail(ao::pack::Error::BadArg);
+        for (size_t i = 0; i < count && ok(); ++i)
+            bits(static_cast<uint8_t>(in[i]), 8);
+        return *this;
+    }
+    SnapshotWriteStream& require(bool condition, ao::pack::Error err) {
+        if (ok() && !condition)
+            fail(err);
+        return *this;
+    }
+
+    size_t bitSize() const { return m_snapshot.bitSize; }
+
+    bool ok() const { return m_status == ao::pack::Error::Ok; }
+    ao::pack::Error error() const { return m_status; }
+
+   private:
+    SnapshotWriteStream& fail(ao::pack::Error err) {
+        m_status = err;
+        return *this;
+    }
+
+    DeltaSnapshot& m_snapshot;
+    ao::pack::Error m_status = ao::pack::Error::Ok;
+};
+
+// Net encode codec that records the value tree alongside the encoding.
+class DeltaRecordCodec {
+   public:
+    using ChunkSize = CodecBits;
+
+    DeltaRecordCodec(CodecTableView net, DeltaSnapshot& snapshot)
+        : m_snapshot(snapshot), m_stream(snapshot), m_net{net, m_stream} {
+        m_snapshot.clear();
+    }
+
+    void msgBegin(uint32_t msgId) {
+        open(DeltaNodeKind::Message);
+        m_net.msgBegin(msgId);
+    }
+    void msgEnd() {
+        m_net.msgEnd();
+        close(DeltaNodeKind::Message);
+    }
+
+    void fieldBegin(uint32_t fieldId) {
+        open(DeltaNodeKind::Field);
+        m_net.fieldBegin(fieldId);
+    }
+    void fieldEnd() {
+        m_net.fieldEnd();
+        close(DeltaNodeKind::Field);
+    }
+    void fieldId(uint32_t fieldId) { m_net.fieldId(fieldId); }
+
+    void boolean(bool v) {
+        open(DeltaNodeKind::Scalar);
+        m_net.boolean(v);
+        close(DeltaNodeKind::Scalar);
+    }
+    void u64(uint32_t bw, uint64_t v) {
+        // Elements of a delta array are part of the array's leaf
+        if (m_deltaArray)
+            return m_net.u64(bw, v);
+        open(DeltaNodeKind::Scalar);
+        m_net.u64(bw, v);
+        close(DeltaNodeKind::Scalar);
+    }
+    void i64(uint32_t bw, int64_t v) {
+        // Elements of a delta array are part of the array's leaf
+        if (m_deltaArray)
+            return m_net.i64(bw, v);
+        open(DeltaNodeKind::Scalar);
+        m_net.i64(bw, v);
+        close(DeltaNodeKind::Scalar);
+    }
+    void f32(uint32_t quant, float f) {
+        open(DeltaNodeKind::Scalar);
+        m_net.f32(quant, f);
+        close(DeltaNodeKind::Scalar);
+    }
+    void f64(uint32_t quant, double d) {
+        open(DeltaNodeKind::Scalar);
+        m_net.f64(quant, d);
+        close(DeltaNodeKind::Scalar);
+    }
+
+    // Delta encoded arrays depend on every previous element, they are
+    // recorded as a single leaf and resent whole when anything changes
+    void arrayBegin(uint32_t typeId) {
+        m_deltaArray = m_net.net.hasFlag(typeId, CodecType::NetDelta);
+        open(m_deltaArray ? DeltaNodeKind::Scalar : DeltaNodeKind::Array);
+        m_net.arrayBegin(typeId);
+    }
+    void arrayEnd() {
+        m_net.arrayEnd();
+        close(m_deltaArray ? DeltaNodeKind::Scalar : DeltaNodeKind::Array);
+        m_deltaArray = false;
+    }
+    void arrayLen(uint32_t width, uint32_t len) {
+        m_net.arrayLen(width, len);
+        if (!m_deltaArray)
+            header(len);
+    }
+
+    void optBegin() {
+        open(DeltaNodeKind::Optional);
+        m_net.optBegin();
+    }
+    void optEnd() {
+        m_net.optEnd();
+        close(DeltaNodeKind::Optional);
+    }
+    void present(bool present) {
+        m_net.present(present);
+        header(present ? 1 : 0);
+    }
+
+    void oneofEnter(uint32_t typeId) {
+        open(DeltaNodeKind::Oneof);
+        m_net.oneofEnter(typeId);
+    }
+    void oneofExit() {
+        m_net.oneofExit();
+        close(DeltaNodeKind::Oneof);
+    }
+    void oneofArm(uint32_t oneofId, uint64_t armid) {
+        m_net.oneofArm(oneofId, armid);
+        header(armid);
+    }
+
+    bool ok() const { return m_err == ao::pack::Error::Ok && m_net.ok(); }
+    ao::pack::Error error() const {
+        return m_err != ao::pack::Error::Ok ? m_err : m_net.error();
+    }
+
+   private:
+    void fail(ao::pack::Error err) {
+        if (ok())
+            m_err = err;
+    }
+    void countChild() {
+        if (!m_open.empty())
+            m_snapshot.nodes[m_open.back()].childCount += 1;
+    }
+    void open(DeltaNodeKind kind) {
+        countChild();
+        auto pos = m_stream.bitSize();
+        m_open.push_back(static_cast<uint32_t>(m_snapshot.nodes.size()));
+        m_snapshot.nodes.push_back(DeltaNode{
+            .kind = kind,
+            .subtreeEnd = 0,
+            .childCount = 0,
+            .begin = pos,
+            .headerEnd = pos,
+            .end = pos,
+            .aux = 0,
+        });
+    }
+    void close(DeltaNodeKind kind) {
+        if (m_open.empty() || m_snapshot.nodes[m_open.back()].kind != kind) {
+            fail(ao::pack::Error::BadData);
+            return;
+        }
+        auto& node = m_snapshot.nodes[m_open.back()];
+        node.end = m_stream.bitSize();
+        node.subtreeEnd = static_cast<uint32_t>(m_snapshot.nodes.size());
+        m_open.pop_back();
+    }
+    void header(uint64_t aux) {
+        if (m_open.empty()) {
+            fail(ao::pack::Error::BadData);
+            return;
+        }
+        auto& node = m_snapshot.nodes[m_open.back()];
+        node.headerEnd = m_stream.bitSize();
+        node.aux = aux;
+    }
+
+    DeltaSnapshot& m_snapshot;
+    SnapshotWriteStream m_stream;
+    net::NetEncodeCodec<SnapshotWriteStream> m_net;
+    std::vector<uint32_t> m_open;
+    bool m_deltaArray = false;
+    ao::pack::Error m_err = ao::pack::Error::Ok;
+};
+static_assert(CodecEncode<DeltaRecordCodec>);
+
+// Writes the delta of `current` against `baseline`. Both snapshots must be of
+// the same message type.
+template <class OutStream>
+bool encodeDelta(DeltaSnapshot const& baseline,
+                 DeltaSnapshot const& current,
+                 OutStream& out) {
+    if (current.empty()) {
+        out.require(false, ao::pack::Error::BadArg);
+        return out.ok();
+    }
+    if (baseline.empty()) {
+        detail::copyBits(current, 0, current.bitSize, out);
+        return out.ok();
+    }
+    detail::encodeNode(baseline, 0, current, 0, out);
+    return out.ok();
+}
+
+// Net decode codec reading a delta. Unchanged values are replayed from the
+// baseline snapshot, changed ones are read from the delta stream.
+template <class InStream>
+class DeltaDecodeCodec {
+   public:
+    using ChunkSize = CodecBits;
+
+    DeltaDecodeCodec(CodecTableView net,
+                     DeltaSnapshot const& baseline,
+                     InStream& in)
+        : m_baseline(baseline),
+          m_in(in),
+          m_replayStream(baselineData(baseline)),
+          m_delta{net, in},
+          m_replay{net, m_replayStream} {
+        m_frames.push_back(Frame{
+            .mode = baseline.empty() ? Mode::Full : Mode::Delta,
+            .node = kRoot,
+            .nextChild = 0,
+            .ordinal = 0,
+            .sameShape = true,
+            .maskOffset = 0,
+        });
+    }
+
+    void msgBegin(uint32_t msgId) {
+        open(DeltaNodeKind::Message);
+        if (!ok())
+            return;
+        auto& frame = m_frames.back();
+        if (frame.mode == Mode::Delta)
+            readMask(m_baseline.nodes[frame.node].childCount);
+        codec(frame.mode).msgBegin(msgId);
+    }
+    void msgEnd() {
+        codec(m_frames.back().mode).msgEnd();
+        close();
+    }
+
+    void fieldBegin(uint32_t fieldId) {
+        open(DeltaNodeKind::Field);
+        if (ok())
+            codec(m_frames.back().mode).fieldBegin(fieldId);
+    }
+    void fieldEnd() {
+        codec(m_frames.back().mode).fieldEnd();
+        close();
+    }
+    bool fieldId(uint32_t fieldId) {
+        return codec(m_frames.back().mode).fieldId(fieldId);
+    }
+    bool skipField(uint32_t fieldId) {
+        return codec(m_frames.back().mode).skipField(fieldId);
+    }
+
+    bool boolean() { return leaf().boolean(); }
+    uint64_t u64(uint32_t width) { return leaf().u64(width); }
+    int64_t i64(uint32_t width) { return leaf().i64(width); }
+    float f32(uint32_t quant) { return leaf().f32(quant); }
+    double f64(uint32_t quant) { return leaf().f64(quant); }
+
+    void optBegin() {
+        open(DeltaNodeKind::Optional);
+        if (ok())
+            codec(m_frames.back().mode).optBegin();
+    }
+    void optEnd() {
+        codec(m_frames.back().mode).optEnd();
+        close();
+    }
+    bool present() {
+        auto& frame = m_frames.back();
+        auto v = codec(frame.mode).present();
+        if (frame.mode == Mode::Delta)
+            frame.sameShape = v && m_baseline.nodes[frame.node].aux != 0;
+        return v;
+    }
+
+    void arrayBegin(uint32_t typeId) {
+        if (m_delta.net.hasFlag(typeId, CodecType::NetDelta)) {
+            openDeltaArray();
+        } else {
+            open(DeltaNodeKind::Array);
+        }
+        if (ok())
+            codec(m_frames.back().mode).arrayBegin(typeId);
+    }
+    void arrayEnd() {
+        codec(m_frames.back().mode).arrayEnd();
+        close();
+    }
+    uint32_t arrayLen(uint32_t width) {
+        auto& frame = m_frames.back();
+        auto len = codec(frame.mode).arrayLen(width);
+        if (frame.mode == Mode::Delta && ok()) {
+            frame.sameShape = len == m_baseline.nodes[frame.node].aux;
+            if (frame.sameShape)
+                readMask(len);
+        }
+        return len;
+    }
+
+    void oneofEnter(uint32_t typeId) {
+        open(DeltaNodeKind::Oneof);
+        if (ok())
+            codec(m_frames.back().mode).oneofEnter(typeId);
+    }
+    void oneofExit() {
+        codec(m_frames.back().mode).oneofExit();
+        close();
+    }
+    uint32_t oneofArm(uint32_t oneofId) {
+        auto& frame = m_frames.back();
+        auto arm = codec(frame.mode).oneofArm(oneofId);
+        if (frame.mode == Mode::Delta)
+            frame.sameShape = arm == m_baseline.nodes[frame.node].aux;
+        return arm;
+    }
+
+    bool ok() const {
+        return m_err == ao::pack::Error::Ok && m_delta.ok() && m_replay.ok();
+    }
+    ao::pack::Error error() const {
+        if (m_err != ao::pack::Error::Ok)
+            return m_err;
+        if (!m_delta.ok())
+            return m_delta.error();
+        return m_replay.error();
+    }
+
+   private:
+    enum class Mode : uint8_t {
+        Delta,   // Reading a delta against `node`
+        Replay,  // Reading the baseline value
+        Full,    // Reading a full value from the delta stream
+    };
+    struct Frame {
+        Mode mode;
+        uint32_t node;
+        uint32_t nextChild;
+        uint32_t ordinal;
+        bool sameShape;
+        size_t maskOffset;
+    };
+    static constexpr uint32_t kRoot = std::numeric_limits<uint32_t>::max();
+
+    static std::span<std::byte> baselineData(DeltaSnapshot const& baseline) {
+        // Read streams only read through this span
+        return {const_cast<std::byte*>(baseline.data.data()),
+                baseline.data.size()};
+    }
+
+    void fail(ao::pack::Error err) {
+        if (ok())
+            m_err = err;
+    }
+
+    auto& codec(Mode mode) { return mode == Mode::Replay ? m_replay : m_delta; }
+
+    // Resolves how the next value inside the current frame is read
+    Frame child(DeltaNodeKind kind) {
+        auto& parent = m_frames.back();
+        Frame frame{
+            .mode = parent.mode,
+            .node = kRoot,
+            .nextChild = 0,
+            .ordinal = 0,
+            .sameShape = true,
+            .maskOffset = m_masks.size(),
+        };
+        // Frames stop matching the baseline once anything failed
+        if (parent.mode != Mode::Delta || !ok())
+            return frame;
+        if (!parent.sameShape) {
+            frame.mode = Mode::Full;
+            return frame;
+        }
+
+        uint32_t nodeIdx = 0;
+        bool changed = true;
+        if (parent.node == kRoot) {
+            if (parent.nextChild != 0) {
+                fail(ao::pack::Error::BadData);
+                return frame;
+            }
+            parent.nextChild = 1;
+        } else {
+            auto const& node = m_baseline.nodes[parent.node];
+            nodeIdx = parent.nextChild;
+            if (parent.ordinal >= node.childCount) {
+                fail(ao::pack::Error::BadData);
+                return frame;
+            }
+            if (node.kind == DeltaNodeKind::Message ||
+                node.kind == DeltaNodeKind::Array)
+                changed = m_masks[parent.maskOffset + parent.ordinal];
+            parent.ordinal += 1;
+            parent.nextChild = m_baseline.nodes[nodeIdx].subtreeEnd;
+        }
+
+        auto const& node = m_baseline.nodes[nodeIdx];
+        if (node.kind != kind) {
+            fail(ao::pack::Error::BadData);
+            return frame;
+        }
+        frame.node = nodeIdx;
+        frame.nextChild = nodeIdx + 1;
+        if (!changed) {
+            frame.mode = Mode::Replay;
+            m_replayStream =
+                InStream{baselineData(m_baseline).subspan(node.begin / 8)};
+            uint64_t skip = 0;
+            m_replayStream.bits(skip, node.begin % 8);
+        }
+        return frame;
+    }
+    void open(DeltaNodeKind kind) {
+        if (!ok())
+            return;
+        auto frame = child(kind);
+        if (ok())
+            m_frames.push_back(frame);
+    }
+    // Delta encoded arrays are leaves, a changed one is read in full
+    void openDeltaArray() {
+        if (!ok())
+            return;
+        auto frame = child(DeltaNodeKind::Scalar);
+        if (frame.mode == Mode::Delta)
+            frame.mode = Mode::Full;
+        if (ok())
+            m_frames.push_back(frame);
+    }
+    void close() {
+        if (m_frames.size() <= 1) {
+            fail(ao::pack::Error::BadData);
+            return;
+        }
+        m_masks.resize(m_frames.back().maskOffset);
+        m_frames.pop_back();
+    }
+    auto& leaf() {
+        auto frame = child(DeltaNodeKind::Scalar);
+        return codec(frame.mode);
+    }
+    void readMask(uint64_t count) {
+        for (uint64_t i = 0; i < count && m_in.ok(); i += 64) {
+            auto const take = std::min<uint64_t>(64, count - i);
+            uint64_t word = 0;
+            m_in.bits(word, take);
+            for (uint64_t bit = 0; bit < take; ++bit)
+                m_masks.push_back(((word >> bit) & 1) != 0);
+        }
+    }
+
+    DeltaSnapshot const& m_baseline;
+    InStream& m_in;
+    InStream m_replayStream;
+    net::NetDecodeCodec<InStream> m_delta;
+    net::NetDecodeCodec<InStream> m_replay;
+
+    std::vector<Frame> m_frames;
+    std::vector<bool> m_masks;
+    ao::pack::Error m_err = ao::pack::Error::Ok;
+};
+static_assert(CodecDecode<DeltaDecodeCodec<ao::pack::bit::ReadStream>>);
+using DeltaDecode = DeltaDecodeCodec<ao::pack::bit::ReadStream>;
+
+template <class ObjectAdapter>
+vm::VM recordSnapshot(vm::ProgramView encode,
+                      CodecTableView net,
+                      ObjectAdapter& object,
+                      uint64_t messageId,
+                      DeltaSnapshot& out) {
+    DeltaRecordCodec codec{net, out};
+    auto machine = vm::VM{encode};
+    vm::encode(machine, object, codec, messageId);
+    return machine;
+}
+
+template <class ObjectAdapter, class InStream>
+vm::VM decodeDelta(vm::ProgramView decode,
+                   CodecTableView net,
+                   DeltaSnapshot const& baseline,
+                   InStream& in,
+                   ObjectAdapter& object,
+                   uint64_t messageId) {
+    DeltaDecodeCodec<InStream> codec{net, baseline, in};
+    auto machine = vm::VM{decode};
+    vm::decode(machine, object, codec, messageId);
+    return machine;
+}
+
+}  // namespace ao::schema::codec::delta
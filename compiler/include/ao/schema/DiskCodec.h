@@ -5,7 +5,9 @@
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <optional>
 #include <span>
+#include <utility>
 #include <vector>
 
 #include "ao/pack/ByteStream.h"
@@ -30,30 +32,131 @@ enum class DiskTag : uint8_t {
     Fixed32,  // f32, f64 and related
     Fixed64,  // f32, f64 and related
     Varint,   // i64, u64
+    // Array of scalars, followed by the element tag, the length and the
+    // untagged elements
+    PackedArray,
     DiskTagMax,
     Unknown = std::numeric_limits<uint8_t>::max(),
 };
 
+enum class DiskVersion : uint8_t {
+    V1 = 1,
+    // Messages, arrays and oneofs carry the byte length of their body after
+    // the begin tag so readers can skip them with a single seek
+    V2 = 2,
+    // Fields start with a single key holding the field number and the tag
+    // of their value and have no End tag, nothing is length framed
+    Compact = 3,
+};
+
+// Element tag of packed arrays of `typeId`, Unknown for arrays whose
+// elements keep their own tags. V1 never packs so old readers keep working.
+inline DiskTag packedTag(CodecTableView const& codec,
+                         DiskVersion version,
+                         uint32_t typeId) {
+    if (version == DiskVersion::V1 || typeId >= codec.types.size())
+        return DiskTag::Unknown;
+    auto const flags = codec.types[typeId].flags;
+    if (flags & CodecType::DiskPackedVarint)
+        return DiskTag::Varint;
+    if (flags & CodecType::DiskPackedFixed8)
+        return DiskTag::Fixed8;
+    if (flags & CodecType::DiskPackedFixed32)
+        return DiskTag::Fixed32;
+    if (flags & CodecType::DiskPackedFixed64)
+        return DiskTag::Fixed64;
+    return DiskTag::Unknown;
+}
+// Byte size of a packed fixed width element, 0 for varints
+inline size_t packedSize(DiskTag tag) {
+    switch (tag) {
+        case DiskTag::Fixed8:
+            return 1;
+        case DiskTag::Fixed32:
+            return 4;
+        case DiskTag::Fixed64:
+            return 8;
+        default:
+            return 0;
+    }
+}
+
+// Compact field keys are (fieldNumber << kKeyTagBits) | value tag, the End
+// tag is key 5 so messages end with the same byte in every version
+inline constexpr uint32_t kKeyTagBits = 4;
+static_assert((size_t)DiskTag::DiskTagMax <= (1u << kKeyTagBits));
+
+namespace detail {
+// Growable sink the v2 encoder stages length framed values in
+class StagingWriteStream {
+   public:
+    StagingWriteStream(std::vector<std::byte>& data) : m_data(data) {}
+
+    StagingWriteStream& bytes(std::span<std::byte const> in, size_t count) {
+        if (in.size() < count)
+            return fail(ao::pack::Error::BadArg);
+        m_data.insert(m_data.end(), in.begin(), in.begin() + count);
+        return *this;
+    }
+    StagingWriteStream& require(bool condition, ao::pack::Error err) {
+        if (ok() && !condition)
+            fail(err);
+        return *this;
+    }
+
+    bool ok() const { return m_status == ao::pack::Error::Ok; }
+    ao::pack::Error error() const { return m_status; }
+
+   private:
+    StagingWriteStream& fail(ao::pack::Error err) {
+        m_status = err;
+        return *this;
+    }
+
+    ao::pack::Error m_status = ao::pack::Error::Ok;
+    std::vector<std::byte>& m_data;
+};
+}  // namespace detail
+
 template <class OutStream>
 class DiskEncodeCodec {
    public:
-    DiskEncodeCodec(CodecTable const& table, OutStream& stream)
-        : m_codec(table), m_stream(stream) {}
+    DiskEncodeCodec(CodecTableView table,
+                    OutStream& stream,
+                    DiskVersion version = DiskVersion::V1)
+        : m_codec(table), m_stream(stream), m_version(version) {}
 
     using ChunkSize = CodecBytes;
 
     bool ok() const { return m_error == ao::pack::Error::Ok; }
     ao::pack::Error error() const { return m_error; }
 
-    void msgBegin(uint32_t msgId) { writeTag(DiskTag::MsgBegin); }
-    void msgEnd() { writeTag(DiskTag::End); }
+    void msgBegin(uint32_t msgId) {
+        writeTag(DiskTag::MsgBegin);
+        frameBegin();
+    }
+    void msgEnd() {
+        writeTag(DiskTag::End);
+        frameEnd();
+    }
 
-    void fieldBegin(uint32_t fieldId) { writeTag(DiskTag::Field); }
-    void fieldEnd() { writeTag(DiskTag::End); }
+    void fieldBegin(uint32_t fieldId) {
+        if (m_version != DiskVersion::Compact)
+            writeTag(DiskTag::Field);
+    }
+    void fieldEnd() {
+        if (m_version != DiskVersion::Compact)
+            writeTag(DiskTag::End);
+    }
 
     void fieldId(uint32_t fieldId) {
-        ao::pack::encodePrefixInt(m_stream,
-                                  m_codec.fields[fieldId].fieldNumber);
+        auto const fieldNumber = m_codec.fields[fieldId].fieldNumber;
+        if (m_version != DiskVersion::Compact)
+            return writeVarint(fieldNumber);
+        // The key goes out with the tag of the value
+        if (fieldNumber > (std::numeric_limits<uint64_t>::max() >> kKeyTagBits))
+            fail(ao::pack::Error::BadArg);
+        m_key = fieldNumber << kKeyTagBits;
     }
 
     void optBegin() { writeTag(DiskTag::OptBegin); }
@@ -61,123 +164,294 @@ class DiskEncodeCodec {
     void present(bool) {}
 
     void boolean(bool value) {
-        writeTag(DiskTag::Varint);
-        ao::pack::encodePrefixInt(m_stream, (uint64_t)value);
+        writeValueTag(DiskTag::Varint);
+        writeVarint((uint64_t)value);
     }
     void u64(uint32_t /* width */, uint64_t value) {
-        writeTag(DiskTag::Varint);
-        ao::pack::encodePrefixInt(m_stream, (uint64_t)value);
+        if (m_delta)
+            return deltaValue(value);
+        if (m_packed == DiskTag::Fixed8) {
+            if (value > 0xFF)
+                fail(ao::pack::Error::BadArg);
+            auto data = (std::byte)value;
+            return writeBytes(std::span<std::byte>{&data, 1});
+        }
+        writeValueTag(DiskTag::Varint);
+        writeVarint((uint64_t)value);
     }
     void i64(uint32_t width, int64_t value) {
-        writeTag(DiskTag::Varint);
-        uint64_t v = ao::pack::encodeZigZag(value);
-        ao::pack::encodePrefixInt(m_stream, v);
-    }
-    void f32(float v) {
-        writeTag(DiskTag::Fixed32);
+        if (m_delta)
+            return deltaValue((uint64_t)value);
+        writeValueTag(DiskTag::Varint);
+        writeVarint(ao::pack::encodeZigZag(value));
+    }
+    // Disk keeps full precision, quantization is a net concern
+    void f32(uint32_t /* quant */, float v) {
+        writeValueTag(DiskTag::Fixed32);
         static constexpr auto size = sizeof(float);
         static_assert(size == 4);
-        m_stream.bytes(std::span{(std::byte*)&v, size}, size);
+        writeBytes(std::span{(std::byte*)&v, size});
     }
-    void f64(double v) {
-        writeTag(DiskTag::Fixed64);
+    void f64(uint32_t /* quant */, double v) {
+        writeValueTag(DiskTag::Fixed64);
         static constexpr auto size = sizeof(double);
         static_assert(size == 8);
-        m_stream.bytes(std::span{(std::byte*)&v, size}, size);
+        writeBytes(std::span{(std::byte*)&v, size});
     }
 
-    void arrayBegin(uint32_t /* typeId*/) { writeTag(DiskTag::ArrayBegin); }
-    void arrayEnd() { writeTag(DiskTag::End); }
-    void arrayLen(uint32_t width, uint32_t length) {
-        ao::pack::encodePrefixInt(m_stream, length);
+    void arrayBegin(uint32_t typeId) {
+        auto const packed = packedTag(m_codec, m_version, typeId);
+        writeTag(packed == DiskTag::Unknown ? DiskTag::ArrayBegin
+                                            : DiskTag::PackedArray);
+        frameBegin();
+        if (packed != DiskTag::Unknown)
+            writeTag(packed);
+        m_packed = packed;
+        m_delta = m_codec.hasFlag(typeId, CodecType::DiskDelta);
+        m_previous = 0;
+    }
+    void arrayEnd() {
+        m_delta = false;
+        m_packed = DiskTag::Unknown;
+        writeTag(DiskTag::End);
+        frameEnd();
     }
+    void arrayLen(uint32_t width, uint32_t length) { writeVarint(length); }
 
-    void oneofEnter(uint32_t oneofId) { writeTag(DiskTag::OneofBegin); }
-    void oneofExit() { writeTag(DiskTag::End); }
+    void oneofEnter(uint32_t oneofId) {
+        writeTag(DiskTag::OneofBegin);
+        frameBegin();
+    }
+    void oneofExit() {
+        writeTag(DiskTag::End);
+        frameEnd();
+    }
     void oneofArm(uint32_t oneofId, uint64_t armId) {
+        if (armId >= m_codec.oneofs[oneofId].fieldCount) {
+            fail(ao::pack::Error::BadArg);
+            return;
+        }
         auto fieldNumberOffset = m_codec.oneofs[oneofId].fieldStart + armId;
-        auto id = m_codec.oneofFieldNumbers[fieldNumberOffset];
-        ao::pack::encodePrefixInt(m_stream, id);
+        writeVarint(m_codec.oneofFieldNumbers[fieldNumberOffset]);
     }
 
    private:
+    // A length framed value in the staging buffer, the length is inserted
+    // at `start` when the outermost frame is flushed
+    struct Frame {
+        size_t start = 0;
+        uint64_t length = 0;
+        // Bytes the lengths of nested frames add to this frame
+        uint64_t nestedLengthBytes = 0;
+    };
+
+    // Everything inside an open frame is staged until the outermost frame
+    // closes, the stream itself only ever sees complete values
+    template <class Fn>
+    void write(Fn&& fn) {
+        if (m_open.empty()) {
+            fn(m_stream);
+            return;
+        }
+        detail::StagingWriteStream staging{m_staging};
+        fn(staging);
+    }
+    void writeBytes(std::span<std::byte> data) {
+        write([&](auto& out) { out.bytes(data, data.size()); });
+    }
+    void writeVarint(uint64_t value) {
+        write([&](auto& out) { ao::pack::encodePrefixInt(out, value); });
+    }
     void writeTag(DiskTag tag) {
+        if (m_key)
+            return writeVarint(*std::exchange(m_key, std::nullopt) |
+                               (uint64_t)tag);
         auto data = (std::byte)tag;
-        m_stream.bytes(std::span<std::byte>{&data, 1}, 1);
+        writeBytes(std::span<std::byte>{&data, 1});
+    }
+    // Elements of packed arrays share the tag written after PackedArray
+    void writeValueTag(DiskTag tag) {
+        if (m_packed == DiskTag::Unknown)
+            writeTag(tag);
+    }
+    // Still tagged as varints so readers that skip the array don't care
+    void deltaValue(uint64_t value) {
+        writeValueTag(DiskTag::Varint);
+        writeVarint(ao::pack::encodeZigZagDelta(m_previous, value));
+        m_previous = value;
+    }
+
+    void frameBegin() {
+        if (m_version != DiskVersion::V2)
+            return;
+        m_open.push_back(m_frames.size());
+        m_frames.push_back({.start = m_staging.size()});
+    }
+    void frameEnd() {
+        if (m_version != DiskVersion::V2 || m_open.empty())
+            return;
+        auto& frame = m_frames[m_open.back()];
+        m_open.pop_back();
+        frame.length =
+            m_staging.size() - frame.start + frame.nestedLengthBytes;
+        if (m_open.empty())
+            return flush();
+
+        auto const lengthBytes =
+            std::get<2>(ao::pack::encodePrefixIntHeader(frame.length)) + 1;
+        m_frames[m_open.back()].nestedLengthBytes +=
+            frame.nestedLengthBytes + lengthBytes;
+    }
+    // Frames are stored in the order they were opened which is also the
+    // order of their lengths in the output
+    void flush() {
+        size_t pos = 0;
+        for (auto const& frame : m_frames) {
+            m_stream.bytes(std::span{m_staging}.subspan(pos, frame.start - pos),
+                           frame.start - pos);
+            ao::pack::encodePrefixInt(m_stream, frame.length);
+            pos = frame.start;
+        }
+        m_stream.bytes(std::span{m_staging}.subspan(pos),
+                       m_staging.size() - pos);
+        m_staging.clear();
+        m_frames.clear();
+        if (!m_stream.ok())
+            fail(m_stream.error());
     }
 
     ao::pack::Error fail(ao::pack::Error err) {
         if (!ok())
-            return;
+            return m_error;
         m_error = err;
+        return m_error;
     }
     ao::pack::Error m_error = ao::pack::Error::Ok;
 
-    CodecTable const& m_codec;
+    CodecTableView m_codec;
     OutStream& m_stream;
+    DiskVersion m_version;
+    // Compact field key waiting for the tag of the field's value
+    std::optional<uint64_t> m_key;
+
+    bool m_delta = false;
+    uint64_t m_previous = 0;
+    // Element tag of the packed array being written
+    DiskTag m_packed = DiskTag::Unknown;
+
+    std::vector<std::byte> m_staging;
+    std::vector<Frame> m_frames;
+    std::vector<size_t> m_open;
 };
 static_assert(CodecEncode<DiskEncodeCodec<ao::pack::byte::WriteStream>>);
 
 template <class InStream>
 class DiskDecodeCodec {
    public:
-    DiskDecodeCodec(CodecTable const& table, InStream& stream)
-        : m_codec(table), m_stream(stream) {}
+    DiskDecodeCodec(CodecTableView table,
+                    InStream& stream,
+                    DiskVersion version = DiskVersion::V1)
+        : m_codec(table), m_stream(stream), m_version(version) {}
     using ChunkSize = CodecBytes;
     bool ok() const { return error() == ao::pack::Error::Ok; }
     ao::pack::Error error() const { return m_error; }
 
-    void msgBegin(uint32_t msgId) { readTag(DiskTag::MsgBegin); }
+    void msgBegin(uint32_t msgId) {
+        if (readTag(DiskTag::MsgBegin))
+            readFrameLength();
+    }
     void msgEnd() { readTag(DiskTag::End); }
 
-    void fieldBegin(uint32_t fieldId) { readTag(DiskTag::Field); }
-    void fieldEnd() { readTag(DiskTag::End); }
+    void fieldBegin(uint32_t fieldId) {
+        // nextField already consumed the header of out of order fields
+        if (!std::exchange(m_fieldHeaderRead, false))
+            readFieldHeader();
+    }
+    void fieldEnd() {
+        if (m_version != DiskVersion::Compact)
+            readTag(DiskTag::End);
+    }
 
-    bool fieldId(uint32_t fieldId) {
-        uint64_t expected = m_codec.fields[fieldId].fieldNumber;
-        uint64_t fieldNum = readVarint();
+    // Fields are tagged with their number so they decode in any order
+    bool fieldLookup() const { return !m_codec.messages.empty(); }
+    // Reads the header of the next field of message `msgId` and returns its
+    // index in the message, nothing at the end of the message
+    std::optional<uint32_t> nextField(uint32_t msgId) {
         if (!ok())
-            return false;
-        return expected == fieldNum;
+            return {};
+        if (msgId >= m_codec.messages.size()) {
+            fail(ao::pack::Error::BadData);
+            return {};
+        }
+        if (atEnd() || !readFieldHeader())
+            return {};
+        m_fieldHeaderRead = true;
+        return m_codec.findField(msgId, m_fieldNumber);
+    }
+
+    bool fieldId(uint32_t fieldId) {
+        return ok() && m_fieldNumber == m_codec.fields[fieldId].fieldNumber;
     }
 
     // Skip from previous information
     // We are expecting an END eventually
     // Current processing a value
     bool skipField(uint32_t fieldId) {
+        m_fieldHeaderRead = false;
         if (!skipFieldImpl())
             return false;
         // Expect the end tag after parsing the value
-        return readTag(DiskTag::End);
+        return m_version == DiskVersion::Compact || readTag(DiskTag::End);
     }
 
-    bool boolean() { return readTaggedVarint(DiskTag::Varint) != 0; }
+    bool boolean() { return readValueVarint() != 0; }
     uint64_t u64(uint16_t /*  width */) {
-        return readTaggedVarint(DiskTag::Varint);
+        if (m_delta)
+            return deltaValue();
+        if (m_packed == DiskTag::Fixed8)
+            return packedValue<uint8_t>();
+        return readValueVarint();
     }
     int64_t i64(uint16_t /*  width */) {
-        auto v = readTaggedVarint(DiskTag::Varint);
+        if (m_delta)
+            return (int64_t)deltaValue();
+        auto v = readValueVarint();
         return ao::pack::decodeZigZag(v);
     }
-    float f32() {
+    float f32(uint32_t /* quant */) {
+        if (m_packed == DiskTag::Fixed32)
+            return packedValue<float>();
         if (!readTag(DiskTag::Fixed32))
             return 0.f;
         return fixed<float, 4>();
     }
-    double f64() {
+    double f64(uint32_t /* quant */) {
+        if (m_packed == DiskTag::Fixed64)
+            return packedValue<double>();
         if (!readTag(DiskTag::Fixed64))
             return 0.0;
         return fixed<double, 8>();
     }
 
-    void arrayBegin(uint32_t /* typeId */) {
-        readTag(DiskTag::ArrayBegin);
-
-        // Read the type tag, as we aren't skipping it doesn't matter
-        // readTag();
+    void arrayBegin(uint32_t typeId) {
+        auto const packed = packedTag(m_codec, m_version, typeId);
+        if (readTag(packed == DiskTag::Unknown ? DiskTag::ArrayBegin
+                                               : DiskTag::PackedArray))
+            readFrameLength();
+        if (packed != DiskTag::Unknown)
+            readTag(packed);
+        m_packed = packed;
+        m_delta = m_codec.hasFlag(typeId, CodecType::DiskDelta);
+    }
+    void arrayEnd() {
+        m_delta = false;
+        m_packed = DiskTag::Unknown;
+        readTag(DiskTag::End);
     }
-    void arrayEnd() { readTag(DiskTag::End); }
     uint32_t arrayLen(uint32_t width) {
+        // A length read after failing would size the array from garbage
+        if (!ok())
+            return 0;
         uint64_t value = 0;
         ao::pack::decodePrefixInt(m_stream, value);
         raiseError();
@@ -186,23 +460,25 @@ class DiskDecodeCodec {
             return 0;
         }
 
+        if (m_delta)
+            readDeltas((uint32_t)value);
+        else if (packedSize(m_packed) != 0)
+            readPacked((uint32_t)value);
         return (uint32_t)value;
     }
 
     void optBegin() { readTag(DiskTag::OptBegin); }
     void optEnd() { readTag(DiskTag::End); }
-    bool present() {
-        std::byte byte;
-        if (!m_stream.peek({&byte, 1}, 1)) {
-            fail(ao::pack::Error::BadData);
-            return false;
-        }
-        return static_cast<DiskTag>(byte) != DiskTag::End;
-    }
+    bool present() { return ok() && !atEnd(); }
 
-    void oneofEnter(uint32_t oneofId) { readTag(DiskTag::OneofBegin); }
+    void oneofEnter(uint32_t oneofId) {
+        if (readTag(DiskTag::OneofBegin))
+            readFrameLength();
+    }
     void oneofExit() { readTag(DiskTag::End); }
     uint32_t oneofArm(uint32_t oneofId) {
+        if (!ok())
+            return 0;
         uint64_t value = 0;
         if (!ao::pack::decodePrefixInt(m_stream, value)) {
             raiseError();
@@ -226,17 +502,62 @@ class DiskDecodeCodec {
     }
 
    private:
+    // Delta arrays are read up front so the prefix sum runs as one batch
+    void readDeltas(uint32_t len) {
+        m_deltas.clear();
+        m_nextDelta = 0;
+        for (uint32_t i = 0; i < len && ok(); ++i)
+            m_deltas.push_back(readValueVarint());
+        ao::pack::decodeZigZagDeltas(m_deltas);
+    }
+    // Fixed width packed arrays are copied out of the stream in one go
+    void readPacked(uint32_t len) {
+        auto const size = (uint64_t)len * packedSize(m_packed);
+        m_packedBytes.clear();
+        m_nextPacked = 0;
+        if (size > m_stream.remainingBytes()) {
+            fail(ao::pack::Error::Eof);
+            return;
+        }
+        m_packedBytes.resize(size);
+        m_stream.bytes(m_packedBytes, size);
+        raiseError();
+    }
+    template <class T>
+    T packedValue() {
+        T ret = 0;
+        if (m_nextPacked + sizeof(T) > m_packedBytes.size())
+            return ret;
+        std::memcpy(&ret, m_packedBytes.data() + m_nextPacked, sizeof(T));
+        m_nextPacked += sizeof(T);
+        return ret;
+    }
+    uint64_t readValueVarint() {
+        if (m_packed == DiskTag::Varint)
+            return readVarint();
+        return readTaggedVarint(DiskTag::Varint);
+    }
+    uint64_t deltaValue() {
+        if (m_nextDelta >= m_deltas.size())
+            return 0;
+        return m_deltas[m_nextDelta++];
+    }
+
     template <class T, size_t Size>
     T fixed() {
         static constexpr auto size = sizeof(T);
         static_assert(sizeof(T) == Size);
         T ret = 0;
+        if (!ok())
+            return ret;
         m_stream.bytes(std::span{(std::byte*)&ret, size}, size);
         raiseError();
         return ret;
     }
     uint64_t readVarint() {
         uint64_t value = 0;
+        if (!ok())
+            return value;
         if (!ao::pack::decodePrefixInt(m_stream, value)) {
             raiseError();
         }
@@ -250,6 +571,9 @@ class DiskDecodeCodec {
     DiskTag readTag() {
         if (!ok())
             return DiskTag::Unknown;
+        // A compact field key already carried the tag of its value
+        if (m_keyTag != DiskTag::Unknown)
+            return std::exchange(m_keyTag, DiskTag::Unknown);
         uint64_t out = 0;
         if (!ao::pack::decodePrefixInt(m_stream, out)) {
             fail(ao::pack::Error::BadData);
@@ -272,6 +596,64 @@ class DiskDecodeCodec {
         return true;
     }
 
+    // Peeks for the End tag closing the current value
+    bool atEnd() {
+        std::byte byte;
+        if (!m_stream.peek({&byte, 1}, 1)) {
+            fail(ao::pack::Error::BadData);
+            return false;
+        }
+        return static_cast<DiskTag>(byte) == DiskTag::End;
+    }
+    // Reads the field tag and number or the compact key standing in for
+    // both and the tag of the value
+    bool readFieldHeader() {
+        if (m_version != DiskVersion::Compact) {
+            if (readTag(DiskTag::Field))
+                m_fieldNumber = readVarint();
+            return ok();
+        }
+        auto const key = readVarint();
+        if (!ok())
+            return false;
+        auto const tag = key & ((1u << kKeyTagBits) - 1);
+        if (tag >= (uint64_t)DiskTag::DiskTagMax ||
+            tag == (uint64_t)DiskTag::Field || tag == (uint64_t)DiskTag::End) {
+            fail(ao::pack::Error::BadData);
+            return false;
+        }
+        m_fieldNumber = key >> kKeyTagBits;
+        m_keyTag = static_cast<DiskTag>(tag);
+        return true;
+    }
+
+    // Only v2 frames carry a length, the decoder walks the body anyway
+    void readFrameLength() {
+        if (m_version == DiskVersion::V2)
+            readVarint();
+    }
+    // Skips the rest of a v2 frame whose begin tag was just read
+    bool skipFrame() {
+        auto length = readVarint();
+        if (!ok())
+            return false;
+        return skipBytes(length);
+    }
+    bool skipBytes(uint64_t length) {
+        if constexpr (requires { m_stream.advance(size_t{}); }) {
+            m_stream.advance(length);
+        } else {
+            std::array<std::byte, 64> scratch;
+            while (length > 0 && m_stream.ok()) {
+                auto const count = std::min<uint64_t>(length, scratch.size());
+                m_stream.bytes(scratch, count);
+                length -= count;
+            }
+        }
+        raiseError();
+        return ok();
+    }
+
     void raiseError() {
         if (m_stream.ok())
             return;
@@ -282,13 +664,13 @@ class DiskDecodeCodec {
 
     bool skipMsg() {
         // This skips the _body_ of the message
-        auto tag = readTag();
-        while (ok() && tag == DiskTag::Field) {
-            if (!skipFieldImpl())
+        while (ok() && !atEnd()) {
+            if (!readFieldHeader() || !skipFieldImpl())
+                return false;
+            if (m_version != DiskVersion::Compact && !readTag(DiskTag::End))
                 return false;
-            tag = readTag();
         }
-        return tag == DiskTag::End;
+        return readTag(DiskTag::End);
     }
 
     bool skipOneof() {
@@ -309,6 +691,25 @@ class DiskDecodeCodec {
         }
         return readTag(DiskTag::End);
     }
+    bool skipPackedArray() {
+        auto const tag = readTag();
+        auto const len = readVarint();
+        if (!ok())
+            return false;
+        if (tag == DiskTag::Varint) {
+            for (uint64_t i = 0; i < len && ok(); ++i)
+                readVarint();
+        } else if (auto size = packedSize(tag); size != 0) {
+            if (len > std::numeric_limits<uint64_t>::max() / size) {
+                fail(ao::pack::Error::BadData);
+                return false;
+            }
+            skipBytes(len * size);
+        } else {
+            fail(ao::pack::Error::BadData);
+        }
+        return ok() && readTag(DiskTag::End);
+    }
     bool skipOpt() {
         auto tag = readTag();
         if (tag == DiskTag::End)
@@ -324,6 +725,8 @@ class DiskDecodeCodec {
 
         switch (tag) {
             case DiskTag::MsgBegin:
+                if (m_version == DiskVersion::V2)
+                    return skipFrame();
                 return skipMsg();
 
             case DiskTag::Field:
@@ -332,12 +735,21 @@ class DiskDecodeCodec {
                 return false;
 
             case DiskTag::OneofBegin:
+                if (m_version == DiskVersion::V2)
+                    return skipFrame();
                 return skipOneof();
 
             case DiskTag::ArrayBegin:
                 // Used for strings, bytes, arrays etc
+                if (m_version == DiskVersion::V2)
+                    return skipFrame();
                 return skipArray();
 
+            case DiskTag::PackedArray:
+                if (m_version == DiskVersion::V2)
+                    return skipFrame();
+                return skipPackedArray();
+
             case DiskTag::OptBegin:
                 return skipOpt();
 
@@ -346,10 +758,10 @@ class DiskDecodeCodec {
                 return false;
 
             case DiskTag::Fixed32:
-                f32();
+                f32(0);
                 return ok();
             case DiskTag::Fixed64:
-                f64();
+                f64(0);
                 return ok();
             case DiskTag::Varint:
                 readVarint();
@@ -370,8 +782,22 @@ class DiskDecodeCodec {
     }
 
     ao::pack::Error m_error = ao::pack::Error::Ok;
-    CodecTable const& m_codec;
+    CodecTableView m_codec;
     InStream& m_stream;
+    DiskVersion m_version;
+    bool m_fieldHeaderRead = false;
+    uint64_t m_fieldNumber = 0;
+    // Value tag of the compact field key read last
+    DiskTag m_keyTag = DiskTag::Unknown;
+
+    bool m_delta = false;
+    std::vector<uint64_t> m_deltas;
+    size_t m_nextDelta = 0;
+
+    // Element tag of the packed array being read
+    DiskTag m_packed = DiskTag::Unknown;
+    std::vector<std::byte> m_packedBytes;
+    size_t m_nextPacked = 0;
 };
 
 static_assert(CodecDecode<DiskDecodeCodec<ao::pack::byte::ReadStream>>);
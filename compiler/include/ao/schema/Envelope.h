@@ -0,0 +1,86 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "ao/pack/ByteStream.h"
+#include "ao/pack/Error.h"
+#include "ao/pack/Varint.h"
+
+namespace ao::schema::envelope {
+// Envelopes frame whole encoded messages so different message types can
+// share one byte stream. A frame is
+//   <message number><payload length><payload>
+// with both header values stored as prefix ints. The payload is whatever a
+// codec produced for the message, readers look the message number up to get
+// the decode entry and skip frames they do not want by their length.
+
+// Writes `payload` as one frame of `messageNumber`
+template <class WriteStream>
+bool writeEnvelope(WriteStream& stream,
+                   uint64_t messageNumber,
+                   std::span<std::byte const> payload) {
+    if (!pack::encodePrefixInt(stream, messageNumber) ||
+        !pack::encodePrefixInt(stream, payload.size()))
+        return false;
+    return stream.bytes(payload, payload.size()).ok();
+}
+
+struct Envelope {
+    uint64_t messageNumber = 0;
+    // View into the data the reader walks
+    std::span<std::byte const> payload;
+};
+
+// Walks the frames of an envelope stream without touching the payloads
+class EnvelopeReader {
+   public:
+    EnvelopeReader(std::span<std::byte const> data)
+        : m_data(data), m_stream(data) {}
+
+    // Reads the next frame into `out`. Returns false once the data is used up
+    // or a frame is truncated, error() tells the two apart.
+    bool next(Envelope& out) {
+        if (!ok() || m_stream.remainingBytes() == 0)
+            return false;
+        uint64_t number = 0;
+        uint64_t length = 0;
+        if (!pack::decodePrefixInt(m_stream, number) ||
+            !pack::decodePrefixInt(m_stream, length))
+            return false;
+        auto const start = m_stream.position();
+        if (!m_stream.advance(length).ok())
+            return false;
+        out = {
+            .messageNumber = number,
+            .payload = m_data.subspan(start, length),
+        };
+        return true;
+    }
+
+    size_t position() const { return m_stream.position(); }
+    bool ok() const { return m_stream.ok(); }
+    pack::Error error() const { return m_stream.error(); }
+
+   private:
+    std::span<std::byte const> m_data;
+    pack::byte::ReadStream m_stream;
+};
+
+// Calls `onMessage(messageId, envelope)` for every frame whose message number
+// `index` knows and skips all others. `index` is anything with
+// getId(size_t messageNumber), a vm::MessageIndex, a loaded VM image or the
+// generated schema tables. Returns Ok once every frame was read.
+template <class Index, class Fn>
+pack::Error dispatchEnvelopes(std::span<std::byte const> data,
+                              Index const& index,
+                              Fn&& onMessage) {
+    EnvelopeReader reader{data};
+    Envelope envelope;
+    while (reader.next(envelope)) {
+        if (auto id = index.getId((size_t)envelope.messageNumber))
+            onMessage(*id, envelope);
+    }
+    return reader.error();
+}
+}  // namespace ao::schema::envelope
@@ -0,0 +1,50 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+
+#include "ao/schema/CodecCommon.h"
+#include "ao/schema/VM.h"
+
+namespace ao::schema::json {
+struct JsonTable;
+}
+
+namespace ao::schema::cpp {
+struct GeneratedMessage {
+    uint64_t messageNumber;
+    std::string_view name;
+    uint64_t id;
+};
+
+// Schema tables the C++ backend emits into static storage of the generated
+// code, generated types run the VM from these without loading the IR
+struct GeneratedSchema {
+    vm::ProgramView encode;
+    vm::ProgramView decode;
+    codec::CodecTableView codec;
+    json::JsonTable const* json = nullptr;
+    // Messages with a message number, sorted by number
+    std::span<GeneratedMessage const> messagesByNumber;
+    // All messages sorted by qualified name
+    std::span<GeneratedMessage const> messagesByName;
+
+    std::optional<uint64_t> getId(std::string_view qualifiedName) const {
+        auto it = std::ranges::lower_bound(messagesByName, qualifiedName, {},
+                                           &GeneratedMessage::name);
+        if (it == messagesByName.end() || it->name != qualifiedName)
+            return {};
+        return it->id;
+    }
+    std::optional<uint64_t> getId(size_t messageNumber) const {
+        auto it = std::ranges::lower_bound(messagesByNumber,
+                                           (uint64_t)messageNumber, {},
+                                           &GeneratedMessage::messageNumber);
+        if (it == messagesByNumber.end() || it->messageNumber != messageNumber)
+            return {};
+        return it->id;
+    }
+};
+}  // namespace ao::schema::cpp
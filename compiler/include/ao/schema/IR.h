@@ -1,6 +1,8 @@
 #pragma once
 
 #include <boost/container_hash/hash.hpp>
+#include <bit>
+#include <cmath>
 #include <compare>
 #include <cstdint>
 #include <map>
@@ -18,7 +20,7 @@
 
 #include "ao/meta/Reflect.h"
 
-#include "ao/utils/Blake3Hasher.h"
+#include "ao/schema/Checksum.h"
 
 // We need to maybe make this incremental?
 // That means the IR generate context needs to be there
@@ -28,7 +30,9 @@ struct Type;
 struct IRHeader {
     // aosl in hex
     uint32_t magic = 0x616f736c;
-    uint64_t version = 2;
+    uint64_t version = 5;
+    // Hasher for the trailing hash of the IR
+    ChecksumKind checksum = ChecksumKind::Blake3;
 
     auto operator<=>(IRHeader const& other) const = default;
 };
@@ -146,6 +150,28 @@ struct Message {
     }
 };
 
+// Net encodes floats as round((value - min) / precision) in `bits` bits
+struct FloatQuantization {
+    AO_MEMBER(double, min);
+    AO_MEMBER(double, max);
+    AO_MEMBER(double, precision);
+    auto operator<=>(FloatQuantization const& other) const = default;
+
+    uint64_t maxSteps() const {
+        return (uint64_t)std::ceil((max - min) / precision);
+    }
+    size_t bits() const {
+        return std::max<size_t>(std::bit_width(maxSteps()), 1);
+    }
+};
+inline size_t hash_value(FloatQuantization const& quant) {
+    size_t ret = 0;
+    boost::hash_combine(ret, quant.min);
+    boost::hash_combine(ret, quant.max);
+    boost::hash_combine(ret, quant.precision);
+    return ret;
+}
+
 struct Scalar {
     enum ScalarKind : uint8_t {
         BOOL,
@@ -164,19 +190,32 @@ struct Scalar {
     // than the compiler itself
     AO_MEMBER(ScalarKind, kind);
     AO_MEMBER(size_t, width) = 0;
+    // Only set for F32/F64
+    AO_MEMBER(std::optional<FloatQuantization>, quantization);
     auto operator<=>(Scalar const& other) const = default;
 };
 inline size_t hash_value(Scalar const& scalar) {
     size_t ret = 0;
     boost::hash_combine(ret, scalar.kind);
     boost::hash_combine(ret, scalar.width);
+    boost::hash_combine(ret, scalar.quantization);
     return ret;
 }
 
 struct Array {
+    enum Encoding : uint8_t {
+        PLAIN,
+        // Integer elements stored as the first value followed by zigzag
+        // deltas, set from @net(encoding="delta") and @disk(encoding="delta")
+        DELTA,
+
+        EncodingMax,
+    };
     AO_MEMBER(IdFor<Type>, type);
     AO_MEMBER(std::optional<uint64_t>, minSize);
     AO_MEMBER(std::optional<uint64_t>, maxSize);
+    AO_MEMBER(Encoding, netEncoding) = PLAIN;
+    AO_MEMBER(Encoding, diskEncoding) = PLAIN;
 
     auto operator<=>(Array const& other) const = default;
 };
@@ -184,6 +223,8 @@ inline size_t hash_value(Array const& scalar) {
     size_t ret = 0;
     boost::hash_combine(ret, scalar.type);
     boost::hash_combine(ret, scalar.maxSize);
+    boost::hash_combine(ret, scalar.netEncoding);
+    boost::hash_combine(ret, scalar.diskEncoding);
     return ret;
 }
 
@@ -269,20 +310,25 @@ IR generateIR(
     ErrorContext& errors);
 
 template <class Stream>
-bool serializeIRFile(Stream& stream, IR const& ir) {
+bool serializeIRFile(Stream& stream,
+                     IR const& ir,
+                     ChecksumKind checksum = ChecksumKind::Blake3) {
     IRHeader header{};
+    header.checksum = checksum;
     ao::schema::serialize(stream, header);
     if (!stream.ok())
         return false;
-    ao::pack::HashingStream<Stream, utils::hash::Blake3Hasher> hashingStream(
-        stream);
-    hashingStream.enableHashing();
-    ao::schema::serialize(hashingStream, ir);
-    if (!stream.ok())
-        return false;
-    auto computedHash = hashingStream.digest();
-    ao::schema::serialize(stream, computedHash);
-    return stream.ok();
+    return withHasher(checksum, [&](auto hasher) {
+        ao::pack::HashingStream<Stream, decltype(hasher)> hashingStream(
+            stream, std::move(hasher));
+        hashingStream.enableHashing();
+        ao::schema::serialize(hashingStream, ir);
+        if (!stream.ok())
+            return false;
+        auto computedHash = hashingStream.digest();
+        ao::schema::serialize(stream, computedHash);
+        return stream.ok();
+    });
 }
 
 template <class Stream>
@@ -294,21 +340,24 @@ bool deserializeIRFile(Stream& stream, IR& out) {
 
     out = IR{};
 
-    ao::pack::HashingStream<Stream, utils::hash::Blake3Hasher> hashingStream(
-        stream);
-    hashingStream.enableHashing();
-    ao::schema::deserialize(hashingStream, out);
-    if (!stream.ok())
-        return false;
-    auto computedHash = hashingStream.digest();
-
-    utils::hash::Blake3Hasher::Hash expectedHash = {};
-    ao::schema::deserialize(stream, expectedHash);
-    if (!stream.ok())
-        return false;
-
-    stream.require(computedHash == expectedHash, ao::pack::Error::BadData);
-    return stream.ok();
+    return withHasher(header.checksum, [&](auto hasher) {
+        using Hasher = decltype(hasher);
+        ao::pack::HashingStream<Stream, Hasher> hashingStream(
+            stream, std::move(hasher));
+        hashingStream.enableHashing();
+        ao::schema::deserialize(hashingStream, out);
+        if (!stream.ok())
+            return false;
+        auto computedHash = hashingStream.digest();
+
+        typename Hasher::Hash expectedHash = {};
+        ao::schema::deserialize(stream, expectedHash);
+        if (!stream.ok())
+            return false;
+
+        stream.require(computedHash == expectedHash, ao::pack::Error::BadData);
+        return stream.ok();
+    });
 }
 
 }  // namespace ao::schema::ir
@@ -320,12 +369,16 @@ struct Serializer<ir::IRHeader> {
     void serialize(Stream& stream, ir::IRHeader const& prop) {
         Serializer<uint32_t>{}.serialize(stream, prop.magic);
         Serializer<uint64_t>{}.serialize(stream, prop.version);
+        Serializer<ChecksumKind>{}.serialize(stream, prop.checksum);
     }
     template <class Stream>
     void deserialize(Stream& stream, ir::IRHeader& prop) {
         Serializer<uint32_t>{}.deserialize(stream, prop.magic);
         Serializer<uint64_t>{}.deserialize(stream, prop.version);
-        stream.require(prop == ir::IRHeader{}, ao::pack::Error::BadData);
+        stream.require(prop.magic == ir::IRHeader{}.magic &&
+                           prop.version == ir::IRHeader{}.version,
+                       ao::pack::Error::BadData);
+        Serializer<ChecksumKind>{}.deserialize(stream, prop.checksum);
     }
 };
 template <>
@@ -339,4 +392,9 @@ struct Serializer<ir::Scalar::ScalarKind>
     : public EnumSerializer<ir::Scalar::ScalarKind, ir::Scalar::ScalarMax> {
     using EnumSerializer::EnumSerializer;
 };
+template <>
+struct Serializer<ir::Array::Encoding>
+    : public EnumSerializer<ir::Array::Encoding, ir::Array::EncodingMax> {
+    using EnumSerializer::EnumSerializer;
+};
 }  // namespace ao::schema
@@ -11,6 +11,7 @@
 #include "ao/schema/VM.h"
 
 #include "Codec.h"
+#include "DeltaCodec.h"
 #include "ao/pack/BitStream.h"
 
 namespace ao::schema::json {
@@ -126,6 +127,8 @@ class JsonDecodeAdapter {
     // Field navigation:
     void fieldBegin(uint32_t fieldId);
     void fieldEnd();
+    // Sets a field of the current message to null
+    void fieldDefault(uint32_t fieldId);
 
     // Optional:
     // For optional decode, codec typically reads "present bit" and VM branches;
@@ -220,6 +223,7 @@ struct JsonEncodeState {
 
 JsonEncodeState generateJsonEncodeState(ir::IR const& ir, ErrorContext& errs);
 
+template <vm::ErrorCheck Check = vm::ErrorCheck::Eager>
 inline vm::VM encodeJson(JsonEncodeState const& state,
                          nlohmann::json const& json,
                          pack::bit::WriteStream& stream,
@@ -229,55 +233,118 @@ inline vm::VM encodeJson(JsonEncodeState const& state,
         state.codec,
         stream,
     };
-    auto machine = vm::VM{&state.format.encode};
-    vm::encode(machine, object, codec, messageId);
+    auto machine = vm::VM{state.format.encode};
+    vm::encode<Check>(machine, object, codec, messageId);
     return machine;
 }
+template <vm::ErrorCheck Check = vm::ErrorCheck::Eager>
 inline vm::VM decodeJson(JsonEncodeState const& state,
                          pack::bit::ReadStream& stream,
                          nlohmann::json& json,
                          uint64_t messageId) {
     JsonDecodeAdapter object{state.json};
-    codec::net::NetDecode codec{
-        state.codec,
-        stream,
-    };
-    auto machine = vm::VM{&state.format.decode};
-    auto success = vm::decode(machine, object, codec, messageId);
+    auto machine = vm::VM{state.format.decode};
+    auto success = codec::net::withNetDecode(
+        state.codec, (uint32_t)messageId, stream, [&](auto& codec) {
+            return vm::decode<Check>(machine, object, codec, messageId);
+        });
     if (success) {
         json = object.root();
     }
     return machine;
 }
 
+template <vm::ErrorCheck Check = vm::ErrorCheck::Eager>
 inline vm::VM encodeJson(JsonEncodeState const& state,
                          nlohmann::json const& json,
-                         pack::byte::WriteStream& stream,
+                         codec::net::NetAlignedWriteStream& stream,
                          uint64_t messageId) {
     JsonEncodeAdapter object{state.json, json};
-    codec::disk::DiskEncodeCodec<pack::byte::WriteStream> codec{
+    codec::net::NetAlignedEncode codec{
         state.codec,
         stream,
     };
-    auto machine = vm::VM{&state.format.encode};
-    vm::encode(machine, object, codec, messageId);
+    auto machine = vm::VM{state.format.encode};
+    vm::encode<Check>(machine, object, codec, messageId);
     return machine;
 }
+template <vm::ErrorCheck Check = vm::ErrorCheck::Eager>
 inline vm::VM decodeJson(JsonEncodeState const& state,
-                         pack::byte::ReadStream& stream,
+                         codec::net::NetAlignedReadStream& stream,
                          nlohmann::json& json,
                          uint64_t messageId) {
     JsonDecodeAdapter object{state.json};
+    codec::net::NetAlignedDecode codec{
+        state.codec,
+        stream,
+    };
+    auto machine = vm::VM{state.format.decode};
+    auto success = vm::decode<Check>(machine, object, codec, messageId);
+    if (success) {
+        json = object.root();
+    }
+    return machine;
+}
+
+template <vm::ErrorCheck Check = vm::ErrorCheck::Eager>
+inline vm::VM encodeJson(
+    JsonEncodeState const& state,
+    nlohmann::json const& json,
+    pack::byte::WriteStream& stream,
+    uint64_t messageId,
+    codec::disk::DiskVersion version = codec::disk::DiskVersion::V1) {
+    JsonEncodeAdapter object{state.json, json};
+    codec::disk::DiskEncodeCodec<pack::byte::WriteStream> codec{
+        state.codec,
+        stream,
+        version,
+    };
+    auto machine = vm::VM{state.format.encode};
+    vm::encode<Check>(machine, object, codec, messageId);
+    return machine;
+}
+template <vm::ErrorCheck Check = vm::ErrorCheck::Eager>
+inline vm::VM decodeJson(
+    JsonEncodeState const& state,
+    pack::byte::ReadStream& stream,
+    nlohmann::json& json,
+    uint64_t messageId,
+    codec::disk::DiskVersion version = codec::disk::DiskVersion::V1) {
+    JsonDecodeAdapter object{state.json};
     codec::disk::DiskDecodeCodec<pack::byte::ReadStream> codec{
         state.codec,
         stream,
+        version,
     };
-    auto machine = vm::VM{&state.format.decode};
-    auto success = vm::decode(machine, object, codec, messageId);
+    auto machine = vm::VM{state.format.decode};
+    auto success = vm::decode<Check>(machine, object, codec, messageId);
     if (success) {
         json = object.root();
     }
     return machine;
 }
 
+inline vm::VM recordJsonSnapshot(JsonEncodeState const& state,
+                                 nlohmann::json const& json,
+                                 codec::delta::DeltaSnapshot& snapshot,
+                                 uint64_t messageId) {
+    JsonEncodeAdapter object{state.json, json};
+    return codec::delta::recordSnapshot(state.format.encode, state.codec,
+                                        object, messageId, snapshot);
+}
+inline vm::VM decodeJsonDelta(JsonEncodeState const& state,
+                              codec::delta::DeltaSnapshot const& baseline,
+                              pack::bit::ReadStream& stream,
+                              nlohmann::json& json,
+                              uint64_t messageId) {
+    JsonDecodeAdapter object{state.json};
+    auto machine = codec::delta::decodeDelta(state.format.decode, state.codec,
+                                             baseline, stream, object,
+                                             messageId);
+    if (machine.error == vm::VMError::Ok) {
+        json = object.root();
+    }
+    return machine;
+}
+
 }  // namespace ao::schema::json
@@ -1,9 +1,12 @@
 #pragma once
 
+#include <algorithm>
 #include <bit>
+#include <cmath>
 #include <cstdint>
 #include <vector>
 
+#include "ao/pack/AlignedStream.h"
 #include "ao/pack/BitStream.h"
 #include "ao/pack/ByteStream.h"
 #include "ao/pack/Varint.h"
@@ -16,7 +19,7 @@ template <class OutStream>
 struct NetEncodeCodec {
     using ChunkSize = CodecBits;
 
-    CodecTable const& net;
+    CodecTableView net;
     OutStream& out;
 
     // Message boundaries (presence bitmaps/alignment are codec concerns).
@@ -33,6 +36,8 @@ struct NetEncodeCodec {
 
     void boolean(bool v) { out.bits(v ? 1u : 0u, 1); }
     void u64(uint32_t bw, uint64_t v) {
+        if (delta)
+            return deltaValue(v);
         if (bw == 0) {
             ao::pack::encodePrefixInt(out, v);
         } else {
@@ -40,6 +45,8 @@ struct NetEncodeCodec {
         }
     }
     void i64(uint32_t bw, int64_t v) {
+        if (delta)
+            return deltaValue(static_cast<uint64_t>(v));
         if (bw == 0) {
             auto u = ao::pack::encodeZigZag(v);
             ao::pack::encodePrefixInt(out, u);
@@ -48,18 +55,45 @@ struct NetEncodeCodec {
             out.bits(static_cast<uint64_t>(v), bw);
         }
     }
-    void f32(float f) {
+    void f32(uint32_t quant, float f) {
+        if (quant != 0)
+            return quantized(quant, f);
         uint32_t bits = std::bit_cast<uint32_t>(f);
         out.bits(bits, 32);
     }
-    void f64(double d) {
+    void f64(uint32_t quant, double d) {
+        if (quant != 0)
+            return quantized(quant, d);
         uint64_t bits = std::bit_cast<uint64_t>(d);
         out.bits(bits, 64);
     }
+    // Values outside of [min, max] are clamped, NaN is sent as min
+    void quantized(uint32_t quant, double v) {
+        auto const& q = net.quantizations[quant - 1];
+        // Clamp before converting, llround is unspecified outside long long
+        auto scaled = (v - q.min) / q.precision;
+        if (std::isnan(scaled))
+            scaled = 0;
+        scaled = std::clamp(scaled, 0.0, static_cast<double>(q.maxSteps));
+        auto steps = std::min(static_cast<uint64_t>(std::llround(scaled)),
+                              q.maxSteps);
+        out.bits(steps, q.bits);
+    }
+
+    // Delta arrays only hold integers, so every value until arrayEnd is an
+    // element. They are written as a prefix int zigzag delta of the previous
+    void deltaValue(uint64_t v) {
+        ao::pack::encodePrefixInt(out,
+                                  ao::pack::encodeZigZagDelta(previous, v));
+        previous = v;
+    }
 
     // Arrays: if net needs length prefix, write it here; otherwise no-op.
-    void arrayBegin(uint32_t /* typeId */) {}
-    void arrayEnd() {}
+    void arrayBegin(uint32_t typeId) {
+        delta = net.hasFlag(typeId, CodecType::NetDelta);
+        previous = 0;
+    }
+    void arrayEnd() { delta = false; }
     void arrayLen(uint32_t width, uint32_t len) {
         if (width == 0) {
             // use prefix-int length encoding
@@ -90,6 +124,9 @@ struct NetEncodeCodec {
 
     bool ok() const { return out.ok(); }
     ao::pack::Error error() const { return out.error(); }
+
+    bool delta = false;
+    uint64_t previous = 0;
 };
 static_assert(CodecEncode<NetEncodeCodec<ao::pack::bit::WriteStream>>);
 using NetEncode = NetEncodeCodec<ao::pack::bit::WriteStream>;
@@ -98,7 +135,7 @@ template <class InStream>
 struct NetDecodeCodec {
     using ChunkSize = CodecBits;
 
-    CodecTable const& net;
+    CodecTableView net;
     InStream& in;
 
     void msgBegin(uint32_t msgId) {
@@ -118,6 +155,8 @@ struct NetDecodeCodec {
     }
 
     uint64_t u64(uint32_t width) {
+        if (delta)
+            return deltaValue();
         uint64_t v = 0;
         if (width == 0) {
             ao::pack::decodePrefixInt(in, v);
@@ -128,6 +167,8 @@ struct NetDecodeCodec {
     }
 
     int64_t i64(uint32_t bw) {
+        if (delta)
+            return static_cast<int64_t>(deltaValue());
         uint64_t u = 0;
         if (bw > 0) {
             in.bits(u, bw);
@@ -147,17 +188,28 @@ struct NetDecodeCodec {
         }
     }
 
-    float f32() {
+    float f32(uint32_t quant) {
+        if (quant != 0)
+            return static_cast<float>(quantized(quant));
         uint64_t u = 0;
         in.bits(u, 32);
         return std::bit_cast<float>(static_cast<uint32_t>(u));
     }
 
-    double f64() {
+    double f64(uint32_t quant) {
+        if (quant != 0)
+            return quantized(quant);
         uint64_t bits = 0;
         in.bits(bits, 64);
         return std::bit_cast<double>(bits);
     }
+    double quantized(uint32_t quant) {
+        auto const& q = net.quantizations[quant - 1];
+        uint64_t steps = 0;
+        in.bits(steps, q.bits);
+        return std::min(q.min + static_cast<double>(steps) * q.precision,
+                        q.max);
+    }
 
     void optBegin() {}
     void optEnd() {}
@@ -168,8 +220,10 @@ struct NetDecodeCodec {
         return (b & 1u) != 0;
     }
 
-    void arrayBegin(uint32_t typeId) {}
-    void arrayEnd() {}
+    void arrayBegin(uint32_t typeId) {
+        delta = net.hasFlag(typeId, CodecType::NetDelta);
+    }
+    void arrayEnd() { delta = false; }
     uint32_t arrayLen(uint32_t width) {
         uint64_t u = 0;
         if (width != 0) {
@@ -177,8 +231,28 @@ struct NetDecodeCodec {
         } else {
             ao::pack::decodePrefixInt(in, u);
         }
+        if (delta)
+            readDeltas(static_cast<uint32_t>(u));
         return static_cast<uint32_t>(u);
     }
+    // The whole array is read up front so the prefix sum runs as one batch,
+    // elements are then handed out in order
+    void readDeltas(uint32_t len) {
+        deltas.clear();
+        nextDelta = 0;
+        for (uint32_t i = 0; i < len && in.ok(); ++i) {
+            uint64_t v = 0;
+            if (!ao::pack::decodePrefixInt(in, v))
+                return;
+            deltas.push_back(v);
+        }
+        ao::pack::decodeZigZagDeltas(deltas);
+    }
+    uint64_t deltaValue() {
+        if (nextDelta >= deltas.size())
+            return 0;
+        return deltas[nextDelta++];
+    }
 
     void oneofEnter(uint32_t typeId) {}
     void oneofExit() {}
@@ -193,8 +267,50 @@ struct NetDecodeCodec {
 
     bool ok() const { return in.ok(); }
     ao::pack::Error error() const { return in.error(); }
+
+    bool delta = false;
+    std::vector<uint64_t> deltas = {};
+    size_t nextDelta = 0;
 };
 using NetDecode = NetDecodeCodec<ao::pack::bit::ReadStream>;
 static_assert(CodecDecode<NetDecodeCodec<ao::pack::bit::ReadStream>>);
 
+// Decoder without per read bounds checks, only for input holding at least
+// CodecTableView::netMaxBitsOf() the type being decoded, see withNetDecode
+using NetTrustedDecode = NetDecodeCodec<ao::pack::bit::TrustedReadStream>;
+static_assert(CodecDecode<NetTrustedDecode>);
+
+// Calls `run` with a codec to decode `typeId` from `in`. When the remaining
+// input covers the worst case encoding of the type no read can run past the
+// end, so this checks the size once and hands out a NetTrustedDecode, any
+// other input gets a checked NetDecode. `in` ends up where decoding stopped.
+template <class Run>
+auto withNetDecode(CodecTableView net,
+                   uint32_t typeId,
+                   ao::pack::bit::ReadStream& in,
+                   Run&& run) {
+    if (!in.ok() || in.remainingBits() < net.netMaxBitsOf(typeId)) {
+        NetDecode codec{net, in};
+        return run(codec);
+    }
+    ao::pack::bit::TrustedReadStream trusted{in.data(), in.position()};
+    NetTrustedDecode codec{net, trusted};
+    auto ret = run(codec);
+    in.seek(trusted.position());
+    in.require(trusted.ok(), trusted.error());
+    return ret;
+}
+
+// Byte aligned profile for links that are CPU rather than bandwidth bound.
+// Same schema and field order as the net format, but every field is rounded
+// up to whole bytes.
+using NetAlignedWriteStream =
+    ao::pack::byte::AlignedWriteStream<ao::pack::byte::WriteStream>;
+using NetAlignedReadStream =
+    ao::pack::byte::AlignedReadStream<ao::pack::byte::ReadStream>;
+using NetAlignedEncode = NetEncodeCodec<NetAlignedWriteStream>;
+using NetAlignedDecode = NetDecodeCodec<NetAlignedReadStream>;
+static_assert(CodecEncode<NetAlignedEncode>);
+static_assert(CodecDecode<NetAlignedDecode>);
+
 }  // namespace ao::schema::codec::net
@@ -1,6 +1,7 @@
 #pragma once
 #include <compare>
 #include <cstdint>
+#include <span>
 #include <vector>
 
 #include <nlohmann/json.hpp>
@@ -173,6 +174,16 @@ enum class Op : uint8_t {
 
     // Disk codec functions
 
+    C_FIELD_LOOKUP,
+    // flag = codec decodes fields in any order through the field lookup
+    // table, 0 for codecs that only read them in schema order
+
+    C_NEXT_FIELD,
+    // imm16: message id
+    // flag = another field follows in the current message
+    // reg = index of that field within the message, the message's field
+    // count for unknown fields
+
     // Object Functions
     O_WRITE_SCALAR,
     // Switch on scalar type and write it
@@ -193,6 +204,11 @@ enum class Op : uint8_t {
     // adapter.arrLen(reg)
     O_READ_ARRAY_LEN,
     // reg = adapter.arrLen()
+
+    O_FIELD_DEFAULT,
+    // imm16: field id
+    // adapter.fieldDefault(imm16)
+    // Resets a field to its default before the fields in the input are read
 };
 
 struct Instr {
@@ -257,6 +273,26 @@ struct Program {
     std::vector<uint32_t> msgEntryPc;
 };
 
+// Non-owning view of a linked program, the VM runs from this so a program
+// can come from a Format, a mapped VM image or generated static tables
+struct ProgramView {
+    constexpr ProgramView() = default;
+    ProgramView(Program const& prog)
+        : codeWords(prog.codeWords),
+          typeEntryPc(prog.typeEntryPc),
+          msgEntryPc(prog.msgEntryPc) {}
+    constexpr ProgramView(std::span<uint32_t const> codeWords,
+                          std::span<uint32_t const> typeEntryPc,
+                          std::span<uint32_t const> msgEntryPc)
+        : codeWords(codeWords),
+          typeEntryPc(typeEntryPc),
+          msgEntryPc(msgEntryPc) {}
+
+    std::span<uint32_t const> codeWords;
+    std::span<uint32_t const> typeEntryPc;
+    std::span<uint32_t const> msgEntryPc;
+};
+
 struct Format {
     Program encode;
     Program decode;
@@ -292,7 +328,7 @@ struct OneofFrame {
 };
 
 struct VM {
-    Program const* prog = nullptr;
+    ProgramView prog = {};
 
     uint32_t pc = 0;
     uint8_t flag = 0;
@@ -311,6 +347,16 @@ struct VM {
     VMError error;
 };
 
+// When the VM looks at the object and codec error state
+enum class ErrorCheck : uint8_t {
+    // After every instruction
+    Eager,
+    // Only at calls, returns, loop back edges and HALT. Adapters and codecs
+    // keep being called after they fail until the next check, so they must
+    // treat calls in an errored state as no-ops returning neutral values.
+    Deferred,
+};
+
 struct VMSettings {
     size_t maxSteps = 10000;
     size_t maxRecursionDepth = 64;
@@ -345,13 +391,19 @@ bool writeScalar(Instr instr, VM& vm, Object& o) {
             o.i64(instr.imm, vm.reg);
             break;
         case ScalarKind::F32: {
-            auto tmp = (uint32_t)vm.reg;
-            o.f32(std::bit_cast<float>(tmp));
+            auto tmp = std::bit_cast<float>((uint32_t)vm.reg);
+            if constexpr (codec::CodecEncode<Object>)
+                o.f32(instr.imm, tmp);
+            else
+                o.f32(tmp);
+        } break;
+        case ScalarKind::F64: {
+            auto tmp = std::bit_cast<double>(vm.reg);
+            if constexpr (codec::CodecEncode<Object>)
+                o.f64(instr.imm, tmp);
+            else
+                o.f64(tmp);
         } break;
-        case ScalarKind::F64:
-            o.f64(std::bit_cast<double>(vm.reg));
-            break;
-            break;
         default:
             vm.error = VMError::InvalidInstr;
             return false;
@@ -373,10 +425,16 @@ bool readScalar(Instr instr, VM& vm, Object& o) {
             vm.reg = std::bit_cast<uint64_t>(o.i64(instr.imm));
             break;
         case ScalarKind::F32:
-            vm.reg = std::bit_cast<uint32_t>(o.f32());
+            if constexpr (codec::CodecDecode<Object>)
+                vm.reg = std::bit_cast<uint32_t>(o.f32(instr.imm));
+            else
+                vm.reg = std::bit_cast<uint32_t>(o.f32());
             break;
         case ScalarKind::F64:
-            vm.reg = std::bit_cast<uint64_t>(o.f64());
+            if constexpr (codec::CodecDecode<Object>)
+                vm.reg = std::bit_cast<uint64_t>(o.f64(instr.imm));
+            else
+                vm.reg = std::bit_cast<uint64_t>(o.f64());
             break;
         default:
             vm.error = VMError::InvalidInstr;
@@ -385,18 +443,49 @@ bool readScalar(Instr instr, VM& vm, Object& o) {
     return true;
 }
 
-template <bool EncodeMode, class Object, class Codec>
+template <class Object, class Codec>
+bool checkErrors(VM& vm, Object& object, Codec& codec) {
+    if (!object.ok()) {
+        vm.error = VMError::ObjectError;
+        return false;
+    }
+    if (!codec.ok()) {
+        vm.error = VMError::CodecError;
+        return false;
+    }
+    return true;
+}
+
+// Every path that repeats or recurses goes through one of these, so a
+// deferred check still stops a failed run after a bounded amount of work.
+// C_NEXT_FIELD heads the field loop of codecs with a field lookup.
+constexpr bool isErrorCheckpoint(Op op) {
+    switch (op) {
+        case Op::CALL_TYPE:
+        case Op::CALL_TYPE_INDIRECT:
+        case Op::RET:
+        case Op::ARRAY_NEXT:
+        case Op::C_NEXT_FIELD:
+            return true;
+        default:
+            return false;
+    }
+}
+
+template <bool EncodeMode, ErrorCheck Check, class Object, class Codec>
 bool runInstr(VM& vm, Object& object, Codec& codec) {
-    if (vm.pc >= vm.prog->codeWords.size()) {
+    if (vm.pc >= vm.prog.codeWords.size()) {
         vm.error = VMError::RuntimeError;
         return false;
     }
-    auto instr = decodeInstr(vm.prog->codeWords[vm.pc]);
+    auto instr = decodeInstr(vm.prog.codeWords[vm.pc]);
     auto nextPc = vm.pc + 1;
 
     switch (instr.op) {
         case Op::HALT:
             // Break from the program
+            if constexpr (Check == ErrorCheck::Deferred)
+                checkErrors(vm, object, codec);
             return false;
         case Op::JMP:
             nextPc = vm.pc + static_cast<int16_t>(instr.imm);
@@ -424,25 +513,25 @@ bool runInstr(VM& vm, Object& object, Codec& codec) {
             vm.callStack.emplace_back(CallFrame{
                 .retPc = nextPc,
             });
-            nextPc = vm.prog->typeEntryPc[instr.imm];
+            nextPc = vm.prog.typeEntryPc[instr.imm];
         } break;
         case Op::CALL_TYPE_INDIRECT: {
             vm.stackDepth += 1;
             vm.callStack.emplace_back(CallFrame{
                 .retPc = nextPc,
             });
-            if (vm.reg >= vm.prog->typeEntryPc.size()) {
+            if (vm.reg >= vm.prog.typeEntryPc.size()) {
                 vm.error = VMError::RuntimeError;
                 return false;
             }
-            nextPc = vm.prog->typeEntryPc[vm.reg];
+            nextPc = vm.prog.typeEntryPc[vm.reg];
         } break;
         case Op::DISPATCH: {
             auto pc = vm.pc;
-            pc += std::min(vm.reg + 1, static_cast<uint64_t>(instr.imm));
-            if (pc >= vm.prog->codeWords.size())
+            pc += std::min(vm.reg, static_cast<uint64_t>(instr.imm)) + 1;
+            if (pc >= vm.prog.codeWords.size())
                 return (vm.error = VMError::RuntimeError, false);
-            nextPc = vm.pc + vm.prog->codeWords[pc];
+            nextPc = vm.pc + vm.prog.codeWords[pc];
         } break;
         case Op::MSG_BEGIN: {
             object.msgBegin(instr.imm);
@@ -521,12 +610,9 @@ bool runInstr(VM& vm, Object& object, Codec& codec) {
             vm.flag = vm.arrayStack.back().idx < vm.arrayStack.back().len;
         } break;
         case Op::ENVELOPE_BEGIN:
-            // TODO add this to main
-            // TODO, we need a way to start the VM with envelope
-            break;
         case Op::ENVELOPE_END:
-            // TODO add this to main
-            // TODO, we need a way to start the VM with envelope
+            // Envelopes are framed around whole messages outside the VM, see
+            // Envelope.h
             break;
         case Op::C_WRITE_SCALAR: {
             if constexpr (EncodeMode) {
@@ -598,6 +684,21 @@ bool runInstr(VM& vm, Object& object, Codec& codec) {
                 vm.flag = codec.skipField(instr.imm);
             }
         } break;
+        case Op::C_FIELD_LOOKUP: {
+            vm.flag = 0;
+            if constexpr (requires { codec.fieldLookup(); })
+                vm.flag = codec.fieldLookup();
+        } break;
+        case Op::C_NEXT_FIELD: {
+            if constexpr (requires { codec.nextField(uint32_t{}); }) {
+                auto next = codec.nextField(instr.imm);
+                vm.flag = next.has_value();
+                vm.reg = next.value_or(0);
+            } else {
+                vm.error = VMError::InvalidInstr;
+                return false;
+            }
+        } break;
         case Op::O_WRITE_SCALAR: {
             if constexpr (!EncodeMode) {
                 if (!writeScalar(instr, vm, object))
@@ -649,36 +750,40 @@ bool runInstr(VM& vm, Object& object, Codec& codec) {
                 vm.arrayStack.back().len = vm.reg;
             }
         } break;
+        case Op::O_FIELD_DEFAULT: {
+            if constexpr (!EncodeMode) {
+                object.fieldDefault(instr.imm);
+            } else {
+                vm.error = VMError::InvalidInstr;
+                return false;
+            }
+        } break;
         default:
             vm.error = VMError::InvalidInstr;
             return false;
     }
 
-    if (!object.ok()) {
-        vm.error = VMError::ObjectError;
-        return false;
-    }
-    if (!codec.ok()) {
-        vm.error = VMError::CodecError;
-        return false;
+    if (Check == ErrorCheck::Eager || isErrorCheckpoint(instr.op)) {
+        if (!checkErrors(vm, object, codec))
+            return false;
     }
 
     vm.pc = nextPc;
     return true;
 }
 
-template <bool EncodeMode, class Object, class Codec>
+template <bool EncodeMode, ErrorCheck Check, class Object, class Codec>
 bool runVM(VM& vm, Object& object, Codec& codec, uint64_t typeId) {
     size_t stepCount = 0;
     reset(vm);
 
-    if (vm.prog == nullptr) {
+    if (vm.prog.codeWords.empty()) {
         vm.error = VMError::InvalidProgram;
         return false;
     }
 
     vm.reg = typeId;
-    while (runInstr<EncodeMode>(vm, object, codec)) {
+    while (runInstr<EncodeMode, Check>(vm, object, codec)) {
     }
 
     // Exit successfully if there are no errors
@@ -686,18 +791,22 @@ bool runVM(VM& vm, Object& object, Codec& codec, uint64_t typeId) {
 }
 }  // namespace detail
 
-template <class ObjectAdapter, class CodecAdapter>
+template <ErrorCheck Check = ErrorCheck::Eager,
+          class ObjectAdapter,
+          class CodecAdapter>
 bool encode(VM& vm,
             ObjectAdapter& object,
             CodecAdapter& codec,
             uint64_t typeId) {
-    return detail::runVM<true>(vm, object, codec, typeId);
+    return detail::runVM<true, Check>(vm, object, codec, typeId);
 }
-template <class ObjectAdapter, class CodecAdapter>
+template <ErrorCheck Check = ErrorCheck::Eager,
+          class ObjectAdapter,
+          class CodecAdapter>
 bool decode(VM& vm,
             ObjectAdapter& object,
             CodecAdapter& codec,
             uint64_t typeId) {
-    return detail::runVM<false>(vm, object, codec, typeId);
+    return detail::runVM<false, Check>(vm, object, codec, typeId);
 }
 }  // namespace ao::schema::vm
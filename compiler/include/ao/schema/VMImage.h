@@ -0,0 +1,126 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "ao/schema/CodecCommon.h"
+#include "ao/schema/VM.h"
+
+namespace ao::pack {
+class MappedFile;
+}
+
+namespace ao::schema::vm {
+// A VM image is the linked encode/decode programs, message index and codec
+// table of a schema stored in an offset based layout. Loading an image checks
+// the header and hash once and then uses every table in place, so a mapped
+// image costs nothing to start up and is shared between processes.
+//
+// Layout: VMImageHeader, then each section 8 byte aligned. All values are
+// stored in little endian native layout.
+static_assert(std::endian::native == std::endian::little,
+              "VM images are stored little endian");
+
+enum class VMImageSectionKind : uint32_t {
+    EncodeCode,
+    EncodeTypeEntry,
+    EncodeMsgEntry,
+    DecodeCode,
+    DecodeTypeEntry,
+    DecodeMsgEntry,
+    // VMImageMessageNumber sorted by number
+    MessageNumbers,
+    // VMImageMessageName sorted by name, names point into MessageNameChars
+    MessageNames,
+    MessageNameChars,
+    CodecTypes,
+    CodecOneofs,
+    CodecOneofFieldNumbers,
+    CodecQuantizations,
+    CodecFields,
+    // CodecMessage indexed by message id
+    CodecMessages,
+    CodecFieldLookups,
+    // uint64_t per type
+    CodecNetMaxBits,
+
+    Count,
+};
+
+struct VMImageSection {
+    // Byte offset from the start of the image
+    uint64_t offset = 0;
+    // Element count
+    uint64_t count = 0;
+};
+
+struct VMImageHeader {
+    // aovm in hex
+    uint32_t magic = 0x616f766d;
+    uint32_t version = 3;
+    uint64_t imageSize = 0;
+    // Blake3 of the whole image except this field
+    std::array<std::byte, 32> hash = {};
+    std::array<VMImageSection, (size_t)VMImageSectionKind::Count> sections = {};
+};
+static_assert(std::has_unique_object_representations_v<VMImageHeader>);
+
+struct VMImageMessageNumber {
+    uint64_t number;
+    uint64_t id;
+};
+struct VMImageMessageName {
+    uint32_t offset;
+    uint32_t size;
+    uint64_t id;
+};
+
+// Lays out format and codec as a VM image
+std::vector<std::byte> buildVMImage(Format const& format,
+                                    codec::CodecTable const& codec);
+
+template <class Stream>
+bool writeVMImage(Stream& stream,
+                  Format const& format,
+                  codec::CodecTable const& codec) {
+    auto image = buildVMImage(format, codec);
+    stream.bytes(image, image.size());
+    return stream.ok();
+}
+
+// Read only view of a validated VM image, either mapped from a file or over
+// caller owned bytes
+class VMImage {
+   public:
+    // Validates an image held in memory, bytes must be 8 byte aligned and
+    // outlive the returned image
+    static std::optional<VMImage> fromBytes(std::span<std::byte const> bytes);
+    // Maps the file read only and validates it
+    static std::optional<VMImage> map(std::filesystem::path const& path);
+
+    ProgramView encode() const;
+    ProgramView decode() const;
+    codec::CodecTableView codec() const;
+
+    std::optional<uint64_t> getId(std::string_view qualifiedName) const;
+    std::optional<uint64_t> getId(size_t messageNumber) const;
+
+    std::span<std::byte const> bytes() const { return m_bytes; }
+
+   private:
+    template <class T>
+    std::span<T const> section(VMImageSectionKind kind) const;
+
+    std::shared_ptr<pack::MappedFile const> m_file;
+    std::span<std::byte const> m_bytes;
+    VMImageHeader const* m_header = nullptr;
+};
+}  // namespace ao::schema::vm
@@ -0,0 +1,34 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "ao/pack/Disk.h"
+#include "ao/pack/HashingStream.h"
+#include "ao/pack/Word.h"
+
+namespace ao::utils::hash {
+class Crc32cHasher {
+   public:
+    // Little endian CRC32C
+    using Hash = std::array<std::byte, 4>;
+
+    void update(std::span<std::byte const> v) {
+        m_crc = ao::pack::disk::crc32c(v, m_crc);
+    }
+
+    Hash digest() const {
+        Hash out{};
+        ao::pack::storeWord(out.data(), out.size(), m_crc);
+        return out;
+    }
+
+    void reset() { m_crc = 0; }
+
+   private:
+    uint32_t m_crc = 0;
+};
+static_assert(ao::pack::HasherConcept<Crc32cHasher>);
+
+}  // namespace ao::utils::hash
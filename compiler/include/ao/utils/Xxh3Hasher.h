@@ -0,0 +1,34 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <span>
+
+#include "ao/pack/HashingStream.h"
+#include "ao/pack/Word.h"
+#include "ao/pack/Xxh3.h"
+
+namespace ao::utils::hash {
+class Xxh3Hasher {
+   public:
+    // Canonical xxHash layout, high then low half, both big endian
+    using Hash = std::array<std::byte, 16>;
+
+    void update(std::span<std::byte const> v) { m_hasher.update(v); }
+
+    Hash digest() const {
+        auto const hash = m_hasher.digest();
+        Hash out{};
+        ao::pack::storeWord(out.data(), 8, std::byteswap(hash.high));
+        ao::pack::storeWord(out.data() + 8, 8, std::byteswap(hash.low));
+        return out;
+    }
+
+    void reset() { m_hasher.reset(); }
+
+   private:
+    ao::pack::xxh3::Hasher128 m_hasher;
+};
+static_assert(ao::pack::HasherConcept<Xxh3Hasher>);
+
+}  // namespace ao::utils::hash
@@ -75,157 +75,159 @@ uint64_t Assembler::useLabel() {
     return idx;
 }
 
-size_t getMaximumProgramSize(std::vector<Entry> const& entries) {
-    size_t size = 0;
-    for (auto const& e : entries) {
-        std::visit(Overloaded{
-                       [&size](Instr) { ++size; },
-                       [&size](FixUpInstr) { size += 2; },
-                       [&size](FixUp32) { ++size; },
-                   },
-                   e.instr);
+namespace {
+constexpr uint32_t kUndefined = std::numeric_limits<uint32_t>::max();
+
+std::optional<uint64_t> jumpLabel(Entry const& entry) {
+    if (auto fixup = std::get_if<FixUpInstr>(&entry.instr))
+        return fixup->label;
+    if (auto fixup = std::get_if<FixUp32>(&entry.instr))
+        return fixup->label;
+    return {};
+}
+
+// Entry index of every label, kUndefined if it was never placed
+std::optional<std::vector<uint32_t>> resolveLabels(Assembler const& assembler,
+                                                   ErrorContext& err) {
+    std::vector<uint32_t> labelEntry(assembler.labels.size(), kUndefined);
+    bool errored = false;
+    for (uint32_t idx = 0; idx < assembler.instructions.size(); ++idx) {
+        auto const& label = assembler.instructions[idx].label;
+        if (!label)
+            continue;
+        if (*label >= labelEntry.size())
+            labelEntry.resize(*label + 1, kUndefined);
+        if (labelEntry[*label] != kUndefined) {
+            err.fail({
+                .code = ErrorCode::INTERNAL,
+                .message = std::format(
+                    "Assembler: Multiple declarations of label: {}", *label),
+                .loc = {},
+            });
+            errored = true;
+        }
+        labelEntry[*label] = idx;
+    }
+
+    for (auto const& entry : assembler.instructions) {
+        auto label = jumpLabel(entry);
+        if (!label)
+            continue;
+        if (*label < labelEntry.size() && labelEntry[*label] != kUndefined)
+            continue;
+        err.fail({
+            .code = ErrorCode::INTERNAL,
+            .message =
+                std::format("Assembler: Use of undefined label: {}", *label),
+            .loc = {},
+        });
+        errored = true;
+    }
+
+    if (errored)
+        return {};
+    return labelEntry;
+}
+
+// Word offset of every entry, the extra last slot is the program size
+void layoutEntries(std::vector<Entry> const& entries,
+                   std::vector<uint8_t> const& wide,
+                   std::vector<uint64_t>& entryPos) {
+    uint64_t pos = 0;
+    for (size_t idx = 0; idx < entries.size(); ++idx) {
+        entryPos[idx] = pos;
+        pos += 1 + wide[idx];
     }
-    return size;
+    entryPos[entries.size()] = pos;
 }
+}  // namespace
 
 std::vector<uint32_t> computeJumpLabels(Assembler const& assembler,
                                         ErrorContext& err) {
-    size_t prevSize = 0;
-    bool done = false;
-    std::unordered_map<size_t, size_t> labels;
-    std::vector<Entry> currentEntries = assembler.instructions;
-    std::vector<Entry> nextEntries;
-
-    auto maxSize = getMaximumProgramSize(assembler.instructions);
-    nextEntries.reserve(maxSize);
-    currentEntries.reserve(maxSize);
-
-    while (!done) {
-        done = true;
-        bool errored = false;
-
-        labels.clear();
-        size_t entryIdx = 0;
-        for (auto const& entry : currentEntries) {
-            if (!entry.label) {
-                ++entryIdx;
+    auto const& entries = assembler.instructions;
+    auto resolved = resolveLabels(assembler, err);
+    if (!resolved)
+        return {};
+    auto const& labelEntry = *resolved;
+
+    // Start with every jump short and widen the ones that don't reach.
+    // Widening only ever grows distances, so a jump never shrinks back and
+    // every pass after the first widens at least one jump. Schemas rarely
+    // need more than the first pass.
+    std::vector<uint8_t> wide(entries.size(), 0);
+    std::vector<uint64_t> entryPos(entries.size() + 1);
+    layoutEntries(entries, wide, entryPos);
+
+    size_t const maxPasses = entries.size() + 1;
+    bool changed = true;
+    for (size_t pass = 0; changed && pass < maxPasses; ++pass) {
+        changed = false;
+        for (size_t idx = 0; idx < entries.size(); ++idx) {
+            auto fixup = std::get_if<FixUpInstr>(&entries[idx].instr);
+            if (!fixup || wide[idx])
                 continue;
-            }
-            if (labels.contains(*entry.label)) {
-                err.fail({
-                    .code = ErrorCode::INTERNAL,
-                    .message = std::format(
-                        "Assembler: Multiple declarations of label: {}",
-                        *entry.label),
-                    .loc = {},
-                });
-                errored = true;
-            }
-            labels[*entry.label] = entryIdx;
-            ++entryIdx;
-        }
-        if (errored)
-            return {};
-
-        // Compute required jumps, widen small instructions
-        nextEntries.clear();
-        for (auto const& entry : currentEntries) {
-            std::visit(
-                Overloaded{
-                    [&](Instr instr) { nextEntries.emplace_back(entry); },
-                    [&](FixUpInstr instr) {
-                        auto iter = labels.find(instr.label);
-                        if (iter == labels.end()) {
-                            err.fail({
-                                .code = ErrorCode::INTERNAL,
-                                .message = std::format(
-                                    "Assembler: Use of undefined label: {}",
-                                    instr.label),
-                                .loc = {},
-                            });
-                            errored = true;
-                            return;
-                        }
-                        auto dest = iter->second;
-                        int64_t jumpDist = dest - (int64_t)nextEntries.size();
-
-                        if (fitsIn<int16_t>(jumpDist)) {
-                            nextEntries.emplace_back(entry);
-                        } else if (fitsIn<int32_t>(jumpDist)) {
-                            nextEntries.emplace_back(Entry{
-                                .instr =
-                                    Instr{
-                                        Op::EXT32,
-                                        (uint8_t)instr.ext,
-                                        0,
-                                    },
-                                .label = entry.label,
-                            });
-                            nextEntries.emplace_back(Entry{
-                                .instr =
-                                    FixUp32{
-                                        .label = instr.label,
-                                        .offset = 1,
-                                    },
-                                .label = {},
-                            });
-                            done = false;
-                        } else {
-                            err.fail({
-                                .code = ErrorCode::INTERNAL,
-                                .message = std::format(
-                                    "Assembler: failed to "
-                                    "fixup, offset from {} to {} too far: {}",
-                                    nextEntries.size(), dest, jumpDist),
-                                .loc = {},
-                            });
-                            errored = true;
-                        }
-                    },
-                    [&](FixUp32 instr) {
-                        auto iter = labels.find(instr.label);
-                        if (iter == labels.end()) {
-                            err.fail({
-                                .code = ErrorCode::INTERNAL,
-                                .message = std::format(
-                                    "Assembler: Use of undefined label: {}",
-                                    instr.label),
-                                .loc = {},
-                            });
-                            errored = true;
-                        }
-                        nextEntries.emplace_back(entry);
-                    },
-                },
-                entry.instr);
+            auto dest = entryPos[labelEntry[fixup->label]];
+            int64_t jumpDist = (int64_t)dest - (int64_t)entryPos[idx];
+            if (fitsIn<int16_t>(jumpDist))
+                continue;
+            wide[idx] = 1;
+            changed = true;
         }
-
-        if (errored)
-            return {};
-        std::swap(currentEntries, nextEntries);
+        if (changed)
+            layoutEntries(entries, wide, entryPos);
+    }
+    if (changed) {
+        err.fail({
+            .code = ErrorCode::INTERNAL,
+            .message = "Assembler: jump relaxation did not converge",
+            .loc = {},
+        });
+        return {};
     }
 
     // Everything has a stable location now
     // Patch in real locations
+    bool errored = false;
     std::vector<uint32_t> ops = {};
-    for (auto& entry : currentEntries) {
-        std::visit(Overloaded{
-                       [&](Instr instr) { ops.push_back(instr.pack()); },
-                       [&](FixUpInstr instr) {
-                           auto labelPos = labels[instr.label];
-                           int16_t offset = labelPos - ops.size();
-                           instr.instr.imm = std::bit_cast<uint16_t>(offset);
-                           ops.push_back(instr.instr.pack());
-                       },
-                       [&](FixUp32 instr) {
-                           auto labelPos = labels[instr.label];
-                           int32_t offset = labelPos - ops.size();
-                           ops.push_back(std::bit_cast<uint32_t>(offset) +
-                                         instr.offset);
-                       },
-                   },
-                   entry.instr);
+    ops.reserve(entryPos.back());
+    auto farJump = [&](uint64_t label, int64_t offset) {
+        int64_t jumpDist =
+            (int64_t)entryPos[labelEntry[label]] - (int64_t)ops.size() + offset;
+        if (!fitsIn<int32_t>(jumpDist)) {
+            err.fail({
+                .code = ErrorCode::INTERNAL,
+                .message = std::format("Assembler: failed to "
+                                       "fixup, offset from {} to {} too far: {}",
+                                       ops.size(), entryPos[labelEntry[label]],
+                                       jumpDist),
+                .loc = {},
+            });
+            errored = true;
+        }
+        ops.push_back(std::bit_cast<uint32_t>(static_cast<int32_t>(jumpDist)));
+    };
+    for (size_t idx = 0; idx < entries.size(); ++idx) {
+        std::visit(
+            Overloaded{
+                [&](Instr instr) { ops.push_back(instr.pack()); },
+                [&](FixUpInstr instr) {
+                    if (wide[idx]) {
+                        ops.push_back(
+                            Instr{Op::EXT32, (uint8_t)instr.ext, 0}.pack());
+                        farJump(instr.label, 1);
+                        return;
+                    }
+                    int16_t offset =
+                        entryPos[labelEntry[instr.label]] - ops.size();
+                    instr.instr.imm = std::bit_cast<uint16_t>(offset);
+                    ops.push_back(instr.instr.pack());
+                },
+                [&](FixUp32 instr) { farJump(instr.label, instr.offset); },
+            },
+            entries[idx].instr);
     }
+    if (errored)
+        return {};
     return ops;
 }
 
@@ -50,6 +50,22 @@ bool getParseProperties(ErrorContext& errs,
     return true;
 }
 
+bool getParseProperties(ErrorContext& errs,
+                        AstValueLiteral const& literal,
+                        double& out) {
+    if (literal.type != ValueLiteralType::INT &&
+        literal.type != ValueLiteralType::NUMBER) {
+        errs.fail({
+            .code = ErrorCode::INVALID_VALUE_FOR_TYPE_PROPERTY,
+            .message = std::format("Expected number literal"),
+            .loc = literal.loc,
+        });
+        return false;
+    }
+    out = std::stod(literal.contents);
+    return true;
+}
+
 bool IntParseProperties::parseProperties(ErrorContext& errs,
                                          AstTypeProperties const& props) {
     bool setZigZag = false;
@@ -103,6 +119,66 @@ bool IntParseProperties::parseProperties(ErrorContext& errs,
 
     return success;
 }
+
+bool FloatParseProperties::parseProperties(ErrorContext& errs,
+                                           AstTypeProperties const& props) {
+    bool success = true;
+    for (auto const& prop : props.props) {
+        std::optional<double>* target = nullptr;
+        if (prop.name == "min") {
+            target = &this->min;
+        } else if (prop.name == "max") {
+            target = &this->max;
+        } else if (prop.name == "precision") {
+            target = &this->precision;
+        } else {
+            failUnknownProperty(errs, prop);
+            success = false;
+            continue;
+        }
+
+        double value = 0;
+        if (!getParseProperties(errs, prop.value, value)) {
+            success = false;
+            continue;
+        }
+        *target = value;
+    }
+    if (!success)
+        return false;
+
+    if (!min && !max && !precision)
+        return true;
+    if (!quantized()) {
+        errs.fail({
+            .code = ErrorCode::INVALID_VALUE_FOR_TYPE_PROPERTY,
+            .message = std::format(
+                "Quantized floats require all of min, max and precision"),
+            .loc = props.loc,
+        });
+        return false;
+    }
+    if (!(*precision > 0) || !(*max > *min)) {
+        errs.fail({
+            .code = ErrorCode::INVALID_VALUE_FOR_TYPE_PROPERTY,
+            .message = std::format(
+                "Quantized floats require precision > 0 and max > min"),
+            .loc = props.loc,
+        });
+        return false;
+    }
+    if ((*max - *min) / *precision >= 0x1p63) {
+        errs.fail({
+            .code = ErrorCode::INVALID_VALUE_FOR_TYPE_PROPERTY,
+            .message = std::format(
+                "Quantized float range needs more than 63 bits at precision {}",
+                *precision),
+            .loc = props.loc,
+        });
+        return false;
+    }
+    return true;
+}
 }  // namespace detail
 
 template <size_t Idx>
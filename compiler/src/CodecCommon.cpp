@@ -1,11 +1,161 @@
 #include "ao/schema/CodecCommon.h"
 
 #include <algorithm>
+#include <bit>
+#include <cstdlib>
+#include <limits>
 
 #include "ao/schema/IR.h"
 #include "ao/utils/Overloaded.h"
 
 namespace ao::schema::codec {
+namespace {
+// How the disk codec packs arrays of `elem`, 0 for elements that keep their
+// own tags
+uint8_t diskPacking(ir::Type const& elem) {
+    if (std::holds_alternative<IdFor<ir::Enum>>(elem.payload))
+        return CodecType::DiskPackedVarint;
+    auto scalar = std::get_if<ir::Scalar>(&elem.payload);
+    if (!scalar)
+        return 0;
+    switch (scalar->kind) {
+        case ir::Scalar::F32:
+            return CodecType::DiskPackedFixed32;
+        case ir::Scalar::F64:
+            return CodecType::DiskPackedFixed64;
+        case ir::Scalar::CHAR:
+        case ir::Scalar::BYTE:
+            return CodecType::DiskPackedFixed8;
+        default:
+            return CodecType::DiskPackedVarint;
+    }
+}
+// A prefix int is a header byte and at most 8 value bytes
+constexpr uint64_t kMaxPrefixIntBits = 72;
+
+uint64_t addBits(uint64_t a, uint64_t b) {
+    return a > kUnboundedBits - b ? kUnboundedBits : a + b;
+}
+uint64_t mulBits(uint64_t count, uint64_t bits) {
+    if (count != 0 && bits > kUnboundedBits / count)
+        return kUnboundedBits;
+    return count * bits;
+}
+// Fields wider than 64 bits are rejected by the checked stream
+uint64_t fieldBits(uint64_t width) {
+    return width > 64 ? kUnboundedBits : width;
+}
+
+// Upper bound on the bits NetDecodeCodec reads for each type, mirrors the
+// decode program generated for it
+class NetMaxBits {
+   public:
+    explicit NetMaxBits(ir::IR const& ir)
+        : m_ir(ir),
+          m_bits(ir.types.size(), 0),
+          m_state(ir.types.size(), Unvisited) {}
+
+    std::vector<uint64_t> all() {
+        for (size_t i = 0; i < m_ir.types.size(); ++i)
+            of(i);
+        return std::move(m_bits);
+    }
+
+   private:
+    enum State : uint8_t { Unvisited, Visiting, Done };
+
+    uint64_t of(size_t typeId) {
+        if (m_state[typeId] == Done)
+            return m_bits[typeId];
+        // Recursive types can nest without limit
+        if (m_state[typeId] == Visiting)
+            return kUnboundedBits;
+        m_state[typeId] = Visiting;
+        m_bits[typeId] = compute(m_ir.types[typeId]);
+        m_state[typeId] = Done;
+        return m_bits[typeId];
+    }
+
+    uint64_t compute(ir::Type const& type) {
+        return std::visit(
+            Overloaded{
+                [&](ir::Scalar const& scalar) -> uint64_t {
+                    switch (scalar.kind) {
+                        case ir::Scalar::BOOL:
+                            return 1;
+                        case ir::Scalar::F32:
+                        case ir::Scalar::F64:
+                            if (scalar.quantization)
+                                return fieldBits(scalar.quantization->bits());
+                            return fieldBits(scalar.width);
+                        default:
+                            if (scalar.width == 0)
+                                return kMaxPrefixIntBits;
+                            return fieldBits(scalar.width);
+                    }
+                },
+                [&](ir::Array const& arr) -> uint64_t {
+                    if (!arr.maxSize)
+                        return kUnboundedBits;
+                    // The length is not checked against maxSize while
+                    // reading, anything its field holds may follow
+                    auto const lenBits =
+                        std::max(std::bit_width(*arr.maxSize), 1);
+                    auto const maxLen = std::min<uint64_t>(
+                        lenBits >= 64 ? kUnboundedBits
+                                      : (uint64_t{1} << lenBits) - 1,
+                        std::numeric_limits<uint32_t>::max());
+                    auto elem = of(arr.type.idx);
+                    if (arr.netEncoding == ir::Array::DELTA)
+                        elem = addBits(elem, kMaxPrefixIntBits);
+                    return addBits(fieldBits(lenBits), mulBits(maxLen, elem));
+                },
+                [&](ir::Optional const& opt) {
+                    return addBits(1, of(opt.type.idx));
+                },
+                [&](IdFor<ir::OneOf> const& oneof) {
+                    auto const& desc = m_ir.oneOfs[oneof.idx];
+                    uint64_t arm = 0;
+                    for (auto const& field : desc.arms) {
+                        auto const& armType = m_ir.fields[field.idx].type;
+                        arm = std::max(arm, of(armType.idx));
+                    }
+                    return addBits(std::bit_width(desc.arms.size()), arm);
+                },
+                [&](IdFor<ir::Message> const& message) {
+                    uint64_t ret = 0;
+                    for (auto const& field : m_ir.messages[message.idx].fields)
+                        ret = addBits(ret, of(m_ir.fields[field.idx].type.idx));
+                    return ret;
+                },
+                [&](IdFor<ir::Enum> const& e) {
+                    return fieldBits(enumWidth(m_ir, m_ir.enums[e.idx]));
+                },
+            },
+            type.payload);
+    }
+
+    ir::IR const& m_ir;
+    std::vector<uint64_t> m_bits;
+    std::vector<State> m_state;
+};
+}  // namespace
+
+size_t enumWidth(ir::IR const& ir, ir::Enum const& desc) {
+    if (desc.fields.empty())
+        return 1;
+    auto min = std::numeric_limits<int64_t>::max();
+    auto max = std::numeric_limits<int64_t>::min();
+    for (auto const f : desc.fields) {
+        auto n = ir.enumFields[f.idx].fieldNumber;
+        min = std::min(min, n);
+        max = std::max(max, n);
+    }
+    auto range =
+        static_cast<uint64_t>(std::max(std::abs(max), std::abs(min)));
+    return std::bit_width(range) + 1;
+}
+
 CodecTable generateCodecTable(ir::IR const& ir) {
     CodecTable ret;
     for (auto& type : ir.types) {
@@ -18,11 +168,17 @@ CodecTable generateCodecTable(ir::IR const& ir) {
                         .flags = 0,
                     };
                 },
-                [](ir::Array const& arr) {
+                [&](ir::Array const& arr) {
+                    uint8_t flags = 0;
+                    if (arr.netEncoding == ir::Array::DELTA)
+                        flags |= CodecType::NetDelta;
+                    if (arr.diskEncoding == ir::Array::DELTA)
+                        flags |= CodecType::DiskDelta;
+                    flags |= diskPacking(ir.types[arr.type.idx]);
                     return CodecType{
                         .bitWidth =
                             (uint8_t)std::bit_width(arr.maxSize.value_or(0)),
-                        .flags = 0,
+                        .flags = flags,
                     };
                 },
                 [](ir::Optional const& opt) { return CodecType{}; },
@@ -48,6 +204,20 @@ CodecTable generateCodecTable(ir::IR const& ir) {
         ret.types.emplace_back(entry);
     }
 
+    for (auto& type : ir.types) {
+        auto scalar = std::get_if<ir::Scalar>(&type.payload);
+        if (!scalar || !scalar->quantization)
+            continue;
+        auto const& quant = *scalar->quantization;
+        ret.quantizations.push_back(CodecQuantization{
+            .min = quant.min,
+            .max = quant.max,
+            .precision = quant.precision,
+            .maxSteps = quant.maxSteps(),
+            .bits = (uint32_t)quant.bits(),
+        });
+    }
+
     for (auto& field : ir.fields) {
         ret.fields.push_back(CodecField{
             .fieldNumber = field.fieldNumber,
@@ -68,6 +238,50 @@ CodecTable generateCodecTable(ir::IR const& ir) {
         }
     }
 
+    for (auto const& msg : ir.messages) {
+        uint64_t minNumber = std::numeric_limits<uint64_t>::max();
+        uint64_t maxNumber = 0;
+        std::vector<CodecFieldLookup> lookups;
+        for (uint32_t i = 0; i < msg.fields.size(); ++i) {
+            auto const number = ir.fields[msg.fields[i].idx].fieldNumber;
+            minNumber = std::min(minNumber, number);
+            maxNumber = std::max(maxNumber, number);
+            lookups.push_back({.fieldNumber = number, .index = i});
+        }
+        std::ranges::sort(lookups, {}, &CodecFieldLookup::fieldNumber);
+
+        auto const fieldCount = (uint32_t)msg.fields.size();
+        CodecMessage entry{
+            .minFieldNumber = lookups.empty() ? 0 : minNumber,
+            .lookupStart = (uint32_t)ret.fieldLookups.size(),
+            .lookupCount = fieldCount,
+            .fieldCount = fieldCount,
+            .lookup = CodecMessage::Sorted,
+        };
+        // Index directly by field number unless the numbers are so sparse
+        // the holes would dominate the table
+        auto const range = lookups.empty() ? 0 : maxNumber - minNumber + 1;
+        if (range <= std::max<uint64_t>(fieldCount * 4ull, 16)) {
+            entry.lookup = CodecMessage::Dense;
+            entry.lookupCount = (uint32_t)range;
+            for (uint64_t i = 0; i < range; ++i) {
+                ret.fieldLookups.push_back({
+                    .fieldNumber = minNumber + i,
+                    .index = fieldCount,
+                });
+            }
+            for (auto const& lookup : lookups) {
+                ret.fieldLookups[entry.lookupStart +
+                                 (lookup.fieldNumber - minNumber)] = lookup;
+            }
+        } else {
+            ret.fieldLookups.insert(ret.fieldLookups.end(), lookups.begin(),
+                                    lookups.end());
+        }
+        ret.messages.push_back(entry);
+    }
+
+    ret.netMaxBits = NetMaxBits{ir}.all();
     return ret;
 }
 }  // namespace ao::schema::codec
@@ -125,6 +125,9 @@ void CppDecodeAdapter::fieldBegin(uint32_t fieldId) {
 void CppDecodeAdapter::fieldEnd() {
     return stackInvoke(1, &DecodeTypeOps::fieldEnd);
 }
+void CppDecodeAdapter::fieldDefault(uint32_t fieldId) {
+    return stackInvoke(0, &DecodeTypeOps::fieldDefault, fieldId);
+}
 
 // Optional:
 // For optional decode, codec typically reads "present bit" and VM branches{}
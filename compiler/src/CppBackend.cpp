@@ -1,6 +1,7 @@
 #include "ao/schema/CppBackend.h"
 
 #include "ao/schema/CppAdapter.h"
+#include "ao/schema/VMImage.h"
 
 #include <fstream>
 #include <sstream>
@@ -11,6 +12,7 @@
 #include "ao/pack/IOByteStream.h"
 
 #include "CppBackendHelpers.h"
+#include "CppSchemaTables.h"
 #include "CppTypeAccessor.h"
 
 namespace ao::schema::cpp {
@@ -361,7 +363,9 @@ static std::optional<std::string> generateTypeDef(CppCodeGenContext& ctx,
         type.payload);
 }
 
-void generateHeaders(CppCodeGenContext& ctx, std::ostream& out) {
+void generateHeaders(CppCodeGenContext& ctx,
+                     std::ostream& out,
+                     std::string_view projectName) {
     out << R"(
 #pragma once
 #include <vector>
@@ -369,6 +373,7 @@ void generateHeaders(CppCodeGenContext& ctx, std::ostream& out) {
 #include <cstdint>
 
 #include <ao/schema/CppAdapter.h>
+#include <ao/schema/GeneratedSchema.h>
 #include <ao/schema/IR.h>
 
 )";
@@ -392,6 +397,8 @@ void generateHeaders(CppCodeGenContext& ctx, std::ostream& out) {
         out << type.decl << "\n";
     }
     out << "\n}\n";
+
+    generateSchemaTablesDecl(out, projectName);
 }
 
 void generateCpp(CppCodeGenContext& ctx,
@@ -406,6 +413,7 @@ void generateCpp(CppCodeGenContext& ctx,
 
 #include <ao/schema/CppAdapter.h>
 #include <ao/schema/IR.h>
+#include <ao/schema/JSONBackend.h>
 
 )",
                        headerPath);
@@ -470,16 +478,20 @@ bool generateCppCode(ir::IR const& ir, ErrorContext& errs, OutputFiles& files) {
     auto cppPath = makePath(".cpp");
     auto irPath = makePath(".aoir");
     auto irHeaderPath = makePath(".aoir.h");
+    auto vmImagePath = makePath(".aovm");
 
     auto headerStream = files.loader(headerPath, std::ios_base::out, errs);
     auto cppStream = files.loader(cppPath, std::ios_base::out, errs);
     auto irStream =
         files.loader(irPath, std::ios_base::out | std::ios_base::binary, errs);
     auto irHeaderStream = files.loader(irHeaderPath, std::ios_base::out, errs);
+    auto vmImageStream = files.loader(
+        vmImagePath, std::ios_base::out | std::ios_base::binary, errs);
 
     if (!errs.ok())
         return false;
-    if (!headerStream || !cppStream || !irStream || !irHeaderStream) {
+    if (!headerStream || !cppStream || !irStream || !irHeaderStream ||
+        !vmImageStream) {
         errs.fail({
             .code = schema::ErrorCode::INTERNAL,
             .message = "File loader returned null stream",
@@ -488,8 +500,15 @@ bool generateCppCode(ir::IR const& ir, ErrorContext& errs, OutputFiles& files) {
         return false;
     }
 
-    generateHeaders(ctx, *headerStream);
+    auto format = vm::generateProgram(ir, errs);
+    if (!errs.ok())
+        return false;
+    auto codecTable = codec::generateCodecTable(ir);
+
+    generateHeaders(ctx, *headerStream, files.projectName);
     generateCpp(ctx, *cppStream, (files.projectName + ".h"));
+    generateSchemaTables(*cppStream, files.projectName, format, codecTable,
+                         json::generateJsonTable(ir));
 
     ao::pack::byte::OStreamWriteStream irWs(*irStream);
     ir::serializeIRFile(irWs, ir);
@@ -498,16 +517,31 @@ bool generateCppCode(ir::IR const& ir, ErrorContext& errs, OutputFiles& files) {
     bytes.resize(irWs.byteSize());
     ao::pack::byte::WriteStream ws{std::span{bytes.data(), bytes.size()}};
     ir::serializeIRFile(ws, ir);
-    (*irHeaderStream) << "{";
+    // Initializer for an unsigned char array, #embed the .aoir where the
+    // compiler supports it and fall back to a byte list otherwise
+    auto irFile = files.projectName + ".aoir";
+    (*irHeaderStream) << replaceMany(R"(#if defined(__has_embed)
+#if __has_embed("@IR_FILE") == __STDC_EMBED_FOUND__
+#define AOSL_EMBED_IR
+#endif
+#endif
+{
+#ifdef AOSL_EMBED_IR
+#undef AOSL_EMBED_IR
+#embed "@IR_FILE"
+#else)",
+                                     {{"@IR_FILE", irFile}});
     size_t i = 0;
     for (auto const& b : bytes) {
-        if (i % 256 == 0)
+        if (i % 32 == 0)
             (*irHeaderStream) << "\n";
-        (*irHeaderStream) << std::format("'\\x{:02x}', ",
-                                         static_cast<uint8_t>(b));
+        (*irHeaderStream) << std::format("0x{:02x},", static_cast<uint8_t>(b));
         ++i;
     }
-    (*irHeaderStream) << "}";
+    (*irHeaderStream) << "\n#endif\n}";
+
+    ao::pack::byte::OStreamWriteStream vmImageWs(*vmImageStream);
+    vm::writeVMImage(vmImageWs, format, codecTable);
 
     return errs.ok();
 }
@@ -116,6 +116,41 @@ default:
 )";
 }
 
+static void decodeFieldDefault(CppCodeGenContext& ctx,
+                               std::stringstream& ss,
+                               size_t typeId,
+                               IdFor<ir::Message> v) {
+    ss << funcSig("void", std::format("decodeFieldDefault_{}", typeId),
+                  std::string{decodeRuntime} + "& runtime",
+                  std::string{mutPtr} + " ptr", "uint32_t fieldId")
+       << " {\n";
+    ss << std::format("auto& data = ptr.as<{}>();\n",
+                      ctx.generatedTypeNames[typeId].qualifiedName());
+    ss << "switch (fieldId) {\n";
+
+    auto const& msgDesc = ctx.ir.messages[v.idx];
+    for (auto fieldId : msgDesc.fields) {
+        auto const& fieldDesc = ctx.ir.fields[fieldId.idx];
+        ss << replaceMany(
+            R"(
+case @FIELD_ID:
+    data.@FIELD_NAME = decltype(data.@FIELD_NAME){};
+    break;
+)",
+            {
+                {"@FIELD_ID", std::to_string(fieldId.idx)},
+                {"@FIELD_NAME", ctx.ir.strings[fieldDesc.name.idx]},
+            });
+    }
+    ss << R"(
+default: 
+	ao::schema::cpp::cppRuntimeFail(runtime, ao::pack::Error::BadData);
+	return;
+}
+}
+)";
+}
+
 void generateTypeAccessorMessage(CppCodeGenContext& ctx,
                                  size_t typeId,
                                  IdFor<ir::Message> v) {
@@ -151,6 +186,7 @@ void generateTypeAccessorMessage(CppCodeGenContext& ctx,
                   std::string{decodeRuntime} + "& runtime",
                   std::string{mutPtr} + " ptr")
        << "{ runtime.stack.pop_back(); }\n";
+    decodeFieldDefault(ctx, ss, typeId, v);
 
     ss << replaceMany(R"(
 ao::schema::cpp::EncodeTypeOps const @QNAME::encode = ao::schema::cpp::EncodeTypeOps{
@@ -164,6 +200,7 @@ ao::schema::cpp::DecodeTypeOps const @QNAME::decode = ao::schema::cpp::DecodeTyp
  .msgEnd = &decodeMsgEnd_@TYPE_ID,
  .fieldBegin = &decodeFieldBegin_@TYPE_ID,
  .fieldEnd = &decodeFieldEnd_@TYPE_ID,
+ .fieldDefault = &decodeFieldDefault_@TYPE_ID,
 };
 )",
                       {
@@ -0,0 +1,250 @@
+#include "CppSchemaTables.h"
+
+#include <algorithm>
+#include <cctype>
+#include <format>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "ao/schema/GeneratedSchema.h"
+
+#include "CppBackendHelpers.h"
+
+using namespace ao;
+using namespace ao::schema;
+using ao::schema::cpp::GeneratedMessage;
+
+static std::string quoteString(std::string_view str) {
+    std::string ret = "\"";
+    for (unsigned char c : str) {
+        if (c == '"' || c == '\\') {
+            ret += '\\';
+            ret += (char)c;
+        } else if (std::isprint(c)) {
+            ret += (char)c;
+        } else {
+            ret += std::format("\\{:03o}", c);
+        }
+    }
+    ret += '"';
+    return ret;
+}
+
+static std::string formatDouble(double v) {
+    auto ret = std::format("{}", v);
+    if (ret.find_first_of(".e") == std::string::npos)
+        ret += ".0";
+    return ret;
+}
+
+// Writes a constexpr array and returns the expression to reference it by,
+// empty tables become an empty span since C++ has no zero length arrays
+template <class T, class Fn>
+static std::string generateArray(std::ostream& out,
+                                 std::string_view type,
+                                 std::string_view name,
+                                 std::span<T const> values,
+                                 size_t perLine,
+                                 Fn&& formatValue) {
+    if (values.empty())
+        return "{}";
+    out << std::format("constexpr {} {}[] = {{", type, name);
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (i % perLine == 0)
+            out << "\n\t";
+        out << formatValue(values[i]) << ", ";
+    }
+    out << "\n};\n";
+    return std::string{name};
+}
+
+static std::string generateWords(std::ostream& out,
+                                 std::string_view name,
+                                 std::vector<uint32_t> const& words) {
+    return generateArray(out, "uint32_t", name, std::span{words}, 12,
+                         [](uint32_t w) { return std::format("0x{:x}", w); });
+}
+
+static std::string generateProgramArrays(std::ostream& out,
+                                         std::string_view prefix,
+                                         vm::Program const& prog) {
+    auto code = generateWords(out, std::format("{}Code", prefix),
+                              prog.codeWords);
+    auto typeEntry = generateWords(out, std::format("{}TypeEntry", prefix),
+                                   prog.typeEntryPc);
+    auto msgEntry = generateWords(out, std::format("{}MsgEntry", prefix),
+                                  prog.msgEntryPc);
+    return std::format("{{{}, {}, {}}}", code, typeEntry, msgEntry);
+}
+
+static std::string generateCodecArrays(std::ostream& out,
+                                       codec::CodecTable const& codec) {
+    auto types = generateArray(
+        out, "ao::schema::codec::CodecType", "codecTypes",
+        std::span{codec.types}, 4, [](codec::CodecType const& t) {
+            return std::format("{{.bitWidth = {}, .flags = {}}}", t.bitWidth,
+                               t.flags);
+        });
+    auto oneofs = generateArray(
+        out, "ao::schema::codec::CodecOneof", "codecOneofs",
+        std::span{codec.oneofs}, 2, [](codec::CodecOneof const& o) {
+            return std::format(
+                "{{.fieldStart = {}, .fieldCount = {}, .indexWidth = {}}}",
+                o.fieldStart, o.fieldCount, o.indexWidth);
+        });
+    auto oneofFieldNumbers = generateWords(out, "codecOneofFieldNumbers",
+                                           codec.oneofFieldNumbers);
+    auto quantizations = generateArray(
+        out, "ao::schema::codec::CodecQuantization", "codecQuantizations",
+        std::span{codec.quantizations}, 1,
+        [](codec::CodecQuantization const& q) {
+            return std::format(
+                "{{.min = {}, .max = {}, .precision = {}, .maxSteps = {}ull, "
+                ".bits = {}}}",
+                formatDouble(q.min), formatDouble(q.max),
+                formatDouble(q.precision), q.maxSteps, q.bits);
+        });
+    auto fields = generateArray(
+        out, "ao::schema::codec::CodecField", "codecFields",
+        std::span{codec.fields}, 2, [](codec::CodecField const& f) {
+            return std::format("{{.fieldNumber = {}ull, .typeId = {}}}",
+                               f.fieldNumber, f.typeId);
+        });
+    auto messages = generateArray(
+        out, "ao::schema::codec::CodecMessage", "codecMessages",
+        std::span{codec.messages}, 1, [](codec::CodecMessage const& m) {
+            return std::format(
+                "{{.minFieldNumber = {}ull, .lookupStart = {}, "
+                ".lookupCount = {}, .fieldCount = {}, .lookup = {}}}",
+                m.minFieldNumber, m.lookupStart, m.lookupCount, m.fieldCount,
+                m.lookup);
+        });
+    auto fieldLookups = generateArray(
+        out, "ao::schema::codec::CodecFieldLookup", "codecFieldLookups",
+        std::span{codec.fieldLookups}, 2,
+        [](codec::CodecFieldLookup const& l) {
+            return std::format("{{.fieldNumber = {}ull, .index = {}}}",
+                               l.fieldNumber, l.index);
+        });
+    auto netMaxBits = generateArray(
+        out, "uint64_t", "codecNetMaxBits", std::span{codec.netMaxBits}, 6,
+        [](uint64_t bits) { return std::format("{}ull", bits); });
+    return std::format("{{{}, {}, {}, {}, {}, {}, {}, {}}}", types, oneofs,
+                       oneofFieldNumbers, quantizations, fields, messages,
+                       fieldLookups, netMaxBits);
+}
+
+static void generateJsonTableDef(std::ostream& out,
+                                 json::JsonTable const& json) {
+    out << "ao::schema::json::JsonTable const jsonTable{\n\t.types = {";
+    for (auto const& type : json.types)
+        out << (type.isString ? "{true}, " : "{false}, ");
+    out << "},\n\t.fields = {";
+    for (auto const& field : json.fields) {
+        out << std::format(
+            "\n\t\t{{.nameIdx = {}, .fieldNumber = {}ull, .flags = {}}},",
+            field.nameIdx, field.fieldNumber, field.flags);
+    }
+    out << "\n\t},\n\t.strings = {";
+    for (auto const& str : json.strings)
+        out << "\n\t\t" << quoteString(str) << ",";
+    out << "\n\t},\n\t.oneofs = {";
+    for (auto const& oneof : json.oneofs) {
+        out << "\n\t\t{.fieldNumbers = {";
+        for (auto fieldNumber : oneof.fieldNumbers)
+            out << fieldNumber << ", ";
+        out << "}},";
+    }
+    out << "\n\t},\n};\n";
+}
+
+static std::string generateMessages(std::ostream& out,
+                                    std::string_view name,
+                                    std::span<GeneratedMessage const> msgs) {
+    return generateArray(
+        out, "ao::schema::cpp::GeneratedMessage", name, msgs, 1,
+        [](GeneratedMessage const& msg) {
+            return std::format(
+                "{{.messageNumber = {}ull, .name = {}, .id = {}ull}}",
+                msg.messageNumber, quoteString(msg.name), msg.id);
+        });
+}
+
+std::string getSchemaNamespace(std::string_view projectName) {
+    std::string ret;
+    for (unsigned char c : projectName)
+        ret += std::isalnum(c) ? (char)c : '_';
+    if (ret.empty() || std::isdigit((unsigned char)ret.front()))
+        ret.insert(ret.begin(), '_');
+    return ret;
+}
+
+void generateSchemaTablesDecl(std::ostream& out,
+                              std::string_view projectName) {
+    out << replaceMany(R"(
+namespace aosl_schema::@NS {
+// Linked programs, codec and json tables of this schema
+extern ao::schema::cpp::GeneratedSchema const schema;
+}
+)",
+                       {{"@NS", getSchemaNamespace(projectName)}});
+}
+
+void generateSchemaTables(std::ostream& out,
+                          std::string_view projectName,
+                          vm::Format const& format,
+                          codec::CodecTable const& codec,
+                          json::JsonTable const& json) {
+    out << std::format("namespace aosl_schema::{} {{\nnamespace {{\n",
+                       getSchemaNamespace(projectName));
+    auto encode = generateProgramArrays(out, "encode", format.encode);
+    auto decode = generateProgramArrays(out, "decode", format.decode);
+    auto codecTable = generateCodecArrays(out, codec);
+    generateJsonTableDef(out, json);
+
+    std::unordered_map<uint64_t, uint64_t> idToNumber;
+    for (auto const& [number, id] : format.msgs.messageNumberToId)
+        idToNumber[id] = number;
+    std::vector<GeneratedMessage> byName;
+    for (auto const& [name, id] : format.msgs.messageNameToId) {
+        auto number = idToNumber.find(id);
+        byName.push_back({
+            .messageNumber = number != idToNumber.end() ? number->second : 0,
+            .name = name,
+            .id = id,
+        });
+    }
+    std::vector<GeneratedMessage> byNumber;
+    for (auto const& msg : byName) {
+        if (idToNumber.contains(msg.id))
+            byNumber.push_back(msg);
+    }
+    std::ranges::sort(byName, {}, &GeneratedMessage::name);
+    std::ranges::sort(byNumber, {}, &GeneratedMessage::messageNumber);
+    auto messagesByNumber =
+        generateMessages(out, "messagesByNumber", std::span{byNumber});
+    auto messagesByName =
+        generateMessages(out, "messagesByName", std::span{byName});
+
+    out << replaceMany(R"(
+}
+
+constinit ao::schema::cpp::GeneratedSchema const schema{
+	.encode = @ENCODE,
+	.decode = @DECODE,
+	.codec = @CODEC,
+	.json = &jsonTable,
+	.messagesByNumber = @BY_NUMBER,
+	.messagesByName = @BY_NAME,
+};
+}
+)",
+                       {
+                           {"@ENCODE", encode},
+                           {"@DECODE", decode},
+                           {"@CODEC", codecTable},
+                           {"@BY_NUMBER", messagesByNumber},
+                           {"@BY_NAME", messagesByName},
+                       });
+}
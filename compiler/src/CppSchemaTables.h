@@ -0,0 +1,20 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <string_view>
+
+#include "ao/schema/CodecCommon.h"
+#include "ao/schema/JSONBackend.h"
+#include "ao/schema/VM.h"
+
+// Namespace holding the schema tables of a generated project
+std::string getSchemaNamespace(std::string_view projectName);
+
+void generateSchemaTablesDecl(std::ostream& out,
+                              std::string_view projectName);
+void generateSchemaTables(std::ostream& out,
+                          std::string_view projectName,
+                          ao::schema::vm::Format const& format,
+                          ao::schema::codec::CodecTable const& codec,
+                          ao::schema::json::JsonTable const& json);
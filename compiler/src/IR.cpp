@@ -28,6 +28,68 @@ struct IRContext {
 IdFor<DirectiveSet> generateIR(IRContext& ctx,
                                AstDirectiveBlock const& directives);
 
+std::optional<FloatQuantization> getQuantization(
+    detail::FloatParseProperties const& props) {
+    if (!props.quantized())
+        return {};
+    return FloatQuantization{
+        .min = *props.min,
+        .max = *props.max,
+        .precision = *props.precision,
+    };
+}
+
+Array::Encoding getArrayEncoding(IRContext& ctx,
+                                 AstField const& field,
+                                 std::string const& profile) {
+    auto iter = field.directives.effectiveDirectives.find(profile);
+    if (iter == field.directives.effectiveDirectives.end())
+        return Array::PLAIN;
+
+    auto ret = Array::PLAIN;
+    for (auto const& [name, value] : iter->second) {
+        if (name != "encoding")
+            continue;
+        if (value.type == ValueLiteralType::STRING &&
+            value.contents == "plain") {
+            ret = Array::PLAIN;
+        } else if (value.type == ValueLiteralType::STRING &&
+                   value.contents == "delta") {
+            ret = Array::DELTA;
+        } else {
+            ctx.errors.fail({
+                .code = ErrorCode::INVALID_VALUE_FOR_TYPE_PROPERTY,
+                .message = std::format("unknown {} encoding for field {}: {}",
+                                       profile, field.name, value.contents),
+                .loc = field.loc,
+            });
+        }
+    }
+    return ret;
+}
+
+// Encodings only change the layout of integer arrays, other field types
+// ignore them so a module default can still set one
+IdFor<Type> applyArrayEncoding(IRContext& ctx,
+                               AstField const& field,
+                               IdFor<Type> typeId) {
+    auto netEncoding = getArrayEncoding(ctx, field, "net");
+    auto diskEncoding = getArrayEncoding(ctx, field, "disk");
+
+    auto const& types = ctx.types.values();
+    auto const* arr = std::get_if<Array>(&types[typeId.idx].payload);
+    if (!arr)
+        return typeId;
+    auto const* elem = std::get_if<Scalar>(&types[arr->type.idx].payload);
+    if (!elem || (elem->kind != Scalar::INT && elem->kind != Scalar::UINT))
+        return typeId;
+
+    auto encoded = *arr;
+    encoded.netEncoding = netEncoding;
+    encoded.diskEncoding = diskEncoding;
+    return ctx.types.getId(Type{encoded});
+}
+
 IdFor<Type> generateIR(IRContext& ctx, AstType const& type) {
     Type currentType = Type{Scalar{Scalar::UINT}};
     if (!type.normalizedProperties) {
@@ -76,6 +138,7 @@ IdFor<Type> generateIR(IRContext& ctx, AstType const& type) {
                     currentType = Type{Scalar{
                         .kind = Scalar::F32,
                         .width = 32,
+                        .quantization = getQuantization(props),
                     }};
                 });
             break;
@@ -86,6 +149,7 @@ IdFor<Type> generateIR(IRContext& ctx, AstType const& type) {
                     currentType = Type{Scalar{
                         .kind = Scalar::F64,
                         .width = 64,
+                        .quantization = getQuantization(props),
                     }};
                 });
             break;
@@ -152,8 +216,8 @@ IdFor<Type> generateIR(IRContext& ctx, AstType const& type) {
                                     fieldForInsert.name =
                                         ctx.strings.getId(f.name);
                                     fieldForInsert.fieldNumber = f.fieldNumber;
-                                    fieldForInsert.type =
-                                        generateIR(ctx, f.typeName);
+                                    fieldForInsert.type = applyArrayEncoding(
+                                        ctx, f, generateIR(ctx, f.typeName));
                                     fieldForInsert.directives =
                                         generateIR(ctx, f.directives);
 
@@ -293,7 +357,8 @@ std::optional<IdFor<Field>> generateIR(IRContext& ctx,
                 auto field = Field{
                     .name = ctx.strings.getId(v.name),
                     .fieldNumber = v.fieldNumber,
-                    .type = generateIR(ctx, v.typeName),
+                    .type = applyArrayEncoding(ctx, v,
+                                               generateIR(ctx, v.typeName)),
                     .directives = generateIR(ctx, v.directives),
                 };
                 return ctx.fields.getId(field);
@@ -244,6 +244,16 @@ void JsonDecodeAdapter::fieldBegin(uint32_t fieldId) {
 void JsonDecodeAdapter::fieldEnd() {
     popStack();
 }
+void JsonDecodeAdapter::fieldDefault(uint32_t fieldId) {
+    if (!ok())
+        return;
+    auto top = currentMsg();
+    if (!top)
+        return;
+    if (!top->is_object())
+        return fail(pack::Error::BadData);
+    (*top)[fieldKey(fieldId)] = nlohmann::json(nullptr);
+}
 
 void JsonDecodeAdapter::optSetPresent(bool present) {
     if (!ok())
@@ -349,7 +359,10 @@ void JsonDecodeAdapter::oneofIndex(uint32_t oneofId, uint32_t armId) {
     auto top = currentMsg();
     if (!top)
         return;
-    (*top)["case"] = m_table.oneofs[oneofId].fieldNumbers[armId];
+    auto const& fieldNumbers = m_table.oneofs[oneofId].fieldNumbers;
+    if (armId >= fieldNumbers.size())
+        return fail(ao::pack::Error::BadData);
+    (*top)["case"] = fieldNumbers[armId];
 }
 
 void JsonDecodeAdapter::oneofEnterArm(uint32_t oneofId, uint32_t armId) {
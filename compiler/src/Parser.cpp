@@ -120,32 +120,43 @@ struct NumberLiteral : lexy::token_production {
             dsl::opt((LEXY_LIT("e") / LEXY_LIT("E")) >> dsl::p<IntegerPart>);
         static constexpr auto value = lexy::forward<std::optional<int64_t>>;
     };
+    // The sign and fraction are captured as text so that -0.5 keeps its sign
+    // and 0.01 keeps its leading zeros
+    struct SignPart {
+        static constexpr auto rule =
+            dsl::capture(dsl::token(dsl::opt(LEXY_LIT("+") / LEXY_LIT("-"))));
+        static constexpr auto value = lexy::as_string<std::string>;
+    };
     struct FracPart {
         static constexpr auto rule =
-            dsl::opt(dsl::period >> dsl::integer<uint64_t>);
-        static constexpr auto value = lexy::forward<std::optional<uint64_t>>;
+            dsl::opt(dsl::period >> dsl::capture(dsl::digits<>));
+        static constexpr auto value = lexy::as_string<std::string>;
     };
 
     static constexpr auto rule =
         dsl::peek(LEXY_LIT("+") / LEXY_LIT("-") / dsl::ascii::digit) >>
-        dsl::position + dsl::p<IntegerPart> + dsl::p<FracPart> +
-            dsl::p<ExponentPart>;
+        dsl::position + dsl::p<SignPart> + dsl::integer<int64_t> +
+            dsl::p<FracPart> + dsl::p<ExponentPart>;
     static constexpr auto value = lexy::callback_with_state<AstValueLiteral>(
         [](ParsingContext const& ctx,
            auto input,
-           int64_t value,
-           std::optional<uint64_t> frac,
+           std::string sign,
+           int64_t magnitude,
+           std::string frac,
            std::optional<int64_t> exp) {
-            if (!frac && !exp) {
+            bool const negative = sign == "-";
+            if (frac.empty() && !exp) {
                 return AstValueLiteral{
                     .type = ValueLiteralType::INT,
-                    .contents = std::to_string(value),
+                    .contents = std::to_string(negative ? -magnitude : magnitude),
                     .loc = ctx.getSourceLocation(input),
                 };
             } else {
                 return AstValueLiteral{
                     .type = ValueLiteralType::NUMBER,
-                    .contents = std::format("{}.{}e{}", value, frac.value_or(0),
+                    .contents = std::format("{}{}.{}e{}", negative ? "-" : "",
+                                            magnitude,
+                                            frac.empty() ? "0" : frac,
                                             exp.value_or(0)),
                     .loc = ctx.getSourceLocation(input),
                 };
@@ -3,6 +3,8 @@
 #include "ao/schema/Assembler.h"
 #include "ao/utils/Overloaded.h"
 
+#include <optional>
+#include <utility>
 #include <variant>
 
 namespace ao::schema::vm {
@@ -12,6 +14,9 @@ struct VMGenerateContext {
     Program prog = {};  // For other assets
 
     std::vector<uint64_t> messageToTypeId;
+    // Quantized floats seen so far, in type order to match
+    // CodecTable::quantizations
+    uint16_t quantizationCount = 0;
 
     // TODO share string tables and stuff
     std::vector<Assembler> typePrograms;
@@ -30,6 +35,15 @@ void generateTypeProgram(VMGenerateContext& ctx,
     std::visit(
         Overloaded{
             [&](ir::Scalar const& scalar) {
+                // Floats pass the quantization id (1 based index into
+                // CodecTable::quantizations, 0 = full precision) to the codec
+                auto codecImm = static_cast<uint16_t>(scalar.width);
+                if (scalar.kind == ir::Scalar::F32 ||
+                    scalar.kind == ir::Scalar::F64) {
+                    codecImm = 0;
+                    if (scalar.quantization)
+                        codecImm = ++ctx.quantizationCount;
+                }
                 if (encodeMode) {
                     assembler.emit(
                         {Op::O_READ_SCALAR, static_cast<uint8_t>(scalar.kind),
@@ -37,12 +51,12 @@ void generateTypeProgram(VMGenerateContext& ctx,
                         {});
                     assembler.emit(
                         {Op::C_WRITE_SCALAR, static_cast<uint8_t>(scalar.kind),
-                         static_cast<uint16_t>(scalar.width)},
+                         codecImm},
                         {});
                 } else {
                     assembler.emit(
                         {Op::C_READ_SCALAR, static_cast<uint8_t>(scalar.kind),
-                         static_cast<uint16_t>(scalar.width)},
+                         codecImm},
                         {});
                     assembler.emit(
                         {Op::O_WRITE_SCALAR, static_cast<uint8_t>(scalar.kind),
@@ -202,10 +216,50 @@ void generateTypeProgram(VMGenerateContext& ctx,
                 auto const& desc = irCode.messages[msgId.idx];
 
                 assembler.emit({Op::MSG_BEGIN, 0, 0}, {});
+                auto msgEnd = assembler.useLabel();
+                // First instruction of the schema order field code
+                std::optional<uint64_t> inOrderLabel;
+                if (!encodeMode) {
+                    // Codecs with a field lookup table read fields in any
+                    // order, each one jumps straight to its decode block
+                    auto inOrder = msgEnd;
+                    if (!desc.fields.empty()) {
+                        inOrderLabel = assembler.useLabel();
+                        inOrder = *inOrderLabel;
+                    }
+                    assembler.emit({Op::C_FIELD_LOOKUP, 0, 0}, {});
+                    assembler.jz(inOrder, {});
+                    for (auto fieldId : desc.fields) {
+                        assembler.emit(
+                            {Op::O_FIELD_DEFAULT, 0, (uint16_t)fieldId.idx},
+                            {});
+                    }
+
+                    auto loop = assembler.useLabel();
+                    auto skip = assembler.useLabel();
+                    std::vector<uint64_t> labels;
+                    for (size_t idx = 0; idx < desc.fields.size(); ++idx)
+                        labels.push_back(assembler.useLabel());
+                    assembler.emit({Op::C_NEXT_FIELD, 0, (uint16_t)msgId.idx},
+                                   {loop});
+                    assembler.jz(msgEnd, {});
+                    assembler.emitDispatch(labels, skip, {});
+                    for (size_t idx = 0; idx < desc.fields.size(); ++idx) {
+                        auto fieldId = desc.fields[idx];
+                        assembler.emitFieldBegin(fieldId, {labels[idx]});
+                        assembler.emitTypeCall(irCode.fields[fieldId.idx].type,
+                                               {});
+                        assembler.emit({Op::FIELD_END, 0, 0}, {});
+                        assembler.jmp(loop, {});
+                    }
+                    assembler.emit({Op::C_SKIP_FIELD, 0, 0}, {skip});
+                    assembler.jmp(loop, {});
+                }
                 for (auto fieldId : desc.fields) {
                     auto const& fieldDesc = irCode.fields[fieldId.idx];
                     auto endLabel = assembler.useLabel();
-                    assembler.emitFieldBegin(fieldId, {});
+                    assembler.emitFieldBegin(
+                        fieldId, std::exchange(inOrderLabel, std::nullopt));
                     if (encodeMode) {
                         assembler.emit(
                             {Op::C_WRITE_FIELD_ID, 0, (uint16_t)fieldId.idx},
@@ -228,27 +282,13 @@ void generateTypeProgram(VMGenerateContext& ctx,
 
                     assembler.emit({Op::FIELD_END, 0, 0}, endLabel);
                 }
-                assembler.emit({Op::MSG_END, 0, 0}, {});
+                assembler.emit({Op::MSG_END, 0, 0}, {msgEnd});
             },
             [&](IdFor<ir::Enum> enumId) {
                 auto const kind = ScalarKind::INT;
                 auto const& desc = irCode.enums[enumId.idx];
 
-                size_t width = 0;
-                if (desc.fields.size() == 0) {
-                    width = 1;
-                } else {
-                    auto min = std::numeric_limits<int64_t>::max();
-                    auto max = std::numeric_limits<int64_t>::min();
-                    for (auto const f : desc.fields) {
-                        auto n = irCode.enumFields[f.idx].fieldNumber;
-                        min = std::min(min, n);
-                        max = std::max(max, n);
-                    }
-                    auto range =
-                        static_cast<uint64_t>(std::max(std::abs(max), std::abs(min)));
-                    width = std::bit_width(range) + 1;
-                }
+                auto const width = codec::enumWidth(irCode, desc);
 
                 if (encodeMode) {
                     assembler.emit(
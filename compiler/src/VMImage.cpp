@@ -0,0 +1,245 @@
+#include "ao/schema/VMImage.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "ao/pack/MmapStream.h"
+#include "ao/utils/Blake3Hasher.h"
+
+namespace ao::schema::vm {
+namespace {
+constexpr size_t kSectionAlign = 8;
+constexpr size_t kHashOffset = offsetof(VMImageHeader, hash);
+constexpr size_t kHashSize = sizeof(VMImageHeader::hash);
+
+utils::hash::Blake3Hasher::Hash hashImage(std::span<std::byte const> image) {
+    utils::hash::Blake3Hasher hasher;
+    hasher.update(image.subspan(0, kHashOffset));
+    hasher.update(image.subspan(kHashOffset + kHashSize));
+    return hasher.digest();
+}
+
+class ImageBuilder {
+   public:
+    ImageBuilder() { m_bytes.resize(sizeof(VMImageHeader)); }
+
+    template <class T>
+    void append(VMImageSectionKind kind, std::vector<T> const& values) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        static_assert(alignof(T) <= kSectionAlign);
+        auto offset =
+            (m_bytes.size() + kSectionAlign - 1) & ~(kSectionAlign - 1);
+        auto size = values.size() * sizeof(T);
+        m_bytes.resize(offset + size);
+        if (!values.empty())
+            std::memcpy(m_bytes.data() + offset, values.data(), size);
+        m_header.sections[(size_t)kind] = {
+            .offset = offset,
+            .count = values.size(),
+        };
+    }
+
+    std::vector<std::byte> finish() {
+        m_header.imageSize = m_bytes.size();
+        std::memcpy(m_bytes.data(), &m_header, sizeof(m_header));
+        auto hash = hashImage(m_bytes);
+        std::memcpy(m_bytes.data() + kHashOffset, hash.data(), hash.size());
+        return std::move(m_bytes);
+    }
+
+   private:
+    VMImageHeader m_header = {};
+    std::vector<std::byte> m_bytes;
+};
+
+void appendProgram(ImageBuilder& builder,
+                   Program const& prog,
+                   VMImageSectionKind code,
+                   VMImageSectionKind typeEntry,
+                   VMImageSectionKind msgEntry) {
+    builder.append(code, prog.codeWords);
+    builder.append(typeEntry, prog.typeEntryPc);
+    builder.append(msgEntry, prog.msgEntryPc);
+}
+}  // namespace
+
+std::vector<std::byte> buildVMImage(Format const& format,
+                                    codec::CodecTable const& codec) {
+    ImageBuilder builder;
+    appendProgram(builder, format.encode, VMImageSectionKind::EncodeCode,
+                  VMImageSectionKind::EncodeTypeEntry,
+                  VMImageSectionKind::EncodeMsgEntry);
+    appendProgram(builder, format.decode, VMImageSectionKind::DecodeCode,
+                  VMImageSectionKind::DecodeTypeEntry,
+                  VMImageSectionKind::DecodeMsgEntry);
+
+    std::vector<VMImageMessageNumber> numbers;
+    numbers.reserve(format.msgs.messageNumberToId.size());
+    for (auto const& [number, id] : format.msgs.messageNumberToId)
+        numbers.push_back({.number = number, .id = id});
+    std::ranges::sort(numbers, {}, &VMImageMessageNumber::number);
+    builder.append(VMImageSectionKind::MessageNumbers, numbers);
+
+    std::vector<std::pair<std::string_view, uint64_t>> sortedNames(
+        format.msgs.messageNameToId.begin(), format.msgs.messageNameToId.end());
+    std::ranges::sort(sortedNames);
+    std::vector<VMImageMessageName> names;
+    std::vector<char> chars;
+    for (auto const& [name, id] : sortedNames) {
+        names.push_back({
+            .offset = (uint32_t)chars.size(),
+            .size = (uint32_t)name.size(),
+            .id = id,
+        });
+        chars.insert(chars.end(), name.begin(), name.end());
+    }
+    builder.append(VMImageSectionKind::MessageNames, names);
+    builder.append(VMImageSectionKind::MessageNameChars, chars);
+
+    builder.append(VMImageSectionKind::CodecTypes, codec.types);
+    builder.append(VMImageSectionKind::CodecOneofs, codec.oneofs);
+    builder.append(VMImageSectionKind::CodecOneofFieldNumbers,
+                   codec.oneofFieldNumbers);
+    builder.append(VMImageSectionKind::CodecQuantizations, codec.quantizations);
+    builder.append(VMImageSectionKind::CodecFields, codec.fields);
+    builder.append(VMImageSectionKind::CodecMessages, codec.messages);
+    builder.append(VMImageSectionKind::CodecFieldLookups, codec.fieldLookups);
+    builder.append(VMImageSectionKind::CodecNetMaxBits, codec.netMaxBits);
+    return builder.finish();
+}
+
+namespace {
+template <class T>
+bool validSection(VMImageSection const& section, size_t imageSize) {
+    if (section.offset % alignof(T) != 0 || section.offset > imageSize)
+        return false;
+    return section.count <= (imageSize - section.offset) / sizeof(T);
+}
+
+bool validSections(VMImageHeader const& header) {
+    using enum VMImageSectionKind;
+    auto const& s = header.sections;
+    auto size = header.imageSize;
+    auto at = [&](VMImageSectionKind kind) { return s[(size_t)kind]; };
+    return validSection<uint32_t>(at(EncodeCode), size) &&
+           validSection<uint32_t>(at(EncodeTypeEntry), size) &&
+           validSection<uint32_t>(at(EncodeMsgEntry), size) &&
+           validSection<uint32_t>(at(DecodeCode), size) &&
+           validSection<uint32_t>(at(DecodeTypeEntry), size) &&
+           validSection<uint32_t>(at(DecodeMsgEntry), size) &&
+           validSection<VMImageMessageNumber>(at(MessageNumbers), size) &&
+           validSection<VMImageMessageName>(at(MessageNames), size) &&
+           validSection<char>(at(MessageNameChars), size) &&
+           validSection<codec::CodecType>(at(CodecTypes), size) &&
+           validSection<codec::CodecOneof>(at(CodecOneofs), size) &&
+           validSection<uint32_t>(at(CodecOneofFieldNumbers), size) &&
+           validSection<codec::CodecQuantization>(at(CodecQuantizations),
+                                                  size) &&
+           validSection<codec::CodecField>(at(CodecFields), size) &&
+           validSection<codec::CodecMessage>(at(CodecMessages), size) &&
+           validSection<codec::CodecFieldLookup>(at(CodecFieldLookups),
+                                                 size) &&
+           validSection<uint64_t>(at(CodecNetMaxBits), size);
+}
+}  // namespace
+
+template <class T>
+std::span<T const> VMImage::section(VMImageSectionKind kind) const {
+    auto const& desc = m_header->sections[(size_t)kind];
+    return {reinterpret_cast<T const*>(m_bytes.data() + desc.offset),
+            (size_t)desc.count};
+}
+
+std::optional<VMImage> VMImage::fromBytes(std::span<std::byte const> bytes) {
+    if (bytes.size() < sizeof(VMImageHeader) ||
+        reinterpret_cast<uintptr_t>(bytes.data()) % kSectionAlign != 0)
+        return {};
+    auto const* header = reinterpret_cast<VMImageHeader const*>(bytes.data());
+    if (header->magic != VMImageHeader{}.magic ||
+        header->version != VMImageHeader{}.version ||
+        header->imageSize != bytes.size() || !validSections(*header))
+        return {};
+    if (hashImage(bytes) != header->hash)
+        return {};
+
+    VMImage ret;
+    ret.m_bytes = bytes;
+    ret.m_header = header;
+    auto chars = ret.section<char>(VMImageSectionKind::MessageNameChars);
+    for (auto const& name :
+         ret.section<VMImageMessageName>(VMImageSectionKind::MessageNames)) {
+        if (name.offset > chars.size() ||
+            name.size > chars.size() - name.offset)
+            return {};
+    }
+    auto lookups = ret.section<codec::CodecFieldLookup>(
+        VMImageSectionKind::CodecFieldLookups);
+    for (auto const& msg :
+         ret.section<codec::CodecMessage>(VMImageSectionKind::CodecMessages)) {
+        if (msg.lookupStart > lookups.size() ||
+            msg.lookupCount > lookups.size() - msg.lookupStart)
+            return {};
+    }
+    return ret;
+}
+
+std::optional<VMImage> VMImage::map(std::filesystem::path const& path) {
+    auto file = pack::MappedFile::open(path);
+    if (!file)
+        return {};
+    auto ret = fromBytes(file->bytes());
+    if (ret)
+        ret->m_file = std::move(file);
+    return ret;
+}
+
+ProgramView VMImage::encode() const {
+    return {
+        section<uint32_t>(VMImageSectionKind::EncodeCode),
+        section<uint32_t>(VMImageSectionKind::EncodeTypeEntry),
+        section<uint32_t>(VMImageSectionKind::EncodeMsgEntry),
+    };
+}
+ProgramView VMImage::decode() const {
+    return {
+        section<uint32_t>(VMImageSectionKind::DecodeCode),
+        section<uint32_t>(VMImageSectionKind::DecodeTypeEntry),
+        section<uint32_t>(VMImageSectionKind::DecodeMsgEntry),
+    };
+}
+codec::CodecTableView VMImage::codec() const {
+    return {
+        section<codec::CodecType>(VMImageSectionKind::CodecTypes),
+        section<codec::CodecOneof>(VMImageSectionKind::CodecOneofs),
+        section<uint32_t>(VMImageSectionKind::CodecOneofFieldNumbers),
+        section<codec::CodecQuantization>(
+            VMImageSectionKind::CodecQuantizations),
+        section<codec::CodecField>(VMImageSectionKind::CodecFields),
+        section<codec::CodecMessage>(VMImageSectionKind::CodecMessages),
+        section<codec::CodecFieldLookup>(
+            VMImageSectionKind::CodecFieldLookups),
+        section<uint64_t>(VMImageSectionKind::CodecNetMaxBits),
+    };
+}
+
+std::optional<uint64_t> VMImage::getId(std::string_view qualifiedName) const {
+    auto names = section<VMImageMessageName>(VMImageSectionKind::MessageNames);
+    auto chars = section<char>(VMImageSectionKind::MessageNameChars);
+    auto nameOf = [&](VMImageMessageName const& name) {
+        return std::string_view{chars.data() + name.offset, name.size};
+    };
+    auto it = std::ranges::lower_bound(names, qualifiedName, {}, nameOf);
+    if (it == names.end() || nameOf(*it) != qualifiedName)
+        return {};
+    return it->id;
+}
+std::optional<uint64_t> VMImage::getId(size_t messageNumber) const {
+    auto numbers =
+        section<VMImageMessageNumber>(VMImageSectionKind::MessageNumbers);
+    auto it = std::ranges::lower_bound(numbers, (uint64_t)messageNumber, {},
+                                       &VMImageMessageNumber::number);
+    if (it == numbers.end() || it->number != messageNumber)
+        return {};
+    return it->id;
+}
+}  // namespace ao::schema::vm
@@ -49,6 +49,8 @@ static std::string opName(Op op) {
         CASE(C_READ_ONEOF_ARM)
         CASE(C_WRITE_ARRAY_LEN)
         CASE(C_READ_ARRAY_LEN)
+        CASE(C_FIELD_LOOKUP)
+        CASE(C_NEXT_FIELD)
         CASE(O_WRITE_SCALAR)
         CASE(O_READ_SCALAR)
         CASE(O_WRITE_OPT_PRESENT)
@@ -57,6 +59,7 @@ static std::string opName(Op op) {
         CASE(O_READ_ONEOF_ARM)
         CASE(O_WRITE_ARRAY_LEN)
         CASE(O_READ_ARRAY_LEN)
+        CASE(O_FIELD_DEFAULT)
 #undef CASE
         default:
             return "UNKNOWN_OP";
@@ -82,7 +85,7 @@ static std::string extKindName(ExtKind k) {
     }
 }
 
-std::string prettyPrint(Program const& prog) {
+std::string prettyPrint(ProgramView prog) {
     std::ostringstream out;
     auto const& words = prog.codeWords;
     out << std::format("Program: {} words\n", words.size());
@@ -173,9 +176,11 @@ std::string prettyPrint(Program const& prog) {
             case Op::C_READ_ONEOF_ARM:
             case Op::C_WRITE_ARRAY_LEN:
             case Op::C_READ_ARRAY_LEN:
+            case Op::C_NEXT_FIELD:
             case Op::O_WRITE_SCALAR:
             case Op::O_READ_SCALAR:
             case Op::O_READ_ONEOF_ARM:
+            case Op::O_FIELD_DEFAULT:
             case Op::ARRAY_NEXT:
                 // These commonly use imm as an unsigned or bit-width immediate
                 out << std::format("imm16 = {} \n", imm16_u);
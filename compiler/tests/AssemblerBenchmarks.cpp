@@ -0,0 +1,101 @@
+#include <catch2/catch_all.hpp>
+
+#include <format>
+
+#include "ao/schema/Assembler.h"
+#include "ao/schema/IR.h"
+#include "ao/schema/VM.h"
+
+using namespace ao::schema;
+using namespace ao::schema::ir;
+
+namespace {
+// Every message carries the common field shapes and nests the previous one,
+// similar to what a large game protocol schema generates
+IR syntheticSchema(size_t messageCount) {
+    IR ir;
+    ir.directiveSets.push_back(DirectiveSet{});
+    auto addType = [&](Type type) {
+        ir.types.push_back(std::move(type));
+        return IdFor<Type>{ir.types.size() - 1};
+    };
+    auto addField = [&](std::string name, uint64_t number, IdFor<Type> type) {
+        ir.strings.push_back(std::move(name));
+        ir.fields.push_back(Field{
+            .name = {ir.strings.size() - 1},
+            .fieldNumber = number,
+            .type = type,
+            .directives = {0},
+        });
+        return IdFor<Field>{ir.fields.size() - 1};
+    };
+
+    auto i32 = addType(Type{Scalar{.kind = Scalar::INT, .width = 32}});
+    auto u10 = addType(Type{Scalar{.kind = Scalar::UINT, .width = 10}});
+    auto chr = addType(Type{Scalar{.kind = Scalar::CHAR, .width = 8}});
+    auto str = addType(Type{Array{.type = chr}});
+    auto optU10 = addType(Type{Optional{.type = u10}});
+    ir.oneOfs.push_back(OneOf{.arms = {
+                                  addField("asInt", 1, i32),
+                                  addField("asString", 2, str),
+                              }});
+    auto choice = addType(Type{IdFor<OneOf>{ir.oneOfs.size() - 1}});
+
+    std::optional<IdFor<Type>> previous;
+    for (size_t i = 0; i < messageCount; ++i) {
+        ir.strings.push_back(std::format("pkg.Message{}", i));
+        Message msg{};
+        msg.name = {ir.strings.size() - 1};
+        msg.symbolId = i + 1;
+        msg.messageNumber = i + 1;
+        msg.directives = {0};
+        msg.fields = {
+            addField("id", 1, i32),
+            addField("count", 2, u10),
+            addField("name", 3, str),
+            addField("maybe", 4, optU10),
+            addField("choice", 5, choice),
+        };
+        if (previous) {
+            msg.fields.push_back(addField("child", 6, *previous));
+            msg.fields.push_back(
+                addField("children", 7, addType(Type{Array{.type = *previous}})));
+        }
+        ir.messages.push_back(std::move(msg));
+        previous = addType(Type{IdFor<Message>{ir.messages.size() - 1}});
+    }
+    return ir;
+}
+}  // namespace
+
+TEST_CASE("Assembler benchmarks", "[.][assembler][benchmark]") {
+    auto ir = syntheticSchema(5000);
+
+    BENCHMARK("generateProgram 5k messages") {
+        ErrorContext errs;
+        return vm::generateProgram(ir, errs);
+    };
+
+    BENCHMARK_ADVANCED("assemble 256k words with far jumps")(
+        Catch::Benchmark::Chronometer meter) {
+        vm::Assembler assembler{};
+        std::vector<uint64_t> labels;
+        for (size_t i = 0; i < 1024; ++i) {
+            labels.push_back(assembler.useLabel());
+        }
+        for (size_t i = 0; i < 1024; ++i) {
+            // Alternate between local and far targets
+            auto target = (i % 2 == 0) ? (i + 1) % labels.size()
+                                       : (i + labels.size() / 2) % labels.size();
+            assembler.jz(labels[target], labels[i]);
+            for (size_t j = 0; j < 255; ++j) {
+                assembler.emit(vm::Instr{vm::Op::HALT, 0, 0}, {});
+            }
+        }
+
+        meter.measure([&] {
+            ErrorContext errs;
+            return assembler.assemble(errs);
+        });
+    };
+}
@@ -137,3 +137,61 @@ TEST_CASE("Assembler long jumps", "[assembler]") {
     auto jump2 = std::bit_cast<int32_t>(code.at(jump1 + 1));
     REQUIRE(jump1 == -jump2);
 }
+
+TEST_CASE("Assembler widens jumps pushed out of range by other jumps",
+          "[assembler]") {
+    Assembler assembler{};
+    auto nearLabel = assembler.useLabel();
+    auto farLabel = assembler.useLabel();
+
+    // With every jump short the jz lands exactly at the edge of its range,
+    // widening the jmp after it pushes it over
+    assembler.jz(nearLabel, {});
+    assembler.jmp(farLabel, {});
+    for (size_t i = 2; i < std::numeric_limits<int16_t>::max(); ++i) {
+        assembler.emit(Instr{Op::HALT, 0, 0}, {});
+    }
+    assembler.emit(Instr{Op::HALT, 1, 0}, nearLabel);
+    for (size_t i = 0; i < 10; ++i) {
+        assembler.emit(Instr{Op::HALT, 0, 0}, {});
+    }
+    assembler.emit(Instr{Op::HALT, 2, 0}, farLabel);
+
+    ao::schema::ErrorContext errs;
+    auto code = assembler.assemble(errs);
+    INFO(errs.toString());
+    REQUIRE(errs.ok());
+
+    REQUIRE(decodeInstr(code.at(0)) ==
+            Instr{Op::EXT32, (uint8_t)ExtKind::JZ32, 0});
+    auto nearOffset = std::bit_cast<int32_t>(code.at(1));
+    REQUIRE(decodeInstr(code.at(nearOffset)) == Instr{Op::HALT, 1, 0});
+
+    REQUIRE(decodeInstr(code.at(2)) ==
+            Instr{Op::EXT32, (uint8_t)ExtKind::JMP32, 0});
+    auto farOffset = std::bit_cast<int32_t>(code.at(3));
+    REQUIRE(decodeInstr(code.at(2 + farOffset)) == Instr{Op::HALT, 2, 0});
+    REQUIRE(code.size() == (size_t)2 + farOffset + 1);
+}
+
+TEST_CASE("Assembler reports label errors", "[assembler]") {
+    ao::schema::ErrorContext errs;
+
+    SECTION("undefined label") {
+        Assembler assembler{};
+        auto label = assembler.useLabel();
+        assembler.jmp(label, {});
+        REQUIRE(assembler.assemble(errs).empty());
+    }
+
+    SECTION("label defined twice") {
+        Assembler assembler{};
+        auto label = assembler.useLabel();
+        assembler.emit(Instr{Op::HALT, 0, 0}, label);
+        assembler.emit(Instr{Op::HALT, 0, 0}, label);
+        assembler.jmp(label, {});
+        REQUIRE(assembler.assemble(errs).empty());
+    }
+
+    REQUIRE_FALSE(errs.ok());
+}
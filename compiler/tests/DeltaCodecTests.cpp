@@ -0,0 +1,141 @@
+#include <catch2/catch_all.hpp>
+
+#include <vector>
+
+#include "ao/schema/DeltaCodec.h"
+#include "ao/schema/JSONBackend.h"
+#include "ao/schema/VM.h"
+
+#include "CodecHelpers.h"
+
+using namespace ao::schema;
+using ao::schema::codec::delta::DeltaSnapshot;
+
+namespace {
+DeltaSnapshot requireSnapshot(json::JsonEncodeState const& state,
+                              uint64_t msgId,
+                              nlohmann::json const& input) {
+    DeltaSnapshot snapshot;
+    auto machine = json::recordJsonSnapshot(state, input, snapshot, msgId);
+    INFO("PC " << machine.pc);
+    REQUIRE(machine.error == vm::VMError::Ok);
+    return snapshot;
+}
+
+struct DeltaResult {
+    nlohmann::json output;
+    size_t bits;
+};
+
+DeltaResult deltaRoundTrip(json::JsonEncodeState const& state,
+                           uint64_t msgId,
+                           nlohmann::json const& baseline,
+                           nlohmann::json const& current) {
+    DeltaSnapshot base;
+    if (!baseline.is_null())
+        base = requireSnapshot(state, msgId, baseline);
+    auto next = requireSnapshot(state, msgId, current);
+
+    std::vector<std::byte> data(4096);
+    ao::pack::bit::WriteStream ws{data};
+    REQUIRE(codec::delta::encodeDelta(base, next, ws));
+
+    ao::pack::bit::ReadStream rs{{data.data(), ws.byteSize()}};
+    nlohmann::json output{nullptr};
+    auto decoded = json::decodeJsonDelta(state, base, rs, output, msgId);
+    {
+        INFO("PC " << decoded.pc);
+        INFO("DECODE" << prettyPrint(state.format.decode));
+        REQUIRE(decoded.error == vm::VMError::Ok);
+        REQUIRE(rs.ok());
+        REQUIRE(rs.remainingBytes() == 0);
+    }
+    return {output, ws.bitSize()};
+}
+}  // namespace
+
+TEST_CASE("Delta codec round trips against a baseline", "[delta][codec]") {
+    auto state = buildJsonState(R"(
+package pkg;
+message 101 Inner {
+    1 value int(bits=7);
+    2 enabled bool;
+}
+message 100 Test {
+    10 hello int(bits=10);
+    12 name string;
+    14 maybe optional<Inner>;
+    16 choice oneof {
+        101 asInt int(bits=9);
+        102 asInner Inner;
+    };
+    18 items array<uint(bits=5)>;
+    20 nested array<Inner>;
+    22 inner Inner;
+})");
+    auto msgId = requireMessageId(state, 100);
+
+    auto baseline = nlohmann::json::object({
+        {"hello", 12},
+        {"name", "player"},
+        {"maybe", nlohmann::json::object({
+                      {"value", {{"value", 3}, {"enabled", true}}},
+                  })},
+        {"choice", {{"case", 102}, {"value", {{"value", 4}, {"enabled", false}}}}},
+        {"items", nlohmann::json::array({1, 2, 3})},
+        {"nested", nlohmann::json::array({
+                       {{"value", 5}, {"enabled", true}},
+                       {{"value", -6}, {"enabled", false}},
+                   })},
+        {"inner", {{"value", 7}, {"enabled", false}}},
+    });
+
+    SECTION("unchanged message is one bit per field") {
+        auto result = deltaRoundTrip(state, msgId, baseline, baseline);
+        REQUIRE(result.output == baseline);
+        REQUIRE(result.bits == 7);
+    }
+
+    SECTION("no baseline sends the full message") {
+        auto result = deltaRoundTrip(state, msgId, nullptr, baseline);
+        REQUIRE(result.output == baseline);
+    }
+
+    SECTION("nested changes recurse") {
+        auto current = baseline;
+        current["maybe"]["value"]["enabled"] = false;
+        current["choice"]["value"]["value"] = -9;
+        current["items"][1] = 17;
+        current["nested"][0]["value"] = 30;
+        current["inner"]["enabled"] = true;
+
+        auto result = deltaRoundTrip(state, msgId, baseline, current);
+        REQUIRE(result.output == current);
+    }
+
+    SECTION("shape changes send full values") {
+        auto current = baseline;
+        current["name"] = "another player";
+        current["maybe"] = nullptr;
+        current["choice"] = {{"case", 101}, {"value", -100}};
+        current["items"] = nlohmann::json::array({4});
+        current["nested"] = nlohmann::json::array();
+
+        auto result = deltaRoundTrip(state, msgId, baseline, current);
+        REQUIRE(result.output == current);
+
+        auto back = deltaRoundTrip(state, msgId, current, baseline);
+        REQUIRE(back.output == baseline);
+    }
+
+    SECTION("delta is smaller than the full encoding") {
+        auto current = baseline;
+        current["hello"] = 13;
+
+        auto full = requireSnapshot(state, msgId, current);
+        auto result = deltaRoundTrip(state, msgId, baseline, current);
+        REQUIRE(result.output == current);
+        REQUIRE(result.bits == 7 + 10);
+        REQUIRE(result.bits < full.bitSize);
+    }
+}
@@ -1,8 +1,10 @@
 #include <catch2/catch_all.hpp>
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
 #include <cstdint>
+#include <span>
 #include <vector>
 
 #include "ao/pack/ByteStream.h"
@@ -473,3 +475,458 @@ TEST_CASE("Disk codec malformed array element tag yields BadData", "[disk][codec
     REQUIRE_FALSE(dec.ok());
     REQUIRE(dec.error() == ao::pack::Error::BadData);
 }
+
+// Version 2 length framing ----------------------------------------------------
+
+TEST_CASE("Disk v2 frames carry the byte length of their body",
+          "[disk][codec][v2]") {
+    std::vector<std::byte> data(64);
+    ao::schema::codec::CodecTable table;
+    table.fields.push_back({.fieldNumber = 10, .typeId = 0});
+
+    ao::pack::byte::WriteStream ws{
+        std::span<std::byte>(data.data(), data.size())};
+    DiskEncodeCodec<ao::pack::byte::WriteStream> enc{table, ws,
+                                                     DiskVersion::V2};
+    enc.msgBegin(0);
+    enc.fieldBegin(0);
+    enc.fieldId(0);
+    enc.u64(0, 5);
+    enc.fieldEnd();
+    enc.msgEnd();
+    REQUIRE(enc.ok());
+
+    auto tag = [](DiskTag t) { return (std::byte)t; };
+    std::vector<std::byte> expected = {
+        tag(DiskTag::MsgBegin), std::byte{6},
+        tag(DiskTag::Field),    std::byte{10},
+        tag(DiskTag::Varint),   std::byte{5},
+        tag(DiskTag::End),      tag(DiskTag::End),
+    };
+    data.resize(ws.byteSize());
+    REQUIRE(data == expected);
+}
+
+TEST_CASE("Disk v2 skips nested values by their length",
+          "[disk][codec][v2][skip]") {
+    std::vector<std::byte> data(4096);
+    ao::schema::codec::CodecTable table;
+    table.fields.push_back({.fieldNumber = 1, .typeId = 0});
+    table.fields.push_back({.fieldNumber = 2, .typeId = 0});
+    table.fields.push_back({.fieldNumber = 41, .typeId = 0});
+
+    ao::pack::byte::WriteStream ws{
+        std::span<std::byte>(data.data(), data.size())};
+    DiskEncodeCodec<ao::pack::byte::WriteStream> enc{table, ws,
+                                                     DiskVersion::V2};
+
+    // Field 1 holds an array of messages that each hold a large array, so
+    // nested lengths need more than one byte
+    enc.msgBegin(0);
+    enc.fieldBegin(0);
+    enc.fieldId(0);
+    enc.arrayBegin(0);
+    enc.arrayLen(0, 3);
+    for (int i = 0; i < 3; ++i) {
+        enc.msgBegin(0);
+        enc.fieldBegin(2);
+        enc.fieldId(2);
+        enc.arrayBegin(0);
+        enc.arrayLen(0, 100);
+        for (uint64_t v = 0; v < 100; ++v)
+            enc.u64(0, v * 1000);
+        enc.arrayEnd();
+        enc.fieldEnd();
+        enc.msgEnd();
+    }
+    enc.arrayEnd();
+    enc.fieldEnd();
+
+    enc.fieldBegin(1);
+    enc.fieldId(1);
+    enc.u64(0, 99);
+    enc.fieldEnd();
+    enc.msgEnd();
+    REQUIRE(enc.ok());
+    REQUIRE(ws.ok());
+
+    SECTION("skipping the array") {
+        ao::pack::byte::ReadStream rs{
+            std::span<std::byte const>(data.data(), ws.byteSize())};
+        DiskDecodeCodec<ao::pack::byte::ReadStream> dec{table, rs,
+                                                        DiskVersion::V2};
+        dec.msgBegin(0);
+        dec.fieldBegin(1);
+        REQUIRE_FALSE(dec.fieldId(1));
+        REQUIRE(dec.skipField(1));
+
+        dec.fieldBegin(1);
+        REQUIRE(dec.fieldId(1));
+        REQUIRE(dec.u64(0) == 99);
+        dec.fieldEnd();
+        dec.msgEnd();
+        REQUIRE(dec.ok());
+        REQUIRE(rs.remainingBytes() == 0);
+    }
+
+    SECTION("decoding through the frames") {
+        ao::pack::byte::ReadStream rs{
+            std::span<std::byte const>(data.data(), ws.byteSize())};
+        DiskDecodeCodec<ao::pack::byte::ReadStream> dec{table, rs,
+                                                        DiskVersion::V2};
+        dec.msgBegin(0);
+        dec.fieldBegin(0);
+        REQUIRE(dec.fieldId(0));
+        dec.arrayBegin(0);
+        REQUIRE(dec.arrayLen(0) == 3);
+        for (int i = 0; i < 3; ++i) {
+            dec.msgBegin(0);
+            dec.fieldBegin(2);
+            REQUIRE(dec.fieldId(2));
+            dec.arrayBegin(0);
+            REQUIRE(dec.arrayLen(0) == 100);
+            for (uint64_t v = 0; v < 100; ++v)
+                REQUIRE(dec.u64(0) == v * 1000);
+            dec.arrayEnd();
+            dec.fieldEnd();
+            dec.msgEnd();
+        }
+        dec.arrayEnd();
+        dec.fieldEnd();
+        dec.fieldBegin(1);
+        REQUIRE(dec.fieldId(1));
+        REQUIRE(dec.u64(0) == 99);
+        dec.fieldEnd();
+        dec.msgEnd();
+        REQUIRE(dec.ok());
+        REQUIRE(rs.remainingBytes() == 0);
+    }
+}
+
+TEST_CASE("Codec field lookup finds dense and sparse field numbers",
+          "[disk][codec][lookup]") {
+    using ao::schema::codec::CodecMessage;
+    ao::schema::codec::CodecTable table;
+    // Message 0 numbers its fields 3, 5 and 4
+    table.messages.push_back({.minFieldNumber = 3,
+                              .lookupStart = 0,
+                              .lookupCount = 3,
+                              .fieldCount = 3,
+                              .lookup = CodecMessage::Dense});
+    table.fieldLookups.push_back({.fieldNumber = 3, .index = 0});
+    table.fieldLookups.push_back({.fieldNumber = 4, .index = 2});
+    table.fieldLookups.push_back({.fieldNumber = 5, .index = 1});
+    // Message 1 numbers its fields 1000 and 2
+    table.messages.push_back({.minFieldNumber = 2,
+                              .lookupStart = 3,
+                              .lookupCount = 2,
+                              .fieldCount = 2,
+                              .lookup = CodecMessage::Sorted});
+    table.fieldLookups.push_back({.fieldNumber = 2, .index = 1});
+    table.fieldLookups.push_back({.fieldNumber = 1000, .index = 0});
+
+    ao::schema::codec::CodecTableView view{table};
+    REQUIRE(view.findField(0, 3) == 0);
+    REQUIRE(view.findField(0, 4) == 2);
+    REQUIRE(view.findField(0, 5) == 1);
+    REQUIRE(view.findField(0, 2) == 3);
+    REQUIRE(view.findField(0, 6) == 3);
+    REQUIRE(view.findField(1, 1000) == 0);
+    REQUIRE(view.findField(1, 2) == 1);
+    REQUIRE(view.findField(1, 3) == 2);
+    REQUIRE(view.findField(1, 1001) == 2);
+}
+
+TEST_CASE("Disk codec reads fields in any order through the lookup table",
+          "[disk][codec][lookup]") {
+    using ao::schema::codec::CodecMessage;
+    std::vector<std::byte> data(1024);
+    ao::schema::codec::CodecTable table;
+    table.fields.push_back({.fieldNumber = 10, .typeId = 0});
+    table.fields.push_back({.fieldNumber = 20, .typeId = 0});
+    table.fields.push_back({.fieldNumber = 30, .typeId = 0});
+    table.messages.push_back({.minFieldNumber = 10,
+                              .lookupStart = 0,
+                              .lookupCount = 2,
+                              .fieldCount = 2,
+                              .lookup = CodecMessage::Sorted});
+    table.fieldLookups.push_back({.fieldNumber = 10, .index = 0});
+    table.fieldLookups.push_back({.fieldNumber = 20, .index = 1});
+
+    // Written as 20, 30, 10 where the reader knows only 10 and 20
+    ao::pack::byte::WriteStream ws{
+        std::span<std::byte>(data.data(), data.size())};
+    DiskEncodeCodec<ao::pack::byte::WriteStream> enc{table, ws};
+    enc.msgBegin(0);
+    for (uint32_t field : {1u, 2u, 0u}) {
+        enc.fieldBegin(field);
+        enc.fieldId(field);
+        enc.u64(0, 100 + field);
+        enc.fieldEnd();
+    }
+    enc.msgEnd();
+    REQUIRE(enc.ok());
+
+    ao::pack::byte::ReadStream rs{
+        std::span<std::byte const>(data.data(), ws.byteSize())};
+    DiskDecodeCodec<ao::pack::byte::ReadStream> dec{table, rs};
+    REQUIRE(dec.fieldLookup());
+    dec.msgBegin(0);
+
+    REQUIRE(dec.nextField(0) == 1u);
+    dec.fieldBegin(1);
+    REQUIRE(dec.u64(0) == 101);
+    dec.fieldEnd();
+
+    REQUIRE(dec.nextField(0) == 2u);
+    REQUIRE(dec.skipField(2));
+
+    REQUIRE(dec.nextField(0) == 0u);
+    dec.fieldBegin(0);
+    REQUIRE(dec.u64(0) == 100);
+    dec.fieldEnd();
+
+    REQUIRE_FALSE(dec.nextField(0).has_value());
+    dec.msgEnd();
+    REQUIRE(dec.ok());
+    REQUIRE(rs.remainingBytes() == 0);
+
+    SECTION("unknown message id") {
+        ao::pack::byte::ReadStream again{
+            std::span<std::byte const>(data.data(), ws.byteSize())};
+        DiskDecodeCodec<ao::pack::byte::ReadStream> bad{table, again};
+        bad.msgBegin(0);
+        REQUIRE_FALSE(bad.nextField(1).has_value());
+        REQUIRE(bad.error() == ao::pack::Error::BadData);
+    }
+}
+
+TEST_CASE("Disk compact keys combine the field number and value tag",
+          "[disk][codec][compact]") {
+    std::vector<std::byte> data(64);
+    ao::schema::codec::CodecTable table;
+    table.fields.push_back({.fieldNumber = 3, .typeId = 0});
+    table.fields.push_back({.fieldNumber = 200, .typeId = 0});
+
+    ao::pack::byte::WriteStream ws{
+        std::span<std::byte>(data.data(), data.size())};
+    DiskEncodeCodec<ao::pack::byte::WriteStream> enc{table, ws,
+                                                     DiskVersion::Compact};
+    enc.msgBegin(0);
+    enc.fieldBegin(0);
+    enc.fieldId(0);
+    enc.u64(0, 5);
+    enc.fieldEnd();
+    enc.fieldBegin(1);
+    enc.fieldId(1);
+    enc.msgBegin(0);
+    enc.msgEnd();
+    enc.fieldEnd();
+    enc.msgEnd();
+    REQUIRE(enc.ok());
+
+    auto tag = [](DiskTag t) { return (std::byte)t; };
+    // 200 << 4 needs a two byte prefix int
+    std::vector<std::byte> expected = {
+        tag(DiskTag::MsgBegin),
+        std::byte{(3 << kKeyTagBits) | (uint8_t)DiskTag::Varint},
+        std::byte{5},
+        std::byte{0x80 | ((200 << kKeyTagBits) & 0x3f)},
+        std::byte{(200 << kKeyTagBits) >> 6},
+        tag(DiskTag::End),
+        tag(DiskTag::End),
+    };
+    data.resize(ws.byteSize());
+    REQUIRE(data == expected);
+}
+
+TEST_CASE("Disk compact fields skip and read without End tags",
+          "[disk][codec][compact][skip]") {
+    std::vector<std::byte> data(1024);
+    ao::schema::codec::CodecTable table;
+    table.fields.push_back({.fieldNumber = 1, .typeId = 0});
+    table.fields.push_back({.fieldNumber = 2, .typeId = 0});
+    table.fields.push_back({.fieldNumber = 3, .typeId = 0});
+
+    ao::pack::byte::WriteStream ws{
+        std::span<std::byte>(data.data(), data.size())};
+    DiskEncodeCodec<ao::pack::byte::WriteStream> enc{table, ws,
+                                                     DiskVersion::Compact};
+    // A nested message holding an optional and an array, then a double and
+    // an integer
+    enc.msgBegin(0);
+    enc.fieldBegin(0);
+    enc.fieldId(0);
+    enc.msgBegin(0);
+    enc.fieldBegin(1);
+    enc.fieldId(1);
+    enc.optBegin();
+    enc.i64(0, -7);
+    enc.optEnd();
+    enc.fieldEnd();
+    enc.fieldBegin(2);
+    enc.fieldId(2);
+    enc.arrayBegin(0);
+    enc.arrayLen(0, 2);
+    enc.u64(0, 1);
+    enc.u64(0, 300);
+    enc.arrayEnd();
+    enc.fieldEnd();
+    enc.msgEnd();
+    enc.fieldEnd();
+
+    enc.fieldBegin(1);
+    enc.fieldId(1);
+    enc.f64(0, 2.5);
+    enc.fieldEnd();
+
+    enc.fieldBegin(2);
+    enc.fieldId(2);
+    enc.i64(0, -99);
+    enc.fieldEnd();
+    enc.msgEnd();
+    REQUIRE(enc.ok());
+
+    ao::pack::byte::ReadStream rs{
+        std::span<std::byte const>(data.data(), ws.byteSize())};
+    DiskDecodeCodec<ao::pack::byte::ReadStream> dec{table, rs,
+                                                    DiskVersion::Compact};
+    dec.msgBegin(0);
+    dec.fieldBegin(2);
+    REQUIRE_FALSE(dec.fieldId(2));
+    REQUIRE(dec.skipField(2));
+
+    dec.fieldBegin(1);
+    REQUIRE(dec.fieldId(1));
+    REQUIRE(dec.f64(0) == 2.5);
+    dec.fieldEnd();
+
+    dec.fieldBegin(2);
+    REQUIRE(dec.fieldId(2));
+    REQUIRE(dec.i64(0) == -99);
+    dec.fieldEnd();
+    dec.msgEnd();
+    REQUIRE(dec.ok());
+    REQUIRE(rs.remainingBytes() == 0);
+}
+
+TEST_CASE("Disk packed scalar arrays share one element tag",
+          "[disk][codec][packed]") {
+    using ao::schema::codec::CodecType;
+    ao::schema::codec::CodecTable table;
+    table.types.push_back(
+        {.bitWidth = 0, .flags = CodecType::DiskPackedVarint});
+    table.types.push_back(
+        {.bitWidth = 0, .flags = CodecType::DiskPackedFixed8});
+    table.types.push_back(
+        {.bitWidth = 0, .flags = CodecType::DiskPackedFixed32});
+    table.fields.push_back({.fieldNumber = 1, .typeId = 0});
+    table.fields.push_back({.fieldNumber = 2, .typeId = 1});
+    table.fields.push_back({.fieldNumber = 3, .typeId = 2});
+
+    std::vector<std::byte> data(256);
+    ao::pack::byte::WriteStream ws{
+        std::span<std::byte>(data.data(), data.size())};
+    DiskEncodeCodec<ao::pack::byte::WriteStream> enc{table, ws,
+                                                     DiskVersion::Compact};
+    enc.msgBegin(0);
+    enc.fieldBegin(0);
+    enc.fieldId(0);
+    enc.arrayBegin(0);
+    enc.arrayLen(0, 3);
+    for (int64_t v : {1, -2, 300})
+        enc.i64(0, v);
+    enc.arrayEnd();
+    enc.fieldEnd();
+
+    enc.fieldBegin(1);
+    enc.fieldId(1);
+    enc.arrayBegin(1);
+    enc.arrayLen(0, 2);
+    enc.u64(8, 'h');
+    enc.u64(8, 'i');
+    enc.arrayEnd();
+    enc.fieldEnd();
+
+    enc.fieldBegin(2);
+    enc.fieldId(2);
+    enc.arrayBegin(2);
+    enc.arrayLen(0, 2);
+    enc.f32(0, 0.5f);
+    enc.f32(0, -8.f);
+    enc.arrayEnd();
+    enc.fieldEnd();
+    enc.msgEnd();
+    REQUIRE(enc.ok());
+
+    SECTION("chars are raw bytes behind a single Fixed8 tag") {
+        auto key = [](uint64_t number) {
+            return std::byte{(uint8_t)((number << kKeyTagBits) |
+                                       (uint8_t)DiskTag::PackedArray)};
+        };
+        std::vector<std::byte> chars = {
+            key(2),
+            (std::byte)DiskTag::Fixed8,
+            std::byte{2},
+            std::byte{'h'},
+            std::byte{'i'},
+            (std::byte)DiskTag::End,
+        };
+        auto encoded = std::span{data}.first(ws.byteSize());
+        REQUIRE(std::ranges::search(encoded, chars).size() == chars.size());
+    }
+
+    SECTION("decoding") {
+        ao::pack::byte::ReadStream rs{
+            std::span<std::byte const>(data.data(), ws.byteSize())};
+        DiskDecodeCodec<ao::pack::byte::ReadStream> dec{table, rs,
+                                                        DiskVersion::Compact};
+        dec.msgBegin(0);
+        dec.fieldBegin(0);
+        REQUIRE(dec.fieldId(0));
+        dec.arrayBegin(0);
+        REQUIRE(dec.arrayLen(0) == 3);
+        REQUIRE(dec.i64(0) == 1);
+        REQUIRE(dec.i64(0) == -2);
+        REQUIRE(dec.i64(0) == 300);
+        dec.arrayEnd();
+        dec.fieldEnd();
+
+        // Skipping walks the packed payload without element tags
+        dec.fieldBegin(0);
+        REQUIRE_FALSE(dec.fieldId(0));
+        REQUIRE(dec.skipField(0));
+
+        dec.fieldBegin(2);
+        REQUIRE(dec.fieldId(2));
+        dec.arrayBegin(2);
+        REQUIRE(dec.arrayLen(0) == 2);
+        REQUIRE(dec.f32(0) == 0.5f);
+        REQUIRE(dec.f32(0) == -8.f);
+        dec.arrayEnd();
+        dec.fieldEnd();
+        dec.msgEnd();
+        REQUIRE(dec.ok());
+        REQUIRE(rs.remainingBytes() == 0);
+    }
+
+    SECTION("v1 keeps tagged elements") {
+        std::vector<std::byte> v1(256);
+        ao::pack::byte::WriteStream v1ws{
+            std::span<std::byte>(v1.data(), v1.size())};
+        DiskEncodeCodec<ao::pack::byte::WriteStream> v1enc{table, v1ws};
+        v1enc.arrayBegin(1);
+        v1enc.arrayLen(0, 1);
+        v1enc.u64(8, 'h');
+        v1enc.arrayEnd();
+        REQUIRE(v1enc.ok());
+        v1.resize(v1ws.byteSize());
+        REQUIRE(v1 == std::vector<std::byte>{
+                          (std::byte)DiskTag::ArrayBegin,
+                          std::byte{1},
+                          (std::byte)DiskTag::Varint,
+                          std::byte{'h'},
+                          (std::byte)DiskTag::End,
+                      });
+    }
+}
@@ -0,0 +1,90 @@
+#include <catch2/catch_all.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "ao/pack/ByteStream.h"
+#include "ao/schema/Envelope.h"
+#include "ao/schema/VM.h"
+
+using namespace ao::schema::envelope;
+
+namespace {
+std::vector<std::byte> bytesOf(std::initializer_list<uint8_t> values) {
+    std::vector<std::byte> ret;
+    for (auto v : values)
+        ret.push_back(std::byte{v});
+    return ret;
+}
+}  // namespace
+
+TEST_CASE("Envelopes frame payloads with number and length",
+          "[envelope]") {
+    std::vector<std::byte> data(64);
+    ao::pack::byte::WriteStream ws{data};
+    auto first = bytesOf({1, 2, 3});
+    auto second = bytesOf({});
+    REQUIRE(writeEnvelope(ws, 100, first));
+    REQUIRE(writeEnvelope(ws, 200, second));
+    data.resize(ws.byteSize());
+
+    // 200 no longer fits the single byte prefix int form
+    REQUIRE(data.size() == 2 + 3 + 3);
+    REQUIRE(std::vector(data.begin(), data.begin() + 5) ==
+            bytesOf({100, 3, 1, 2, 3}));
+
+    EnvelopeReader reader{data};
+    Envelope envelope;
+    REQUIRE(reader.next(envelope));
+    REQUIRE(envelope.messageNumber == 100);
+    REQUIRE(std::vector(envelope.payload.begin(), envelope.payload.end()) ==
+            first);
+    REQUIRE(reader.next(envelope));
+    REQUIRE(envelope.messageNumber == 200);
+    REQUIRE(envelope.payload.empty());
+    REQUIRE_FALSE(reader.next(envelope));
+    REQUIRE(reader.ok());
+    REQUIRE(reader.position() == data.size());
+}
+
+TEST_CASE("Envelope dispatch skips unknown message numbers", "[envelope]") {
+    ao::schema::vm::MessageIndex index;
+    index.messageNumberToId[10] = 4;
+    index.messageNumberToId[30] = 7;
+
+    std::vector<std::byte> data(64);
+    ao::pack::byte::WriteStream ws{data};
+    REQUIRE(writeEnvelope(ws, 10, bytesOf({0xaa})));
+    REQUIRE(writeEnvelope(ws, 20, bytesOf({0xbb, 0xbb})));
+    REQUIRE(writeEnvelope(ws, 30, bytesOf({0xcc})));
+    REQUIRE(writeEnvelope(ws, 10, bytesOf({0xdd})));
+
+    std::vector<std::pair<uint64_t, std::byte>> seen;
+    auto err = dispatchEnvelopes(
+        std::span<std::byte const>{data.data(), ws.byteSize()}, index,
+        [&](uint64_t id, Envelope const& envelope) {
+            REQUIRE(envelope.payload.size() == 1);
+            seen.push_back({id, envelope.payload[0]});
+        });
+    REQUIRE(err == ao::pack::Error::Ok);
+    REQUIRE(seen == std::vector<std::pair<uint64_t, std::byte>>{
+                        {4, std::byte{0xaa}},
+                        {7, std::byte{0xcc}},
+                        {4, std::byte{0xdd}},
+                    });
+}
+
+TEST_CASE("Envelope reader reports truncated frames", "[envelope]") {
+    std::vector<std::byte> data(64);
+    ao::pack::byte::WriteStream ws{data};
+    REQUIRE(writeEnvelope(ws, 10, bytesOf({1, 2, 3, 4})));
+
+    EnvelopeReader reader{
+        std::span<std::byte const>{data.data(), ws.byteSize() - 1}};
+    Envelope envelope;
+    REQUIRE_FALSE(reader.next(envelope));
+    REQUIRE(reader.error() == ao::pack::Error::Eof);
+}
@@ -8,18 +8,20 @@ using namespace ao::pack::byte;
 using namespace ao::schema;
 using namespace ao::schema::ir;
 
-static std::vector<std::byte> writeIRToBuffer(IR const& ir) {
+static std::vector<std::byte> writeIRToBuffer(
+    IR const& ir,
+    ChecksumKind checksum = ChecksumKind::Blake3) {
     // sizing pass
     SizeWriteStream sizer;
     serialize(sizer, IRHeader{});
     // serialize payload + hash using the public API to get size
-    serializeIRFile(sizer, ir);
+    serializeIRFile(sizer, ir, checksum);
     REQUIRE(sizer.ok());
     auto total = sizer.byteSize();
 
     std::vector<std::byte> buf(total);
     WriteStream writer(std::span(buf.data(), buf.size()));
-    bool ok = serializeIRFile(writer, ir);
+    bool ok = serializeIRFile(writer, ir, checksum);
     REQUIRE(ok);
     return buf;
 }
@@ -48,6 +50,29 @@ TEST_CASE("serializeIRFile / deserializeIRFile roundtrip", "[irfile]") {
     REQUIRE(out.strings[0] == "one");
 }
 
+TEST_CASE("IR files round trip with every checksum", "[irfile]") {
+    auto const checksum = GENERATE(ChecksumKind::Blake3,
+                                   ChecksumKind::Xxh3_128,
+                                   ChecksumKind::Crc32c);
+    IR ir;
+    ir.strings = {"one", "two", "three"};
+    auto buf = writeIRToBuffer(ir, checksum);
+
+    IR out;
+    {
+        ReadStream reader(std::span(buf.data(), buf.size()));
+        REQUIRE(deserializeIRFile(reader, out));
+        REQUIRE(out.strings == ir.strings);
+    }
+
+    // Flip a character of the first string, past the vector and string sizes
+    SizeWriteStream headerSize;
+    serialize(headerSize, IRHeader{});
+    buf[headerSize.byteSize() + 16] ^= std::byte{0x01};
+    ReadStream reader(std::span(buf.data(), buf.size()));
+    REQUIRE_FALSE(deserializeIRFile(reader, out));
+}
+
 TEST_CASE("deserializeIRFile detects bad header", "[irfile]") {
     // Create buffer with corrupted header (wrong magic)
     SizeWriteStream sizer;
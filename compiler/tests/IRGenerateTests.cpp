@@ -547,4 +547,107 @@ message 101 Outer  {
         }
         CHECK(foundDisk);
     }
-}
\ No newline at end of file
+}
+TEST_CASE("generateIR from text: quantized floats", "[ir][text]") {
+    std::string errs;
+    auto ir = buildToIR(R"(
+package pkg;
+message 42 A {
+    1 pos float(min=-1024, max=1024, precision=0.01);
+    2 angle double(min=-3.2, max=3.2, precision=0.001);
+    3 raw float;
+}
+)",
+                        errs);
+    INFO(errs);
+    REQUIRE(ir.has_value());
+    REQUIRE(ir->messages.size() == 1);
+    auto const& msg = ir->messages[0];
+
+    auto scalarFor = [&](std::string const& name) {
+        auto field = findFieldByName(*ir, msg, name);
+        REQUIRE(field.has_value());
+        auto scalar = std::get_if<Scalar>(&ir->types[field->type.idx].payload);
+        REQUIRE(scalar != nullptr);
+        return *scalar;
+    };
+
+    auto pos = scalarFor("pos");
+    CHECK(pos.kind == Scalar::F32);
+    CHECK(pos.width == 32);
+    REQUIRE(pos.quantization.has_value());
+    CHECK(pos.quantization->min == -1024);
+    CHECK(pos.quantization->max == 1024);
+    CHECK(pos.quantization->precision == Catch::Approx(0.01));
+    CHECK(pos.quantization->bits() == 18);
+
+    auto angle = scalarFor("angle");
+    CHECK(angle.kind == Scalar::F64);
+    REQUIRE(angle.quantization.has_value());
+    CHECK(angle.quantization->min == Catch::Approx(-3.2));
+    CHECK(angle.quantization->bits() == 13);
+
+    CHECK_FALSE(scalarFor("raw").quantization.has_value());
+
+    SECTION("invalid quantization") {
+        auto schema = GENERATE(
+            "message 1 A { 1 f float(min=0, max=1); }",
+            "message 1 A { 1 f float(min=1, max=0, precision=0.1); }",
+            "message 1 A { 1 f float(min=0, max=1, precision=0); }",
+            "message 1 A { 1 f float(min=0, max=1, precision=\"a\"); }",
+            "message 1 A { 1 f double(scale=2); }");
+        std::string buildErrors;
+        CHECK_FALSE(buildToIR(schema, buildErrors).has_value());
+    }
+}
+
+TEST_CASE("generateIR from text: delta encoded arrays", "[ir][text]") {
+    std::string errs;
+    auto ir = buildToIR(R"(
+package pkg;
+message 42 A {
+    1 times array<uint> @net(encoding="delta");
+    2 offsets array<int(bits=16)> @disk(encoding="delta") @net(encoding="delta");
+    3 plain array<uint>;
+    4 name string @net(encoding="delta");
+}
+)",
+                        errs);
+    INFO(errs);
+    REQUIRE(ir.has_value());
+    REQUIRE(ir->messages.size() == 1);
+    auto const& msg = ir->messages[0];
+
+    auto arrayFor = [&](std::string const& name) {
+        auto field = findFieldByName(*ir, msg, name);
+        REQUIRE(field.has_value());
+        auto arr = std::get_if<Array>(&ir->types[field->type.idx].payload);
+        REQUIRE(arr != nullptr);
+        return *arr;
+    };
+
+    auto times = arrayFor("times");
+    CHECK(times.netEncoding == Array::DELTA);
+    CHECK(times.diskEncoding == Array::PLAIN);
+
+    auto offsets = arrayFor("offsets");
+    CHECK(offsets.netEncoding == Array::DELTA);
+    CHECK(offsets.diskEncoding == Array::DELTA);
+
+    auto plain = arrayFor("plain");
+    CHECK(plain.netEncoding == Array::PLAIN);
+    CHECK(plain.type == times.type);
+    CHECK(findFieldByName(*ir, msg, "plain")->type !=
+          findFieldByName(*ir, msg, "times")->type);
+
+    // Only integer arrays change layout
+    CHECK(arrayFor("name").netEncoding == Array::PLAIN);
+
+    SECTION("unknown encoding") {
+        std::string buildErrors;
+        CHECK_FALSE(buildToIR(
+                        R"(message 1 A { 1 f array<int> @net(encoding="rle"); })",
+                        buildErrors)
+                        .has_value());
+    }
+}
@@ -1,9 +1,12 @@
 #include <catch2/catch_all.hpp>
 
 #include <algorithm>
+#include <limits>
 #include <tuple>
+#include <type_traits>
 #include <vector>
 
+#include "ao/schema/Envelope.h"
 #include "ao/schema/JSONBackend.h"
 #include "ao/schema/VM.h"
 #include "ao/schema/VMPrettyPrint.h"
@@ -24,7 +27,12 @@ struct DiskStreams {
     using RS = ao::pack::byte::ReadStream;
 };
 
-using StreamTypes = std::tuple<NetStreams, DiskStreams>;
+struct NetAlignedStreams {
+    using WS = ao::schema::codec::net::NetAlignedWriteStream;
+    using RS = ao::schema::codec::net::NetAlignedReadStream;
+};
+
+using StreamTypes = std::tuple<NetStreams, DiskStreams, NetAlignedStreams>;
 
 // Scalar + nested message round trip
 TEMPLATE_LIST_TEST_CASE("Json codec round trips scalars and nested messages",
@@ -298,6 +306,86 @@ message 100 Test {
     }
 }
 
+// Deferred error checks only stop at calls, returns and loop back edges,
+// the result has to match checking after every instruction
+TEMPLATE_LIST_TEST_CASE("Json codec deferred error checks match eager ones",
+                        "[json][codec][diskcodec]",
+                        StreamTypes) {
+    using WS = typename TestType::WS;
+    using RS = typename TestType::RS;
+
+    auto state = buildJsonState(R"(
+package pkg;
+message 101 Inner {
+    1 value int(bits=7);
+}
+message 100 Test {
+    10 maybe optional<Inner>;
+    12 choice oneof {
+        101 asInt int(bits=9);
+        102 asInner Inner;
+    };
+    14 items array<uint(bits=5)>;
+    16 nested array<Inner>;
+    18 name string;
+})");
+
+    auto msgId = requireMessageId(state, 100);
+    auto input = nlohmann::json::object({
+        {"maybe", nlohmann::json::object({
+                      {"value", nlohmann::json::object({{"value", 9}})},
+                  })},
+        {"choice", nlohmann::json::object({
+                       {"case", 102},
+                       {"value", nlohmann::json::object({{"value", -3}})},
+                   })},
+        {"items", nlohmann::json::array({1, 2, 3})},
+        {"nested", nlohmann::json::array({
+                       nlohmann::json::object({{"value", 5}}),
+                       nlohmann::json::object({{"value", -6}}),
+                   })},
+        {"name", "deferred"},
+    });
+
+    std::vector<std::byte> data(1024);
+    WS ws{data};
+    auto encoded = encodeJson<ErrorCheck::Deferred>(state, input, ws, msgId);
+    REQUIRE(encoded.error == VMError::Ok);
+    auto const size = ws.byteSize();
+
+    SECTION("round trip") {
+        RS rs{{data.data(), size}};
+        nlohmann::json output;
+        auto decoded = decodeJson<ErrorCheck::Deferred>(state, rs, output,
+                                                        msgId);
+        REQUIRE(decoded.error == VMError::Ok);
+        REQUIRE(output == input);
+    }
+
+    SECTION("truncated input fails the same way") {
+        for (size_t len = 0; len < size; ++len) {
+            INFO("length " << len);
+            RS eagerStream{{data.data(), len}};
+            RS deferredStream{{data.data(), len}};
+            nlohmann::json output;
+            auto eager = decodeJson(state, eagerStream, output, msgId);
+            auto deferred = decodeJson<ErrorCheck::Deferred>(
+                state, deferredStream, output, msgId);
+            REQUIRE(eager.error != VMError::Ok);
+            REQUIRE(deferred.error == eager.error);
+        }
+    }
+
+    SECTION("object errors stop encoding") {
+        auto bad = input;
+        bad["nested"][1]["value"] = "oops";
+        WS badStream{data};
+        auto failed =
+            encodeJson<ErrorCheck::Deferred>(state, bad, badStream, msgId);
+        REQUIRE(failed.error == VMError::ObjectError);
+    }
+}
+
 // Arrays of oneofs
 TEMPLATE_LIST_TEST_CASE("Json codec round trips arrays of oneofs",
                         "[json][codec][diskcodec]",
@@ -829,3 +917,322 @@ message 100 StrBytes {
     auto output = roundTrip<WS, RS>(state, msgId, input);
     REQUIRE(input == output);
 }
+
+TEMPLATE_LIST_TEST_CASE("Json codec quantizes floats on the net codec",
+                        "[json][codec][diskcodec]",
+                        StreamTypes) {
+    using WS = typename TestType::WS;
+    using RS = typename TestType::RS;
+    constexpr bool isNet = !std::is_same_v<TestType, DiskStreams>;
+
+    auto state = buildJsonState(R"(
+package pkg;
+message 100 Test {
+    10 pos float(min=-1024, max=1024, precision=0.01);
+    12 angle double(min=-3.2, max=3.2, precision=0.001);
+    14 raw float;
+})");
+    auto msgId = requireMessageId(state, 100);
+
+    SECTION("values in range") {
+        auto input = nlohmann::json::object({
+            {"pos", 12.345},
+            {"angle", -1.5707963},
+            {"raw", 0.1},
+        });
+        auto output = roundTrip<WS, RS>(state, msgId, input);
+
+        if constexpr (isNet) {
+            REQUIRE(output["pos"].get<double>() ==
+                    Catch::Approx(12.345).margin(0.006));
+            REQUIRE(output["angle"].get<double>() ==
+                    Catch::Approx(-1.5707963).margin(0.0005));
+        } else {
+            REQUIRE(output["pos"].get<float>() == 12.345f);
+            REQUIRE(output["angle"].get<double>() == -1.5707963);
+        }
+        REQUIRE(output["raw"].get<float>() == 0.1f);
+    }
+
+    SECTION("values out of range are clamped on the net") {
+        auto input = nlohmann::json::object({
+            {"pos", 5000.0},
+            {"angle", -10.0},
+            {"raw", 0.0},
+        });
+        auto output = roundTrip<WS, RS>(state, msgId, input);
+        if constexpr (isNet) {
+            REQUIRE(output["pos"].get<double>() == Catch::Approx(1024));
+            REQUIRE(output["angle"].get<double>() == Catch::Approx(-3.2));
+        } else {
+            REQUIRE(output["pos"].get<double>() == 5000.0);
+            REQUIRE(output["angle"].get<double>() == -10.0);
+        }
+    }
+
+    SECTION("quantized floats use fewer bits") {
+        if constexpr (std::is_same_v<TestType, NetStreams>) {
+            std::vector<std::byte> data(64);
+            WS ws{data};
+            auto input = nlohmann::json::object({
+                {"pos", 1.0},
+                {"angle", 1.0},
+                {"raw", 1.0},
+            });
+            auto encoded = encodeJson(state, input, ws, msgId);
+            REQUIRE(encoded.error == VMError::Ok);
+            REQUIRE(ws.bitSize() == 18 + 13 + 32);
+        }
+    }
+}
+
+TEMPLATE_LIST_TEST_CASE("Json codec delta encodes integer arrays",
+                        "[json][codec][diskcodec]",
+                        StreamTypes) {
+    using WS = typename TestType::WS;
+    using RS = typename TestType::RS;
+
+    auto state = buildJsonState(R"(
+package pkg;
+message 100 Test {
+    10 times array<uint(bits=32)> @net(encoding="delta") @disk(encoding="delta");
+    12 offsets array<int> @net(encoding="delta") @disk(encoding="delta");
+    14 plain array<uint(bits=32)>;
+    16 choice oneof {
+        101 ids array<uint> @net(encoding="delta") @disk(encoding="delta");
+        102 name string;
+    };
+})");
+    auto msgId = requireMessageId(state, 100);
+
+    auto times = nlohmann::json::array();
+    for (uint64_t i = 0; i < 37; ++i)
+        times.push_back(1'700'000'000 + i * 3);
+
+    auto input = nlohmann::json::object({
+        {"times", times},
+        {"offsets", nlohmann::json::array({-5, 100, -100, 0, 4, 4, 4})},
+        {"plain", times},
+        {"choice", {{"case", 101},
+                    {"value", nlohmann::json::array(
+                                  {0, std::numeric_limits<uint64_t>::max(),
+                                   12, 13})}}},
+    });
+
+    SECTION("values round trip") {
+        auto output = roundTrip<WS, RS>(state, msgId, input);
+        REQUIRE(output == input);
+    }
+
+    SECTION("empty arrays round trip") {
+        input["times"] = nlohmann::json::array();
+        input["offsets"] = nlohmann::json::array();
+        input["choice"]["value"] = nlohmann::json::array();
+        auto output = roundTrip<WS, RS>(state, msgId, input);
+        REQUIRE(output == input);
+    }
+
+    SECTION("monotone arrays are smaller than the plain encoding") {
+        auto encodedSize = [&](nlohmann::json const& value) {
+            std::vector<std::byte> data(4096);
+            WS ws{data};
+            auto encoded = encodeJson(state, value, ws, msgId);
+            REQUIRE(encoded.error == VMError::Ok);
+            return ws.byteSize();
+        };
+        auto withDelta = input;
+        withDelta["plain"] = nlohmann::json::array();
+        auto withPlain = input;
+        withPlain["times"] = nlohmann::json::array();
+        REQUIRE(encodedSize(withDelta) < encodedSize(withPlain));
+    }
+}
+
+TEST_CASE("Json disk codec decodes fields in any order",
+          "[json][codec][diskcodec]") {
+    // The writer orders fields differently, has a field the reader lacks and
+    // lacks one the reader has
+    auto writer = buildJsonState(R"(
+package pkg;
+message 100 Test {
+    2 b int;
+    7 extra string;
+    1 a int;
+})");
+    auto reader = buildJsonState(R"(
+package pkg;
+message 100 Test {
+    1 a int;
+    2 b int;
+    3 c int;
+})");
+
+    std::vector<std::byte> data(1024);
+    ao::pack::byte::WriteStream ws{data};
+    auto encoded = encodeJson(writer,
+                              nlohmann::json::object({
+                                  {"a", -4},
+                                  {"b", 9},
+                                  {"extra", "skipped"},
+                              }),
+                              ws, requireMessageId(writer, 100));
+    REQUIRE(encoded.error == VMError::Ok);
+
+    ao::pack::byte::ReadStream rs{{data.data(), ws.byteSize()}};
+    nlohmann::json output;
+    auto decoded =
+        decodeJson(reader, rs, output, requireMessageId(reader, 100));
+    REQUIRE(decoded.error == VMError::Ok);
+    REQUIRE(rs.remainingBytes() == 0);
+    REQUIRE(output["a"] == -4);
+    REQUIRE(output["b"] == 9);
+    REQUIRE(output["c"].is_null());
+    REQUIRE_FALSE(output.contains("extra"));
+}
+
+TEST_CASE("Json disk codec round trips the compact profile",
+          "[json][codec][diskcodec][compact]") {
+    using ao::schema::codec::disk::DiskVersion;
+    auto state = buildJsonState(R"(
+package pkg;
+message 101 Inner {
+    1 count uint;
+    2 enabled bool;
+}
+message 100 Test {
+    1 hello int;
+    2 ratio double;
+    3 name string;
+    4 inner Inner;
+    5 maybe optional<Inner>;
+    6 choice oneof {
+        7 asInt int;
+        8 asInner Inner;
+    };
+    9 items array<int>;
+})");
+    auto msgId = requireMessageId(state, 100);
+    auto input = nlohmann::json::object({
+        {"hello", -12},
+        {"ratio", 0.25},
+        {"name", "compact"},
+        {"inner", {{"count", 3}, {"enabled", true}}},
+        {"maybe", {{"value", {{"count", 4}, {"enabled", false}}}}},
+        {"choice", {{"case", 8}, {"value", {{"count", 5}, {"enabled", true}}}}},
+        {"items", nlohmann::json::array({1, -2, 300})},
+    });
+
+    auto encodedSize = [&](DiskVersion version) {
+        std::vector<std::byte> data(4096);
+        ao::pack::byte::WriteStream ws{data};
+        auto encoded = encodeJson(state, input, ws, msgId, version);
+        REQUIRE(encoded.error == VMError::Ok);
+
+        ao::pack::byte::ReadStream rs{{data.data(), ws.byteSize()}};
+        nlohmann::json output;
+        auto decoded = decodeJson(state, rs, output, msgId, version);
+        REQUIRE(decoded.error == VMError::Ok);
+        REQUIRE(rs.remainingBytes() == 0);
+        REQUIRE(output == input);
+        return ws.byteSize();
+    };
+    REQUIRE(encodedSize(DiskVersion::Compact) < encodedSize(DiskVersion::V1));
+}
+
+TEST_CASE("Json net aligned profile rounds fields up to whole bytes",
+          "[json][codec][netaligned]") {
+    auto state = buildJsonState(R"(
+package pkg;
+message 100 Test {
+    1 small uint(bits=10);
+    2 flag bool;
+    3 delta int(bits=3);
+    4 ratio float(min=0, max=1, precision=0.01);
+})");
+    auto msgId = requireMessageId(state, 100);
+    auto input = nlohmann::json::object({
+        {"small", 0x2ab},
+        {"flag", true},
+        {"delta", -2},
+        {"ratio", 0.5},
+    });
+
+    std::vector<std::byte> data(64);
+    ao::schema::codec::net::NetAlignedWriteStream ws{data};
+    auto encoded = encodeJson(state, input, ws, msgId);
+    REQUIRE(encoded.error == VMError::Ok);
+    data.resize(ws.byteSize());
+    // 10 bits take two bytes, the 7 bit quantized float one
+    REQUIRE(data == std::vector<std::byte>{
+                        std::byte{0xab},
+                        std::byte{0x02},
+                        std::byte{0x01},
+                        std::byte{0x06},
+                        std::byte{50},
+                    });
+
+    ao::schema::codec::net::NetAlignedReadStream rs{
+        std::span<std::byte const>{data}};
+    nlohmann::json output;
+    auto decoded = decodeJson(state, rs, output, msgId);
+    REQUIRE(decoded.error == VMError::Ok);
+    REQUIRE(rs.remainingBytes() == 0);
+    REQUIRE(output["small"] == 0x2ab);
+    REQUIRE(output["delta"] == -2);
+    REQUIRE(output["ratio"].get<double>() == Catch::Approx(0.5));
+}
+
+TEST_CASE("Json messages of different types share one envelope stream",
+          "[json][codec][envelope]") {
+    using namespace ao::schema::envelope;
+    auto state = buildJsonState(R"(
+package pkg;
+message 100 Ping {
+    1 seq uint;
+}
+message 200 Chat {
+    1 text string;
+}
+message 300 Ignored {
+    1 value int;
+})");
+    auto pingId = requireMessageId(state, 100);
+    auto chatId = requireMessageId(state, 200);
+    auto ignoredId = requireMessageId(state, 300);
+
+    std::vector<std::byte> data(256);
+    ao::pack::byte::WriteStream ws{data};
+    auto frame = [&](uint64_t number, uint64_t id,
+                     nlohmann::json const& input) {
+        std::vector<std::byte> payload(64);
+        ao::pack::byte::WriteStream payloadStream{payload};
+        auto encoded = encodeJson(state, input, payloadStream, id);
+        REQUIRE(encoded.error == VMError::Ok);
+        payload.resize(payloadStream.byteSize());
+        REQUIRE(writeEnvelope(ws, number, payload));
+    };
+    frame(100, pingId, {{"seq", 1}});
+    frame(300, ignoredId, {{"value", -5}});
+    frame(200, chatId, {{"text", "hi"}});
+    frame(100, pingId, {{"seq", 2}});
+
+    std::vector<nlohmann::json> decoded;
+    auto err = dispatchEnvelopes(
+        std::span<std::byte const>{data.data(), ws.byteSize()},
+        state.format.msgs, [&](uint64_t id, Envelope const& envelope) {
+            // Consumers skip unwanted types without decoding them
+            if (id == ignoredId)
+                return;
+            ao::pack::byte::ReadStream rs{envelope.payload};
+            nlohmann::json output;
+            REQUIRE(decodeJson(state, rs, output, id).error == VMError::Ok);
+            REQUIRE(rs.remainingBytes() == 0);
+            decoded.push_back(output);
+        });
+    REQUIRE(err == ao::pack::Error::Ok);
+    REQUIRE(decoded == std::vector<nlohmann::json>{
+                           {{"seq", 1}},
+                           {{"text", "hi"}},
+                           {{"seq", 2}},
+                       });
+}
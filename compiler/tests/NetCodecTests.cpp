@@ -0,0 +1,158 @@
+#include <catch2/catch_all.hpp>
+
+#include <limits>
+#include <vector>
+
+#include "ao/schema/NetCodec.h"
+
+#include "CodecHelpers.h"
+
+using namespace ao::schema;
+
+namespace {
+char const* kSchema = R"(
+package pkg;
+message 101 Inner {
+    1 value int(bits=7);
+    2 enabled bool;
+}
+message 100 Bounded {
+    1 hello int(bits=10);
+    2 count uint;
+    3 maybe optional<Inner>;
+    4 choice oneof {
+        101 asInt int(bits=9);
+        102 asInner Inner;
+    };
+    5 ratio float(min=0, max=1, precision=0.01);
+    6 exact double;
+}
+message 102 Node {
+    1 value int(bits=4);
+    2 next optional<Node>;
+}
+message 103 Named {
+    1 name string;
+}
+)";
+
+nlohmann::json const kInput = {
+    {"hello", -12},
+    {"count", 100000},
+    {"maybe", {{"value", {{"value", 3}, {"enabled", true}}}}},
+    {"choice", {{"case", 102}, {"value", {{"value", 4}, {"enabled", false}}}}},
+    {"ratio", 0.5},
+    {"exact", 2.25},
+};
+}  // namespace
+
+TEST_CASE("Net max bits bound the encoded size of a type", "[net]") {
+    auto state = buildJsonState(kSchema);
+    auto const& bits = state.codec.netMaxBits;
+    REQUIRE(bits.size() == state.codec.types.size());
+
+    // 10 + 72 prefix int + (1 + 7 + 1) + (2 + 9) + 7 + 64
+    REQUIRE(bits[requireMessageId(state, 100)] == 173);
+    REQUIRE(bits[requireMessageId(state, 101)] == 8);
+    REQUIRE(bits[requireMessageId(state, 102)] == codec::kUnboundedBits);
+    REQUIRE(bits[requireMessageId(state, 103)] == codec::kUnboundedBits);
+
+    codec::CodecTableView view{state.codec};
+    REQUIRE(view.netMaxBitsOf((uint32_t)bits.size()) ==
+            codec::kUnboundedBits);
+}
+
+TEST_CASE("Net decode skips bounds checks when the input is large enough",
+          "[net]") {
+    auto state = buildJsonState(kSchema);
+    auto msgId = requireMessageId(state, 100);
+
+    std::vector<std::byte> data(64);
+    ao::pack::bit::WriteStream ws{data};
+    auto encoded = encodeJson(state, kInput, ws, msgId);
+    REQUIRE(encoded.error == vm::VMError::Ok);
+    REQUIRE(ws.bitSize() <= state.codec.netMaxBits[msgId]);
+
+    SECTION("trusted decode of padded input") {
+        REQUIRE(data.size() * 8 >= state.codec.netMaxBits[msgId]);
+        ao::pack::bit::ReadStream rs{data};
+        nlohmann::json output;
+        auto decoded = decodeJson(state, rs, output, msgId);
+        REQUIRE(decoded.error == vm::VMError::Ok);
+        REQUIRE(rs.ok());
+        REQUIRE(rs.position().bitPos == ws.bitSize());
+        REQUIRE(output == kInput);
+    }
+
+    SECTION("checked decode of exact input") {
+        ao::pack::bit::ReadStream rs{{data.data(), ws.byteSize()}};
+        nlohmann::json output;
+        auto decoded = decodeJson(state, rs, output, msgId);
+        REQUIRE(decoded.error == vm::VMError::Ok);
+        REQUIRE(output == kInput);
+    }
+
+    SECTION("checked decode of truncated input") {
+        ao::pack::bit::ReadStream rs{{data.data(), ws.byteSize() - 1}};
+        nlohmann::json output;
+        auto decoded = decodeJson(state, rs, output, msgId);
+        REQUIRE(decoded.error == vm::VMError::CodecError);
+        REQUIRE(rs.error() == ao::pack::Error::Eof);
+    }
+
+    SECTION("both codecs agree") {
+        ao::pack::bit::ReadStream rs{data};
+        ao::pack::bit::TrustedReadStream ts{data};
+        codec::net::NetDecode checked{state.codec, rs};
+        codec::net::NetTrustedDecode trusted{state.codec, ts};
+        for (uint32_t width : {10u, 0u, 1u, 7u, 1u, 2u, 9u, 64u}) {
+            REQUIRE(trusted.u64(width) == checked.u64(width));
+            REQUIRE(ts.position().bitPos == rs.position().bitPos);
+        }
+    }
+}
+
+TEST_CASE("Net quantization clamps infinite and huge values", "[net]") {
+    codec::CodecTable table;
+    table.quantizations.push_back({
+        .min = -1,
+        .max = 1,
+        .precision = 0.01,
+        .maxSteps = 200,
+        .bits = 8,
+    });
+
+    std::vector<double> const inputs = {
+        std::numeric_limits<double>::infinity(),
+        -std::numeric_limits<double>::infinity(),
+        std::numeric_limits<double>::quiet_NaN(),
+        1e300,
+        -1e300,
+    };
+    std::vector<uint64_t> const expected = {200, 0, 0, 200, 0};
+
+    std::vector<std::byte> data(64);
+    ao::pack::bit::WriteStream ws{data};
+    codec::net::NetEncodeCodec<ao::pack::bit::WriteStream> enc{table, ws};
+    for (auto v : inputs)
+        enc.f64(1, v);
+    REQUIRE(ws.ok());
+    REQUIRE(ws.bitSize() == 8 * inputs.size());
+
+    ao::pack::bit::ReadStream rs{{data.data(), ws.byteSize()}};
+    for (auto steps : expected) {
+        uint64_t value = 0;
+        rs.bits(value, 8);
+        REQUIRE(value == steps);
+    }
+    REQUIRE(rs.ok());
+
+    ao::pack::bit::ReadStream decodeRs{{data.data(), ws.byteSize()}};
+    codec::net::NetDecodeCodec<ao::pack::bit::ReadStream> dec{table,
+                                                              decodeRs};
+    REQUIRE(dec.f64(1) == Catch::Approx(1.0));
+    REQUIRE(dec.f64(1) == Catch::Approx(-1.0));
+    REQUIRE(dec.f64(1) == Catch::Approx(-1.0));
+    REQUIRE(dec.f64(1) == Catch::Approx(1.0));
+    REQUIRE(dec.f64(1) == Catch::Approx(-1.0));
+}
@@ -0,0 +1,146 @@
+#include <catch2/catch_all.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include "ao/pack/IOByteStream.h"
+#include "ao/schema/VMImage.h"
+
+#include "CodecHelpers.h"
+
+using namespace ao::schema;
+
+namespace {
+char const* kSchema = R"(
+package pkg;
+message 101 Inner {
+    1 value int(bits=7);
+    2 enabled bool;
+}
+message 100 Test {
+    10 hello int(bits=10);
+    12 name string;
+    14 maybe optional<Inner>;
+    16 choice oneof {
+        101 asInt int(bits=9);
+        102 asInner Inner;
+    };
+    18 items array<int> @net(encoding="delta");
+    20 ratio float(min=0, max=1, precision=0.01);
+}
+)";
+
+nlohmann::json const kInput = {
+    {"hello", 12},
+    {"name", "player"},
+    {"maybe", {{"value", {{"value", 3}, {"enabled", true}}}}},
+    {"choice", {{"case", 102}, {"value", {{"value", 4}, {"enabled", false}}}}},
+    {"items", nlohmann::json::array({10, 12, 9})},
+    {"ratio", 0.5},
+};
+}  // namespace
+
+TEST_CASE("VM image round trips a format", "[vmimage]") {
+    auto state = buildJsonState(kSchema);
+    auto bytes = vm::buildVMImage(state.format, state.codec);
+    auto image = vm::VMImage::fromBytes(bytes);
+    REQUIRE(image.has_value());
+
+    SECTION("programs and codec tables are used in place") {
+        auto encode = image->encode();
+        REQUIRE(std::ranges::equal(encode.codeWords,
+                                   state.format.encode.codeWords));
+        REQUIRE(std::ranges::equal(encode.typeEntryPc,
+                                   state.format.encode.typeEntryPc));
+        REQUIRE(std::ranges::equal(image->decode().msgEntryPc,
+                                   state.format.decode.msgEntryPc));
+        REQUIRE(image->codec().fields.size() == state.codec.fields.size());
+        REQUIRE(image->encode().codeWords.data() >=
+                (uint32_t const*)bytes.data());
+        REQUIRE(image->encode().codeWords.data() <
+                (uint32_t const*)(bytes.data() + bytes.size()));
+    }
+
+    SECTION("message index") {
+        for (auto const& [number, id] : state.format.msgs.messageNumberToId)
+            REQUIRE(image->getId(number) == id);
+        for (auto const& [name, id] : state.format.msgs.messageNameToId)
+            REQUIRE(image->getId(name) == id);
+        REQUIRE_FALSE(image->getId((size_t)99).has_value());
+        REQUIRE_FALSE(image->getId("pkg.Missing").has_value());
+    }
+
+    SECTION("encodes and decodes with the image tables") {
+        auto msgId = image->getId((size_t)100);
+        REQUIRE(msgId.has_value());
+
+        std::vector<std::byte> data(4096);
+        ao::pack::bit::WriteStream ws{data};
+        json::JsonEncodeAdapter object{state.json, kInput};
+        codec::net::NetEncode encodeCodec{image->codec(), ws};
+        auto encoder = vm::VM{image->encode()};
+        REQUIRE(vm::encode(encoder, object, encodeCodec, *msgId));
+
+        std::vector<std::byte> expected(4096);
+        ao::pack::bit::WriteStream expectedWs{expected};
+        auto encoded = json::encodeJson(state, kInput, expectedWs, *msgId);
+        REQUIRE(encoded.error == vm::VMError::Ok);
+        REQUIRE(ws.bitSize() == expectedWs.bitSize());
+        REQUIRE(data == expected);
+
+        ao::pack::bit::ReadStream rs{{data.data(), ws.byteSize()}};
+        json::JsonDecodeAdapter output{state.json};
+        codec::net::NetDecode decodeCodec{image->codec(), rs};
+        auto decoder = vm::VM{image->decode()};
+        REQUIRE(vm::decode(decoder, output, decodeCodec, *msgId));
+        REQUIRE(rs.remainingBytes() == 0);
+        REQUIRE(output.root()["items"] == kInput["items"]);
+        REQUIRE(output.root()["choice"] == kInput["choice"]);
+        REQUIRE(output.root()["ratio"].get<double>() == Catch::Approx(0.5));
+    }
+}
+
+TEST_CASE("VM image rejects damaged images", "[vmimage]") {
+    auto state = buildJsonState(kSchema);
+    auto bytes = vm::buildVMImage(state.format, state.codec);
+
+    SECTION("corrupted payload") {
+        bytes.back() ^= std::byte{1};
+        REQUIRE_FALSE(vm::VMImage::fromBytes(bytes).has_value());
+    }
+    SECTION("corrupted section table") {
+        bytes[offsetof(vm::VMImageHeader, sections)] ^= std::byte{8};
+        REQUIRE_FALSE(vm::VMImage::fromBytes(bytes).has_value());
+    }
+    SECTION("truncated") {
+        bytes.pop_back();
+        REQUIRE_FALSE(vm::VMImage::fromBytes(bytes).has_value());
+    }
+    SECTION("wrong magic") {
+        bytes[0] ^= std::byte{1};
+        REQUIRE_FALSE(vm::VMImage::fromBytes(bytes).has_value());
+    }
+}
+
+TEST_CASE("VM image maps from a file", "[vmimage]") {
+    auto state = buildJsonState(kSchema);
+    auto path = std::filesystem::temp_directory_path() / "VMImageTests.aovm";
+    {
+        std::ofstream file{path, std::ios_base::out | std::ios_base::binary};
+        ao::pack::byte::OStreamWriteStream ws{file};
+        REQUIRE(vm::writeVMImage(ws, state.format, state.codec));
+    }
+
+    {
+        auto image = vm::VMImage::map(path);
+        REQUIRE(image.has_value());
+        REQUIRE(image->getId((size_t)100) ==
+                state.format.msgs.getId((size_t)100));
+        REQUIRE(std::ranges::equal(image->decode().codeWords,
+                                   state.format.decode.codeWords));
+    }
+    std::filesystem::remove(path);
+
+    REQUIRE_FALSE(vm::VMImage::map(path).has_value());
+}
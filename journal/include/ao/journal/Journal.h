@@ -2,12 +2,14 @@
 
 #include <cstdint>
 #include <filesystem>
-#include <fstream>
 #include <memory>
+#include <span>
+#include <vector>
 
+#include <ao/pack/FileStream.h>
 #include <ao/pack/HashingStream.h>
+#include <ao/schema/Checksum.h>
 #include <ao/schema/Serializer.h>
-#include <ao/utils/Blake3Hasher.h>
 
 namespace ao::journal {
 
@@ -63,102 +65,124 @@ struct FrameBatchStart {
 };
 // TODO make this a set of 3 functions
 // serialize, deserialize, skip
+// Each batch starts with its ChecksumKind, the hashes that follow the header
+// and the payload use that hasher.
+// `hashBuffer` is scratch for the hashing stream, callers handling many
+// batches pass the same one so each batch does not allocate its own.
 struct FrameBatchV1 {
     template <class Stream>
-    static JournalStatus serialize(Stream& stream, FrameBatch const& batch) {
-        pack::HashingStream<Stream, utils::hash::Blake3Hasher> stream{
-            baseStream};
-        stream.enableHashing();
-
-        auto header = journal::v1::FrameBatchStart{};
-        header.frame = batch.frame;
-        header.commandCount = batch.commands.size();
-        header.payloadSize = 0;
-        for (auto const& p : batch.commands) {
-            // Add 8 for the size of the message id
-            header.payloadSize += 8;
-            header.payloadSize += p.payload.size();
-        }
-
-        schema::serialize(stream, header);
-
-        auto headerHash = stream.digest();
-        schema::serialize(stream, headerHash);
-
-        // Reset hash and enable
-        stream.enableHashing();
-
-        for (auto const& p : batch.commands) {
-            schema::serialize(stream, p.messageId);
-            uint64_t size = p.payload.size();
-            schema::serialize(stream, size);
-            stream.bytes({p.payload.data(), p.payload.size()},
-                         p.payload.size());
-        }
-
-        auto payloadHash = stream.digest();
-        stream.disableHashing();
-        schema::serialize(stream, payloadHash);
-        return JournalStatus::Ok;
+    static JournalStatus serialize(
+        Stream& baseStream,
+        FrameBatch const& batch,
+        schema::ChecksumKind checksum = schema::ChecksumKind::Blake3,
+        std::span<std::byte> hashBuffer = {}) {
+        schema::serialize(baseStream, checksum);
+        return schema::withHasher(checksum, [&](auto hasher) {
+            pack::HashingStream<Stream, decltype(hasher)> stream{
+                baseStream, std::move(hasher), hashBuffer};
+            stream.enableHashing();
+
+            auto header = journal::v1::FrameBatchStart{};
+            header.frame = batch.frame;
+            header.commandCount = batch.commands.size();
+            header.payloadSize = 0;
+            for (auto const& p : batch.commands) {
+                // Add 8 for the size of the message id
+                header.payloadSize += 8;
+                header.payloadSize += p.payload.size();
+            }
+
+            schema::serialize(stream, header);
+
+            auto headerHash = stream.digest();
+            schema::serialize(stream, headerHash);
+
+            // Reset hash and enable
+            stream.enableHashing();
+
+            for (auto const& p : batch.commands) {
+                schema::serialize(stream, p.messageId);
+                uint64_t size = p.payload.size();
+                schema::serialize(stream, size);
+                stream.bytes(std::span<std::byte const>{p.payload},
+                             p.payload.size());
+            }
+
+            auto payloadHash = stream.digest();
+            stream.disableHashing();
+            schema::serialize(stream, payloadHash);
+            return JournalStatus::Ok;
+        });
     }
     // Skipping is just parsing frames
     template <class Stream>
-    static JournalStatus deserialize(Stream& stream, FrameBatch& batch) {
-        pack::HashingStream<Stream, utils::hash::Blake3Hasher> stream{
-            baseStream};
-        stream.enableHashing();
-
-        auto header = journal::v1::FrameBatchStart{};
-        schema::deserialize(stream, header);
-        if (!stream.ok())
+    static JournalStatus deserialize(Stream& baseStream,
+                                     FrameBatch& batch,
+                                     std::span<std::byte> hashBuffer = {}) {
+        auto checksum = schema::ChecksumKind::Blake3;
+        schema::deserialize(baseStream, checksum);
+        if (!baseStream.ok())
             return JournalStatus::Corruption;
 
-        auto actualHeaderHash = stream.digest();
-        utils::hash::Blake3Hasher::Hash expectedHeaderHash;
-        schema::deserialize(stream, expectedHeaderHash);
-        stream.require(expectedHeaderHash == actualHeaderHash,
-                       ao::pack::Error::BadData);
-        if (!stream.ok())
-            return JournalStatus::Corruption;
-
-        batch.frame = header.frame;
-
-        // Reset and enable
-        stream.enableHashing();
+        return schema::withHasher(checksum, [&](auto hasher) {
+            using Hasher = decltype(hasher);
+            pack::HashingStream<Stream, Hasher> stream{
+                baseStream, std::move(hasher), hashBuffer};
+            stream.enableHashing();
 
-        // TODO add a cap on how much this can reserve
-        batch.commands.reserve(header.commandCount);
-        for (size_t i = 0; i < header.commandCount; ++i) {
-            batch.commands.emplace_back();
-            auto& p = batch.commands.back();
-            schema::deserialize(stream, p.messageId);
+            auto header = journal::v1::FrameBatchStart{};
+            schema::deserialize(stream, header);
+            if (!stream.ok())
+                return JournalStatus::Corruption;
 
-            uint64_t messageSize = 0;
-            schema::deserialize(stream, messageSize);
+            auto actualHeaderHash = stream.digest();
+            typename Hasher::Hash expectedHeaderHash;
+            schema::deserialize(stream, expectedHeaderHash);
+            stream.require(expectedHeaderHash == actualHeaderHash,
+                           ao::pack::Error::BadData);
             if (!stream.ok())
                 return JournalStatus::Corruption;
 
-            p.payload.resize(messageSize);
-            stream.bytes({p.payload.data(), messageSize}, messageSize);
-        }
+            batch.frame = header.frame;
 
-        auto payloadHash = stream.digest();
-        auto expectedPayloadHash = utils::hash::Blake3Hasher::Hash{};
-        schema::deserialize(stream, expectedPayloadHash);
-        stream.require(payloadHash == expectedPayloadHash,
-                       ao::pack::Error::BadData);
-        if (!stream.ok())
-            return JournalStatus::Corruption;
+            // Reset and enable
+            stream.enableHashing();
+
+            // TODO add a cap on how much this can reserve
+            batch.commands.reserve(header.commandCount);
+            for (size_t i = 0; i < header.commandCount; ++i) {
+                batch.commands.emplace_back();
+                auto& p = batch.commands.back();
+                schema::deserialize(stream, p.messageId);
+
+                uint64_t messageSize = 0;
+                schema::deserialize(stream, messageSize);
+                if (!stream.ok())
+                    return JournalStatus::Corruption;
+
+                p.payload.resize(messageSize);
+                stream.bytes(std::span<std::byte>{p.payload}, messageSize);
+            }
+
+            auto payloadHash = stream.digest();
+            auto expectedPayloadHash = typename Hasher::Hash{};
+            schema::deserialize(stream, expectedPayloadHash);
+            stream.require(payloadHash == expectedPayloadHash,
+                           ao::pack::Error::BadData);
+            if (!stream.ok())
+                return JournalStatus::Corruption;
 
-        return JournalStatus::Ok;
-        // TODO we have to better map the error from the stream to a journal
-        // status
+            return JournalStatus::Ok;
+            // TODO we have to better map the error from the stream to a
+            // journal status
+        });
     }
     template <class Stream>
-    static JournalStatus skip(Stream& stream) {
+    static JournalStatus skip(Stream& stream,
+                              std::span<std::byte> hashBuffer = {}) {
         // We just deserialize but ignore the result
         FrameBatch out;
-        return deserialize(stream, out);
+        return deserialize(stream, out, hashBuffer);
     }
 };
 
@@ -198,9 +222,12 @@ class JournalStorage {
     JournalStorageSettings m_settings;
     std::filesystem::path m_rootPath;
 
-    std::unique_ptr<std::ifstream> m_readStream = nullptr;
-    std::unique_ptr<std::ofstream> m_writeStream = nullptr;
+    std::unique_ptr<pack::byte::FileReadStream> m_readStream = nullptr;
+    std::unique_ptr<pack::byte::FileWriteStream> m_writeStream = nullptr;
     std::vector<std::pair<FrameIndex, std::filesystem::path>> m_fileFrames;
+    // Shared by every frame batch read or written
+    std::vector<std::byte> m_hashBuffer =
+        std::vector<std::byte>(pack::kHashChunkSize);
 
     size_t m_currentReadIndex = 0;
     size_t m_writeFileSize = 0;
@@ -220,39 +247,7 @@ template <>
 struct Serializer<journal::FrameBatch> {
     template <class Stream>
     void serialize(Stream& baseStream, journal::FrameBatch const& batch) {
-        pack::HashingStream<Stream, utils::hash::Blake3Hasher> stream{
-            baseStream};
-        stream.enableHashing();
-
-        auto header = journal::v1::FrameBatchStart{};
-        header.frame = batch.frame;
-        header.commandCount = batch.commands.size();
-        header.payloadSize = 0;
-        for (auto const& p : batch.commands) {
-            // Add 8 for the size of the message id
-            header.payloadSize += 8;
-            header.payloadSize += p.payload.size();
-        }
-
-        schema::serialize(stream, header);
-
-        auto headerHash = stream.digest();
-        schema::serialize(stream, headerHash);
-
-        // Reset hash and enable
-        stream.enableHashing();
-
-        for (auto const& p : batch.commands) {
-            schema::serialize(stream, p.messageId);
-            uint64_t size = p.payload.size();
-            schema::serialize(stream, size);
-            stream.bytes({p.payload.data(), p.payload.size()},
-                         p.payload.size());
-        }
-
-        auto payloadHash = stream.digest();
-        stream.disableHashing();
-        schema::serialize(stream, payloadHash);
+        journal::v1::FrameBatchV1::serialize(baseStream, batch);
     }
 
     template <class Stream>
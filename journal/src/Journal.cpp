@@ -1,7 +1,5 @@
 #include "ao/journal/Journal.h"
 
-#include <ao/pack/IOByteStream.h>
-
 #include <algorithm>
 #include <expected>
 #include <filesystem>
@@ -136,24 +134,22 @@ bool JournalStorage::rotateLogFile() {
     m_fileFrames.emplace_back(
         m_nextWriteFrame,
         m_rootPath / "logs" / std::format("log_{:09}.bin", m_nextWriteFrame));
-    m_writeStream = std::make_unique<std::ofstream>(m_fileFrames.back().second,
-                                                    std::ios::binary);
+    m_writeStream = std::make_unique<pack::byte::FileWriteStream>(
+        m_fileFrames.back().second);
 
-    return true;
+    return m_writeStream->ok();
 }
 
 size_t JournalStorage::getLastFrame() {
     if (m_fileFrames.empty())
         return 0;
-    m_readStream = std::make_unique<std::ifstream>(m_fileFrames.back().second,
-                                                   std::ios::binary);
-
-    if (!m_readStream->good()) {
+    m_readStream = std::make_unique<pack::byte::FileReadStream>(
+        m_fileFrames.back().second);
+    if (!m_readStream->ok()) {
         m_status = JournalStatus::FailedOpenFile;
         return 0;
     }
-
-    ao::pack::byte::IStreamReadStream read{*m_readStream};
+    auto& read = *m_readStream;
 
     size_t lastFrame = 0;
     auto status = JournalStatus::Ok;
@@ -162,7 +158,7 @@ size_t JournalStorage::getLastFrame() {
     while (status == JournalStatus::Ok) {
         lastFrame = batch.frame;
         batch.frame = 0;
-        status = v1::FrameBatchV1::deserialize(read, batch);
+        status = v1::FrameBatchV1::deserialize(read, batch, m_hashBuffer);
     }
     if (status == JournalStatus::EndOfStream ||
         status == JournalStatus::Corruption) {
@@ -2,4 +2,116 @@
 
 #include "ao/journal/Journal.h"
 
+#include <ao/pack/ByteStream.h>
+
+using ao::journal::FrameBatch;
+using ao::journal::JournalStatus;
+using ao::journal::v1::FrameBatchV1;
+using ao::schema::ChecksumKind;
+
+namespace {
+FrameBatch sampleBatch() {
+    FrameBatch batch;
+    batch.frame = 42;
+    for (uint64_t id = 1; id <= 3; ++id) {
+        auto& command = batch.commands.emplace_back();
+        command.messageId = id;
+        for (size_t i = 0; i < id * 10; ++i)
+            command.payload.push_back(std::byte(i * id));
+    }
+    return batch;
+}
+
+std::vector<std::byte> writeBatch(FrameBatch const& batch,
+                                  ChecksumKind checksum) {
+    ao::pack::byte::SizeWriteStream sizer;
+    FrameBatchV1::serialize(sizer, batch, checksum);
+    std::vector<std::byte> buf(sizer.byteSize());
+    ao::pack::byte::WriteStream writer{buf};
+    REQUIRE(FrameBatchV1::serialize(writer, batch, checksum) ==
+            JournalStatus::Ok);
+    REQUIRE(writer.ok());
+    return buf;
+}
+}  // namespace
+
 TEST_CASE("Journal Basic Test", "[journal]") {}
+
+TEST_CASE("Frame batches round trip with every checksum", "[journal]") {
+    auto const checksum = GENERATE(ChecksumKind::Blake3,
+                                   ChecksumKind::Xxh3_128,
+                                   ChecksumKind::Crc32c);
+    auto const batch = sampleBatch();
+    auto const buf = writeBatch(batch, checksum);
+    REQUIRE(buf.front() == std::byte((uint8_t)checksum));
+
+    ao::pack::byte::ReadStream reader{buf};
+    FrameBatch out;
+    REQUIRE(FrameBatchV1::deserialize(reader, out) == JournalStatus::Ok);
+    REQUIRE(reader.remainingBytes() == 0);
+    REQUIRE(out.frame == batch.frame);
+    REQUIRE(out.commands.size() == batch.commands.size());
+    for (size_t i = 0; i < out.commands.size(); ++i) {
+        REQUIRE(out.commands[i].messageId == batch.commands[i].messageId);
+        REQUIRE(out.commands[i].payload == batch.commands[i].payload);
+    }
+}
+
+TEST_CASE("Frame batches with corrupted payloads are rejected",
+          "[journal]") {
+    auto const checksum = GENERATE(ChecksumKind::Blake3,
+                                   ChecksumKind::Xxh3_128,
+                                   ChecksumKind::Crc32c);
+    auto buf = writeBatch(sampleBatch(), checksum);
+    // Flip a bit in the last payload byte, just ahead of the payload hash
+    auto const hashSize =
+        ao::schema::withHasher(checksum, [](auto hasher) {
+            return sizeof(typename decltype(hasher)::Hash);
+        });
+    buf[buf.size() - hashSize - 1] ^= std::byte{0x10};
+
+    ao::pack::byte::ReadStream reader{buf};
+    FrameBatch out;
+    REQUIRE(FrameBatchV1::deserialize(reader, out) ==
+            JournalStatus::Corruption);
+}
+
+TEST_CASE("Frame batches with an unknown checksum are rejected",
+          "[journal]") {
+    auto buf = writeBatch(sampleBatch(), ChecksumKind::Crc32c);
+    buf[0] = std::byte((uint8_t)ChecksumKind::ChecksumKindMax);
+
+    ao::pack::byte::ReadStream reader{buf};
+    FrameBatch out;
+    REQUIRE(FrameBatchV1::deserialize(reader, out) ==
+            JournalStatus::Corruption);
+}
+
+TEST_CASE("Frame batches reuse a shared hash buffer", "[journal]") {
+    auto const checksum = GENERATE(ChecksumKind::Blake3,
+                                   ChecksumKind::Xxh3_128,
+                                   ChecksumKind::Crc32c);
+    std::vector<std::byte> hashBuffer(ao::pack::kHashChunkSize);
+
+    // Several batches back to back in one stream, as a log file holds them
+    auto batch = sampleBatch();
+    std::vector<std::byte> buf(4096);
+    ao::pack::byte::WriteStream writer{buf};
+    for (uint64_t frame = 0; frame < 3; ++frame) {
+        batch.frame = frame;
+        REQUIRE(FrameBatchV1::serialize(writer, batch, checksum, hashBuffer) ==
+                JournalStatus::Ok);
+    }
+    REQUIRE(writer.ok());
+
+    ao::pack::byte::ReadStream reader{{buf.data(), writer.byteSize()}};
+    for (uint64_t frame = 0; frame < 3; ++frame) {
+        FrameBatch out;
+        REQUIRE(FrameBatchV1::deserialize(reader, out, hashBuffer) ==
+                JournalStatus::Ok);
+        REQUIRE(out.frame == frame);
+        REQUIRE(out.commands.size() == batch.commands.size());
+        REQUIRE(out.commands.back().payload == batch.commands.back().payload);
+    }
+    REQUIRE(reader.remainingBytes() == 0);
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+
+#include <ao/pack/Error.h>
+#include <ao/pack/Word.h>
+
+namespace ao::pack::byte {
+// Bit stream interface over a byte stream that rounds every bit field up to
+// whole bytes. Fields are stored little endian so codecs written against bit
+// streams run on plain loads and stores, at the cost of the padding.
+template <class Stream>
+class AlignedWriteStream {
+   public:
+    explicit AlignedWriteStream(Stream stream) : m_stream(std::move(stream)) {}
+    AlignedWriteStream(std::span<std::byte> data)
+        requires std::constructible_from<Stream, std::span<std::byte>>
+        : m_stream(data) {}
+
+    AlignedWriteStream& bits(uint64_t ingest, size_t count) {
+        if (!ok())
+            return *this;
+        if (count > 64)
+            return fail(Error::BadArg);
+        std::array<std::byte, sizeof(ingest)> buffer;
+        auto const size = (count + 7) / 8;
+        storeWord(buffer.data(), size, ingest & maskBits(count));
+        m_stream.bytes(std::span<std::byte const>{buffer}, size);
+        return *this;
+    }
+    AlignedWriteStream& bytes(std::span<std::byte const> data, size_t count) {
+        if (ok())
+            m_stream.bytes(data, count);
+        return *this;
+    }
+    AlignedWriteStream& require(bool condition, Error err) {
+        if (ok() && !condition)
+            fail(err);
+        return *this;
+    }
+
+    size_t remainingBytes() const { return m_stream.remainingBytes(); }
+    size_t byteSize() const { return m_stream.byteSize(); }
+    Stream const& stream() const { return m_stream; }
+
+    bool ok() const { return error() == Error::Ok; }
+    Error error() const {
+        return m_status != Error::Ok ? m_status : m_stream.error();
+    }
+
+   private:
+    AlignedWriteStream& fail(Error err) {
+        m_status = err;
+        return *this;
+    }
+
+    Error m_status = Error::Ok;
+    Stream m_stream;
+};
+
+template <class Stream>
+class AlignedReadStream {
+   public:
+    explicit AlignedReadStream(Stream stream) : m_stream(std::move(stream)) {}
+    AlignedReadStream(std::span<std::byte const> data)
+        requires std::constructible_from<Stream, std::span<std::byte const>>
+        : m_stream(data) {}
+
+    AlignedReadStream& bits(uint64_t& out, size_t count) {
+        out = 0;
+        if (!ok())
+            return *this;
+        if (count > 64)
+            return fail(Error::BadArg);
+        auto const size = (count + 7) / 8;
+        if constexpr (requires(uint64_t w) { m_stream.peekWindow(w); }) {
+            uint64_t window;
+            if (m_stream.peekWindow(window) >= size) {
+                out = window & maskBits(count);
+                m_stream.advance(size);
+                return *this;
+            }
+        }
+        std::array<std::byte, sizeof(out)> buffer;
+        if (m_stream.bytes(std::span<std::byte>{buffer}, size).ok())
+            out = loadWord(buffer.data(), size) & maskBits(count);
+        return *this;
+    }
+    AlignedReadStream& bytes(std::span<std::byte> out, size_t count) {
+        if (ok())
+            m_stream.bytes(out, count);
+        return *this;
+    }
+    AlignedReadStream& require(bool condition, Error err) {
+        if (ok() && !condition)
+            fail(err);
+        return *this;
+    }
+
+    // Forwarded so prefix ints decode from a single peeked word
+    size_t peekWindow(uint64_t& out) const
+        requires requires(Stream const& s, uint64_t& w) { s.peekWindow(w); }
+    {
+        return ok() ? m_stream.peekWindow(out) : 0;
+    }
+    AlignedReadStream& advance(size_t count)
+        requires requires(Stream& s) { s.advance(size_t{}); }
+    {
+        if (ok())
+            m_stream.advance(count);
+        return *this;
+    }
+
+    size_t remainingBytes() const { return m_stream.remainingBytes(); }
+    Stream const& stream() const { return m_stream; }
+
+    bool ok() const { return error() == Error::Ok; }
+    Error error() const {
+        return m_status != Error::Ok ? m_status : m_stream.error();
+    }
+
+   private:
+    AlignedReadStream& fail(Error err) {
+        m_status = err;
+        return *this;
+    }
+
+    Error m_status = Error::Ok;
+    Stream m_stream;
+};
+}  // namespace ao::pack::byte
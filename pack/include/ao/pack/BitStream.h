@@ -4,6 +4,7 @@
 #include <span>
 
 #include <ao/pack/Error.h>
+#include <ao/pack/Word.h>
 
 namespace ao::pack::bit {
 
@@ -27,10 +28,19 @@ class ReadStream {
     ReadStream& bytes(std::span<std::byte> out, size_t count);
     ReadStream& require(bool condition, Error err);
 
+    // Loads up to the next 8 bytes into `out` as a little-endian word
+    // without consuming them, returns how many bytes are valid.
+    size_t peekWindow(uint64_t& out);
+    // Skips `count` bytes
+    ReadStream& advance(size_t count);
+    // Moves to `position`, Eof when that is past the end
+    ReadStream& seek(BitPosition position);
+
     size_t remainingBits() const;
     size_t remainingBytes() const { return remainingBits() / 8; }
 
     BitPosition position() const { return m_position; }
+    std::span<std::byte const> data() const { return m_data; }
 
     bool ok() const { return m_status == Error::Ok; }
     Error error() const { return m_status; }
@@ -40,7 +50,92 @@ class ReadStream {
         m_status = err;
         return *this;
     }
-    bool readBit(std::byte& byte);
+    // Loads the bits at the current position into the window
+    void refill();
+
+    Error m_status = Error::Ok;
+    BitPosition m_position = {0};
+    std::span<std::byte const> m_data;
+    // Unread bits starting at m_position, bits() is served from here and
+    // only touches m_data when the window runs short
+    uint64_t m_window = 0;
+    size_t m_windowBits = 0;
+};
+
+// Read stream without per read checks for inputs already known to hold
+// everything the caller is going to read, e.g. after comparing
+// remainingBits() against the worst case size of a message once up front.
+// Reading past the end is undefined behaviour, only require() can fail.
+class TrustedReadStream {
+   public:
+    TrustedReadStream(std::span<std::byte const> data,
+                      BitPosition position = {0})
+        : m_position(position), m_data(data) {}
+
+    TrustedReadStream& align() {
+        m_position.bitPos = (m_position.bitPos + 7) & ~size_t{7};
+        return *this;
+    }
+    TrustedReadStream& bits(uint64_t& out, size_t count) {
+        auto const shift = m_position.bitIndex();
+        auto const* src = m_data.data() + m_position.byteIndex();
+        auto word = load(src) >> shift;
+        // Bits shifted out above come from the ninth byte, which is in
+        // range whenever the field reaches it
+        if (shift + count > 64)
+            word |= uint64_t(src[sizeof(uint64_t)]) << (64 - shift);
+        out = word & maskBits(count);
+        m_position.bitPos += count;
+        return *this;
+    }
+    TrustedReadStream& bytes(std::span<std::byte> out, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            uint64_t byte;
+            bits(byte, 8);
+            out[i] = std::byte(byte);
+        }
+        return *this;
+    }
+    TrustedReadStream& require(bool condition, Error err) {
+        if (ok() && !condition)
+            m_status = err;
+        return *this;
+    }
+
+    // Same contract as ReadStream::peekWindow
+    size_t peekWindow(uint64_t& out) const {
+        auto const shift = m_position.bitIndex();
+        auto const* src = m_data.data() + m_position.byteIndex();
+        out = load(src) >> shift;
+        auto const available = std::min<size_t>(remainingBits(), 64);
+        if (shift != 0 && available > 64 - shift)
+            out |= uint64_t(src[sizeof(uint64_t)]) << (64 - shift);
+        return available / 8;
+    }
+    TrustedReadStream& advance(size_t count) {
+        m_position.bitPos += count * 8;
+        return *this;
+    }
+
+    size_t remainingBits() const {
+        auto const size = m_data.size() * 8;
+        return m_position.bitPos >= size ? 0 : size - m_position.bitPos;
+    }
+    size_t remainingBytes() const { return remainingBits() / 8; }
+
+    BitPosition position() const { return m_position; }
+
+    bool ok() const { return m_status == Error::Ok; }
+    Error error() const { return m_status; }
+
+   private:
+    // Word at `src`, bytes past the end of the input read as zero
+    uint64_t load(std::byte const* src) const {
+        auto const end = m_data.data() + m_data.size();
+        if (end - src >= (ptrdiff_t)sizeof(uint64_t))
+            return loadWord(src, sizeof(uint64_t));
+        return loadWord(src, (size_t)(end - src));
+    }
 
     Error m_status = Error::Ok;
     BitPosition m_position = {0};
@@ -70,7 +165,6 @@ class WriteStream {
         m_status = err;
         return *this;
     }
-    bool writeBit(std::byte byte);
 
     Error m_status = Error::Ok;
     BitPosition m_position = {0};
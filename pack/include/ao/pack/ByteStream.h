@@ -16,6 +16,12 @@ class ReadStream {
     bool peek(std::span<std::byte> out, size_t count);
     ReadStream& require(bool condition, Error err);
 
+    // Loads up to the next 8 bytes into `out` as a little-endian word
+    // without consuming them, returns how many bytes are valid.
+    size_t peekWindow(uint64_t& out) const;
+    // Skips `count` bytes
+    ReadStream& advance(size_t count);
+
     size_t remainingBytes() const { return m_data.size() - m_position; }
     size_t position() const { return m_position; }
 
@@ -0,0 +1,65 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include <ao/pack/Error.h>
+
+namespace ao::pack::byte {
+// Write stream that builds its output as a chain of segments instead of one
+// contiguous buffer. bytes() calls of at least `referenceThreshold` bytes are
+// recorded by reference, smaller ones are copied into owned blocks. The chain
+// is written out with a single gather write per batch of segments.
+//
+// Referenced data is not copied, whatever the caller passed to bytes() has
+// to stay alive and unchanged until the chain is flushed or cleared.
+class ChainWriteStream {
+   public:
+    static constexpr size_t kDefaultReferenceThreshold = 16 * 1024;
+    static constexpr size_t kBlockSize = 16 * 1024;
+
+    explicit ChainWriteStream(
+        size_t referenceThreshold = kDefaultReferenceThreshold)
+        : m_referenceThreshold(referenceThreshold) {}
+
+    ChainWriteStream& bytes(std::span<std::byte const> data, size_t count);
+    ChainWriteStream& require(bool condition, Error err);
+
+    // Writes every segment to the file descriptor `fd` and clears the chain
+    ChainWriteStream& flush(int fd);
+    // Drops all segments and owned blocks, keeps the error state
+    void clear();
+
+    // Segments in output order, for callers with their own gather write
+    std::span<std::span<std::byte const> const> segments() const {
+        return m_segments;
+    }
+
+    size_t remainingBytes() const {
+        return std::numeric_limits<size_t>::max() - m_position;
+    }
+
+    bool ok() const { return m_status == Error::Ok; }
+    Error error() const { return m_status; }
+
+    // Bytes in the chain
+    size_t byteSize() const { return m_position; }
+
+   private:
+    ChainWriteStream& fail(Error err) {
+        m_status = err;
+        return *this;
+    }
+    void append(std::span<std::byte const> data);
+
+    Error m_status = Error::Ok;
+    size_t m_position = 0;
+    size_t m_referenceThreshold;
+    std::vector<std::span<std::byte const>> m_segments;
+    std::vector<std::unique_ptr<std::byte[]>> m_blocks;
+    size_t m_blockUsed = kBlockSize;
+};
+}  // namespace ao::pack::byte
@@ -0,0 +1,249 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include <ao/pack/Error.h>
+#include <ao/pack/Varint.h>
+
+namespace ao::pack::compress {
+// Block compression methods, the value is stored in every block header
+enum class Method : uint8_t {
+    Stored = 0,
+    // In-tree LZ77 codec with LZ4 style sequences, fast on both ends
+    Lz = 1,
+    // Only available when built with AO_PACK_ZSTD
+    Zstd = 2,
+};
+
+inline constexpr size_t kDefaultBlockSize = 64 * 1024;
+// Readers refuse blocks claiming more than this many bytes
+inline constexpr size_t kMaxBlockSize = 4 * 1024 * 1024;
+
+bool hasMethod(Method method);
+// Output buffer size compressBlock needs for `size` input bytes
+size_t maxCompressedSize(Method method, size_t size);
+// Compresses `in` into `out`, returns the compressed size or 0 on failure
+size_t compressBlock(Method method,
+                     std::span<std::byte const> in,
+                     std::span<std::byte> out);
+// Decompresses `in` into `out`, which must be exactly the original size.
+// Returns false on malformed input.
+bool decompressBlock(Method method,
+                     std::span<std::byte const> in,
+                     std::span<std::byte> out);
+}  // namespace ao::pack::compress
+
+namespace ao::pack {
+// Write stream that buffers bytes into blocks and writes each block
+// compressed to the inner stream as
+//   <method><raw size><stored size><stored bytes>
+// with both sizes as prefix ints. Blocks that do not shrink are stored as is.
+// flush() must be called once done to write the last partial block.
+template <class Stream>
+class CompressWriteStream {
+   public:
+    CompressWriteStream(Stream& inner,
+                        compress::Method method = compress::Method::Lz,
+                        size_t blockSize = compress::kDefaultBlockSize)
+        : m_inner(inner), m_method(method), m_blockSize(blockSize) {
+        if (!compress::hasMethod(method) || blockSize == 0 ||
+            blockSize > compress::kMaxBlockSize)
+            fail(Error::BadArg);
+        else
+            m_block.reserve(blockSize);
+    }
+
+    CompressWriteStream& bytes(std::span<std::byte const> data, size_t count) {
+        if (!ok())
+            return *this;
+        if (data.size() < count)
+            return fail(Error::BadArg);
+        while (count > 0) {
+            auto const take = std::min(count, m_blockSize - m_block.size());
+            m_block.insert(m_block.end(), data.begin(), data.begin() + take);
+            data = data.subspan(take);
+            count -= take;
+            m_position += take;
+            if (m_block.size() == m_blockSize && !writeBlock())
+                break;
+        }
+        return *this;
+    }
+    CompressWriteStream& require(bool condition, Error err) {
+        if (ok() && !condition)
+            fail(err);
+        return *this;
+    }
+    // Writes out the pending partial block
+    CompressWriteStream& flush() {
+        if (ok() && !m_block.empty())
+            writeBlock();
+        return *this;
+    }
+
+    size_t remainingBytes() const {
+        return std::numeric_limits<size_t>::max() - m_position;
+    }
+    // Uncompressed bytes written so far
+    size_t byteSize() const { return m_position; }
+    Stream& inner() { return m_inner; }
+
+    bool ok() const { return error() == Error::Ok; }
+    Error error() const {
+        return m_status != Error::Ok ? m_status : m_inner.error();
+    }
+
+   private:
+    CompressWriteStream& fail(Error err) {
+        m_status = err;
+        return *this;
+    }
+    bool writeBlock() {
+        auto method = m_method;
+        size_t size = 0;
+        if (method != compress::Method::Stored) {
+            m_scratch.resize(
+                compress::maxCompressedSize(method, m_block.size()));
+            size = compress::compressBlock(method, m_block, m_scratch);
+        }
+        std::span<std::byte const> stored = m_block;
+        if (size == 0 || size >= m_block.size())
+            method = compress::Method::Stored;
+        else
+            stored = std::span{m_scratch}.first(size);
+
+        auto const tag = (std::byte)method;
+        m_inner.bytes(std::span{&tag, 1}, 1);
+        encodePrefixInt(m_inner, m_block.size());
+        encodePrefixInt(m_inner, stored.size());
+        m_inner.bytes(stored, stored.size());
+        m_block.clear();
+        return ok();
+    }
+
+    Error m_status = Error::Ok;
+    Stream& m_inner;
+    compress::Method m_method;
+    size_t m_blockSize;
+    size_t m_position = 0;
+    std::vector<std::byte> m_block;
+    std::vector<std::byte> m_scratch;
+};
+
+// Read stream over blocks written by CompressWriteStream
+template <class Stream>
+class DecompressReadStream {
+   public:
+    DecompressReadStream(Stream& inner,
+                         size_t maxBlockSize = compress::kMaxBlockSize)
+        : m_inner(inner), m_maxBlockSize(maxBlockSize) {}
+
+    DecompressReadStream& bytes(std::span<std::byte> out, size_t count) {
+        if (!ok())
+            return *this;
+        if (out.size() < count)
+            return fail(Error::BadArg);
+        while (count > 0) {
+            if (m_offset == m_block.size() && !readBlock())
+                break;
+            auto const take = std::min(count, m_block.size() - m_offset);
+            std::copy_n(m_block.begin() + m_offset, take, out.begin());
+            out = out.subspan(take);
+            count -= take;
+            m_offset += take;
+            m_position += take;
+        }
+        return *this;
+    }
+    // Copies the next `count` bytes without consuming them, false if there
+    // are not that many left
+    bool peek(std::span<std::byte> out, size_t count) {
+        if (!ok() || out.size() < count)
+            return false;
+        while (m_block.size() - m_offset < count) {
+            if (m_inner.remainingBytes() == 0 || !readBlock())
+                return false;
+        }
+        std::copy_n(m_block.begin() + m_offset, count, out.begin());
+        return true;
+    }
+    DecompressReadStream& require(bool condition, Error err) {
+        if (ok() && !condition)
+            fail(err);
+        return *this;
+    }
+
+    // Exact within the current block, further blocks have unknown sizes so
+    // any data left in the inner stream reports as unbounded
+    size_t remainingBytes() const {
+        auto const buffered = m_block.size() - m_offset;
+        if (m_inner.remainingBytes() == 0)
+            return buffered;
+        return std::numeric_limits<size_t>::max();
+    }
+    // Uncompressed bytes read so far
+    size_t byteSize() const { return m_position; }
+    Stream& inner() { return m_inner; }
+
+    bool ok() const { return error() == Error::Ok; }
+    Error error() const {
+        return m_status != Error::Ok ? m_status : m_inner.error();
+    }
+
+   private:
+    DecompressReadStream& fail(Error err) {
+        m_status = err;
+        return *this;
+    }
+    // Appends the next block behind the unread bytes of the current one
+    bool readBlock() {
+        std::byte tag{};
+        uint64_t rawSize = 0;
+        uint64_t storedSize = 0;
+        if (m_inner.remainingBytes() == 0) {
+            fail(Error::Eof);
+            return false;
+        }
+        if (!m_inner.bytes(std::span{&tag, 1}, 1).ok() ||
+            !decodePrefixInt(m_inner, rawSize) ||
+            !decodePrefixInt(m_inner, storedSize))
+            return false;
+        auto const method = (compress::Method)tag;
+        if (rawSize == 0 || rawSize > m_maxBlockSize ||
+            storedSize > m_inner.remainingBytes() ||
+            (method == compress::Method::Stored && storedSize != rawSize) ||
+            !compress::hasMethod(method)) {
+            fail(Error::BadData);
+            return false;
+        }
+
+        m_block.erase(m_block.begin(), m_block.begin() + m_offset);
+        m_offset = 0;
+        auto const start = m_block.size();
+        m_block.resize(start + rawSize);
+        auto const block = std::span{m_block}.subspan(start);
+        if (method == compress::Method::Stored)
+            return m_inner.bytes(block, rawSize).ok();
+        m_scratch.resize(storedSize);
+        if (!m_inner.bytes(m_scratch, storedSize).ok())
+            return false;
+        if (!compress::decompressBlock(method, m_scratch, block)) {
+            fail(Error::BadData);
+            return false;
+        }
+        return true;
+    }
+
+    Error m_status = Error::Ok;
+    Stream& m_inner;
+    size_t m_maxBlockSize;
+    size_t m_position = 0;
+    size_t m_offset = 0;
+    std::vector<std::byte> m_block;
+    std::vector<std::byte> m_scratch;
+};
+}  // namespace ao::pack
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <span>
 #include <vector>
 
 #include <ao/pack/ByteStream.h>
@@ -10,8 +12,8 @@ namespace ao::pack::disk {
 Base disk format types
 
 FIXED (k) for k <= 8
-UVAR 
-SVAR 
+UVAR
+SVAR
 LEN <Repeated contents>
 
 TAG is message type
@@ -23,33 +25,95 @@ We are treating sub-messages as raw byte arrays effectively.
 Tags must be serialized in ascending order per message.
 Must be enforced during encoding and decoding to ensure hash stability in log.
 
-Envelope format for disk, each item must be COBS encoded on disk
-<Message Id> <Payload> <CRC32 of PAYLOAD>
+Envelope format for disk, each item is COBS encoded on disk and followed by
+a single zero byte
+<Message Id> <Payload> <CRC32C of Message Id and Payload>
+
+The message id is a prefix int and the CRC32C is stored little endian. COBS
+keeps zero bytes out of the record so a zero always ends one, a reader that
+hits a corrupted record drops it and picks up again after the next zero.
 */
 
+// CRC32C (Castagnoli). Passing the result of a previous call as `crc`
+// continues it, so crc32c(b, crc32c(a)) is the checksum of a followed by b.
+uint32_t crc32c(std::span<std::byte const> data, uint32_t crc = 0);
+
+// Worst case COBS size of `size` bytes, without the delimiter
+inline constexpr size_t cobsMaxEncodedSize(size_t size) {
+    return size + size / 254 + 1;
+}
+
+// Streams bytes into COBS blocks appended to `out`
+class CobsWriter {
+   public:
+    CobsWriter(std::vector<std::byte>& out) : m_out(out) { beginBlock(); }
+
+    void append(std::span<std::byte const> data);
+    // Closes the last block, the delimiter is left to the caller
+    void finish();
+
+   private:
+    void beginBlock() {
+        m_code = m_out.size();
+        m_out.push_back(std::byte{0});
+        m_run = 0;
+    }
+    void endBlock() { m_out[m_code] = std::byte(m_run + 1); }
+
+    std::vector<std::byte>& m_out;
+    size_t m_code = 0;
+    size_t m_run = 0;
+    // The previous block was a full 254 byte run without an implied zero
+    bool m_afterFull = false;
+};
+
+// Decodes one COBS record without its delimiter into `out`. Returns false if
+// the record holds a zero or a block runs past its end.
+bool cobsDecode(std::span<std::byte const> record, std::vector<std::byte>& out);
+
 struct EncoderContext {
+    // Framed records back to back, each ending with its delimiter
     std::vector<std::byte> data;
+    // Size of every record in `data` including the delimiter
     std::vector<uint32_t> sizes;
 };
 
 class Encoder {
    public:
-    Encoder(EncoderContext& ctx)
-        : m_ctx(ctx),
-          m_sizeStream(),
-          m_dataStream() {}
-
-    // TODO base class here with message
-    void encode() {
+    Encoder(EncoderContext& ctx) : m_ctx(ctx) {}
 
-    }
+    // Appends `payload` as one framed record of `messageId`
+    void encode(uint64_t messageId, std::span<std::byte const> payload);
 
    private:
     EncoderContext& m_ctx;
 };
 
+struct Record {
+    uint64_t messageId = 0;
+    // Valid until the next call to Decoder::next
+    std::span<std::byte const> payload;
+};
+
+// Reads framed records and skips over corrupted ones
 class Decoder {
    public:
+    Decoder(std::span<std::byte const> data) : m_data(data) {}
+
+    // Reads the next intact record, returns false once the data is used up.
+    // Records failing COBS, CRC or header checks are counted and skipped,
+    // a trailing record without its delimiter counts as corrupted.
+    bool next(Record& out);
+
+    size_t corruptRecords() const { return m_corrupt; }
+    size_t position() const { return m_position; }
+
    private:
-}
+    bool decodeRecord(std::span<std::byte const> record, Record& out);
+
+    std::span<std::byte const> m_data;
+    size_t m_position = 0;
+    size_t m_corrupt = 0;
+    std::vector<std::byte> m_buffer;
+};
 }  // namespace ao::pack::disk
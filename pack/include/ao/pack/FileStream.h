@@ -0,0 +1,160 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <memory>
+#include <new>
+#include <span>
+
+#include <ao/pack/Error.h>
+#include <ao/pack/Word.h>
+
+namespace ao::pack::byte {
+namespace detail {
+struct AlignedDelete {
+    void operator()(std::byte* ptr) const {
+        ::operator delete[](ptr, std::align_val_t{kAlignment});
+    }
+    static constexpr size_t kAlignment = 4096;
+};
+using AlignedBuffer = std::unique_ptr<std::byte[], AlignedDelete>;
+
+inline AlignedBuffer allocateAligned(size_t size) {
+    return AlignedBuffer{static_cast<std::byte*>(::operator new[](
+        size, std::align_val_t{AlignedDelete::kAlignment}))};
+}
+}  // namespace detail
+
+// Read stream over a file descriptor with a page aligned userspace buffer.
+// Reads that fit in the buffer are a memcpy, the descriptor is only read
+// when the buffer runs dry. remainingBytes() is based on the file size at
+// open, so this is meant for regular files.
+class FileReadStream {
+   public:
+    static constexpr size_t kDefaultBufferSize = 64 * 1024;
+
+    explicit FileReadStream(std::filesystem::path const& path,
+                            size_t bufferSize = kDefaultBufferSize);
+    ~FileReadStream();
+    FileReadStream(FileReadStream const&) = delete;
+    FileReadStream& operator=(FileReadStream const&) = delete;
+
+    FileReadStream& bytes(std::span<std::byte> out, size_t count) {
+        if (ok() && count <= out.size() && count <= buffered()) {
+            std::memcpy(out.data(), m_buffer.get() + m_begin, count);
+            m_begin += count;
+            return *this;
+        }
+        return readSlow(out, count);
+    }
+    // Copies the next `count` bytes without consuming them, `count` may not
+    // exceed the buffer size
+    bool peek(std::span<std::byte> out, size_t count);
+    FileReadStream& require(bool condition, Error err) {
+        if (ok() && !condition)
+            fail(err);
+        return *this;
+    }
+
+    // Loads up to the next 8 bytes as a little-endian word without consuming
+    // them, returns how many bytes are valid
+    size_t peekWindow(uint64_t& out) {
+        if (buffered() < sizeof(uint64_t) && ok())
+            fill(sizeof(uint64_t));
+        auto const size = ok() ? std::min(buffered(), sizeof(uint64_t)) : 0;
+        out = size == 0 ? 0 : loadWord(m_buffer.get() + m_begin, size);
+        return size;
+    }
+    FileReadStream& advance(size_t count);
+
+    size_t remainingBytes() const { return m_fileSize - position(); }
+    size_t position() const { return m_fileOffset - buffered(); }
+
+    bool ok() const { return m_status == Error::Ok; }
+    Error error() const { return m_status; }
+
+   private:
+    FileReadStream& fail(Error err) {
+        m_status = err;
+        return *this;
+    }
+    size_t buffered() const { return m_end - m_begin; }
+    FileReadStream& readSlow(std::span<std::byte> out, size_t count);
+    // Moves the unread bytes to the front and reads until at least `want`
+    // bytes are buffered or the file ends
+    void fill(size_t want);
+
+    Error m_status = Error::Ok;
+    int m_fd = -1;
+    detail::AlignedBuffer m_buffer;
+    size_t m_bufferSize;
+    size_t m_begin = 0;
+    size_t m_end = 0;
+    // Bytes read from the descriptor so far
+    size_t m_fileOffset = 0;
+    size_t m_fileSize = 0;
+};
+
+enum class FileWriteMode {
+    Truncate,
+    Append,
+};
+
+// Write stream over a file descriptor with a page aligned userspace buffer.
+// Small writes are a memcpy into the buffer, which goes to the descriptor
+// once full or on flush(). The destructor flushes too but cannot report
+// errors, call flush() to see them.
+class FileWriteStream {
+   public:
+    static constexpr size_t kDefaultBufferSize = 64 * 1024;
+
+    explicit FileWriteStream(std::filesystem::path const& path,
+                             FileWriteMode mode = FileWriteMode::Truncate,
+                             size_t bufferSize = kDefaultBufferSize);
+    ~FileWriteStream();
+    FileWriteStream(FileWriteStream const&) = delete;
+    FileWriteStream& operator=(FileWriteStream const&) = delete;
+
+    FileWriteStream& bytes(std::span<std::byte const> data, size_t count) {
+        if (ok() && count <= data.size() && count <= m_bufferSize - m_used) {
+            std::memcpy(m_buffer.get() + m_used, data.data(), count);
+            m_used += count;
+            m_position += count;
+            return *this;
+        }
+        return writeSlow(data, count);
+    }
+    FileWriteStream& require(bool condition, Error err) {
+        if (ok() && !condition)
+            fail(err);
+        return *this;
+    }
+    // Hands the buffered bytes to the descriptor
+    FileWriteStream& flush();
+
+    size_t remainingBytes() const {
+        return std::numeric_limits<size_t>::max() - m_position;
+    }
+    // Bytes written through this stream, buffered or not
+    size_t byteSize() const { return m_position; }
+
+    bool ok() const { return m_status == Error::Ok; }
+    Error error() const { return m_status; }
+
+   private:
+    FileWriteStream& fail(Error err) {
+        m_status = err;
+        return *this;
+    }
+    FileWriteStream& writeSlow(std::span<std::byte const> data, size_t count);
+
+    Error m_status = Error::Ok;
+    int m_fd = -1;
+    detail::AlignedBuffer m_buffer;
+    size_t m_bufferSize;
+    size_t m_used = 0;
+    size_t m_position = 0;
+};
+}  // namespace ao::pack::byte
@@ -1,9 +1,15 @@
 #pragma once
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <memory>
 #include <span>
 
 namespace ao::pack {
 
+// Size of the chunks HashingStream gathers small writes into by default
+inline constexpr size_t kHashChunkSize = 16 * 1024;
+
 // Hasher concept: requires update(ptr, len), digest() and reset()
 template <class H>
 concept HasherConcept = requires(H h, std::span<std::byte const> v) {
@@ -12,12 +18,26 @@ concept HasherConcept = requires(H h, std::span<std::byte const> v) {
     { h.reset() } -> std::same_as<void>;
 };
 
-// HashingStream: forwards to an underlying Stream but updates a running hash
+// HashingStream: forwards to an underlying Stream but updates a running hash.
+// Serializers hand over a few bytes at a time, these are gathered into
+// kChunkSize chunks before they reach the hasher, which does much better on
+// large inputs. Spans at least a chunk long go to the hasher directly.
+//
+// The chunk buffer is allocated on the first enableHashing() unless the
+// caller hands one in, in which case its size is the chunk size. Callers that
+// build a stream per record should keep one buffer and pass it every time.
 template <class Stream, HasherConcept Hasher>
 class HashingStream {
    public:
+    static constexpr size_t kChunkSize = kHashChunkSize;
+
     HashingStream(Stream& s, Hasher hasher = {})
         : m_hasher(std::move(hasher)), m_inner(s), m_enabled(false) {}
+    HashingStream(Stream& s, Hasher hasher, std::span<std::byte> pending)
+        : m_hasher(std::move(hasher)),
+          m_inner(s),
+          m_enabled(false),
+          m_pending(pending) {}
 
     // Forwarded ok() and require(...) used by serializers
     bool ok() const { return m_inner.ok(); }
@@ -34,15 +54,25 @@ class HashingStream {
         if (m_enabled && count > 0) {
             // construct a const span of the requested size
             auto const* dataPtr = span.data();
-            std::span<std::byte const> s((std::byte const*)dataPtr, count);
-            m_hasher.update(s);
+            hash(std::span<std::byte const>((std::byte const*)dataPtr, count));
         }
     }
 
-    // convenience
-    auto digest() const noexcept { return m_hasher.digest(); }
-    void disableHashing() noexcept { m_enabled = false; }
-    void enableHashing() noexcept {
+    // Hash of everything since enableHashing(), including pending bytes
+    auto digest() {
+        flushPending();
+        return m_hasher.digest();
+    }
+    void disableHashing() {
+        flushPending();
+        m_enabled = false;
+    }
+    void enableHashing() {
+        if (m_pending.empty()) {
+            m_owned = std::make_unique<std::byte[]>(kChunkSize);
+            m_pending = {m_owned.get(), kChunkSize};
+        }
+        m_pendingSize = 0;
         m_enabled = true;
         m_hasher.reset();
     }
@@ -50,9 +80,34 @@ class HashingStream {
     Stream& inner() noexcept { return m_inner; }
 
    private:
+    void hash(std::span<std::byte const> data) {
+        if (data.size() <= m_pending.size() - m_pendingSize) {
+            std::memcpy(m_pending.data() + m_pendingSize, data.data(),
+                        data.size());
+            m_pendingSize += data.size();
+            return;
+        }
+        flushPending();
+        if (data.size() >= m_pending.size()) {
+            m_hasher.update(data);
+            return;
+        }
+        std::memcpy(m_pending.data(), data.data(), data.size());
+        m_pendingSize = data.size();
+    }
+    void flushPending() {
+        if (m_pendingSize == 0)
+            return;
+        m_hasher.update(m_pending.first(m_pendingSize));
+        m_pendingSize = 0;
+    }
+
     Hasher m_hasher;
     Stream& m_inner;
     bool m_enabled;
+    std::span<std::byte> m_pending;
+    std::unique_ptr<std::byte[]> m_owned;
+    size_t m_pendingSize = 0;
 };
 
 }  // namespace ao::pack
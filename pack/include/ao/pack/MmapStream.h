@@ -0,0 +1,105 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+
+#include <ao/pack/ByteStream.h>
+#include <ao/pack/Error.h>
+
+namespace ao::pack {
+// How a mapping is going to be read, passed on to madvise. Only WillNeed
+// does anything on Windows.
+enum class AccessHint {
+    Normal,
+    Sequential,
+    Random,
+    WillNeed,
+};
+
+// Owns a read only mapping of a whole file. Empty files map to an empty span.
+class MappedFile {
+   public:
+    static std::shared_ptr<MappedFile const> open(
+        std::filesystem::path const& path);
+
+    MappedFile() = default;
+    MappedFile(MappedFile const&) = delete;
+    MappedFile& operator=(MappedFile const&) = delete;
+    ~MappedFile();
+
+    std::span<std::byte const> bytes() const {
+        return {static_cast<std::byte const*>(m_data), m_size};
+    }
+    // Hints the access pattern for the whole mapping
+    void advise(AccessHint hint) const;
+
+   private:
+#ifdef _WIN32
+    void* m_mapping = nullptr;
+#endif
+    void* m_data = nullptr;
+    size_t m_size = 0;
+};
+}  // namespace ao::pack
+
+namespace ao::pack::byte {
+// Read stream over a mapped file. Besides the ReadStream interface, view()
+// hands out spans straight into the mapping, they stay valid as long as the
+// mapping does, see file().
+class MmapReadStream {
+   public:
+    explicit MmapReadStream(std::filesystem::path const& path,
+                            AccessHint hint = AccessHint::Sequential)
+        : MmapReadStream(MappedFile::open(path)) {
+        if (m_file)
+            m_file->advise(hint);
+    }
+    explicit MmapReadStream(std::shared_ptr<MappedFile const> file)
+        : m_file(std::move(file)),
+          m_stream(m_file ? m_file->bytes() : std::span<std::byte const>{}) {
+        if (!m_file)
+            m_stream.require(false, Error::StreamError);
+    }
+
+    // Returns the next `count` bytes without copying and consumes them, an
+    // empty span and Eof if there are not that many left
+    std::span<std::byte const> view(size_t count) {
+        if (!ok())
+            return {};
+        auto const start = m_stream.position();
+        if (!m_stream.advance(count).ok())
+            return {};
+        return m_file->bytes().subspan(start, count);
+    }
+
+    MmapReadStream& bytes(std::span<std::byte> out, size_t count) {
+        m_stream.bytes(out, count);
+        return *this;
+    }
+    bool peek(std::span<std::byte> out, size_t count) {
+        return m_stream.peek(out, count);
+    }
+    MmapReadStream& require(bool condition, Error err) {
+        m_stream.require(condition, err);
+        return *this;
+    }
+    size_t peekWindow(uint64_t& out) const { return m_stream.peekWindow(out); }
+    MmapReadStream& advance(size_t count) {
+        m_stream.advance(count);
+        return *this;
+    }
+
+    size_t remainingBytes() const { return m_stream.remainingBytes(); }
+    size_t position() const { return m_stream.position(); }
+    std::shared_ptr<MappedFile const> const& file() const { return m_file; }
+
+    bool ok() const { return m_stream.ok(); }
+    Error error() const { return m_stream.error(); }
+
+   private:
+    std::shared_ptr<MappedFile const> m_file;
+    ReadStream m_stream;
+};
+}  // namespace ao::pack::byte
@@ -1,12 +1,15 @@
 #pragma once
 #include "ao/pack/Error.h"
+#include "ao/pack/Word.h"
 
+#include <algorithm>
 #include <array>
 #include <bit>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
 #include <span>
+#include <tuple>
 
 namespace ao::pack {
 template <class WriteStream>
@@ -49,30 +52,126 @@ bool decodeVarint(ReadStream& enc, uint64_t& result) {
     return enc.ok();
 }
 
-inline std::tuple<uint8_t, uint8_t, uint8_t> encodePrefixIntHeader(uint64_t v) {
-    uint8_t header = 0;
-
-    int64_t headerBits = 7;
-    uint64_t headerCapacity = 0x7F;
-    uint8_t extraBytes = 0;
-    uint64_t byteCapacity = 0;
-
-    while ((headerCapacity | (byteCapacity << headerBits)) < v) {
-        headerBits = std::max(headerBits - 1, 0LL);
-        headerCapacity >>= 1;
-        header >>= 1;
-        header |= 0x80;
-
-        ++extraBytes;
-        byteCapacity <<= 8;
-        byteCapacity |= 0xFF;
+namespace detail {
+inline constexpr uint64_t kVarintContinuation = 0x8080808080808080ull;
+
+// Packs the 7 payload bits of up to 8 varint bytes held little-endian in
+// `word` into one value, continuation bits must already be cleared
+inline uint64_t compactVarintWord(uint64_t word) {
+    word = ((word & 0x7f007f007f007f00ull) >> 1) |
+           (word & 0x007f007f007f007full);
+    word = ((word & 0x3fff00003fff0000ull) >> 2) |
+           (word & 0x00003fff00003fffull);
+    return ((word & 0x0fffffff00000000ull) >> 4) |
+           (word & 0x000000000fffffffull);
+}
+
+// Inverse of compactVarintWord for values below 2^56
+inline uint64_t spreadVarintWord(uint64_t v) {
+    v = ((v & 0x00fffffff0000000ull) << 4) | (v & 0x000000000fffffffull);
+    v = ((v & 0x0fffc0000fffc000ull) << 2) | (v & 0x00003fff00003fffull);
+    return ((v & 0x3f803f803f803f80ull) << 1) | (v & 0x007f007f007f007full);
+}
+}  // namespace detail
+
+// Encodes `values` back to back as varints. Values are spread into their
+// bytes a word at a time and handed to the stream in chunks.
+template <class WriteStream>
+bool encodeVarintBatch(WriteStream& enc, std::span<uint64_t const> values) {
+    constexpr size_t kChunkValues = 32;
+    // Every value may store a full word past its end, leave room for it
+    std::array<std::byte, kChunkValues * 10 + sizeof(uint64_t)> buffer;
+
+    while (!values.empty() && enc.ok()) {
+        auto const chunk = values.first(std::min(values.size(), kChunkValues));
+        size_t size = 0;
+        for (uint64_t v : chunk) {
+            if (v >= (1ull << 56)) {
+                do {
+                    auto byte = std::byte(v & 0x7f);
+                    v >>= 7;
+                    if (v != 0)
+                        byte |= std::byte(0x80);
+                    buffer[size++] = byte;
+                } while (v != 0);
+                continue;
+            }
+            size_t const length = std::max(
+                (size_t)(std::bit_width(v) + 6) / 7, size_t{1});
+            auto const word = detail::spreadVarintWord(v) |
+                              (detail::kVarintContinuation &
+                               maskBits((length - 1) * 8));
+            storeWord(buffer.data() + size, sizeof(word), word);
+            size += length;
+        }
+        enc.bytes(std::span<std::byte>{buffer}, size);
+        values = values.subspan(chunk.size());
+    }
+    return enc.ok();
+}
+
+// Decodes `out.size()` consecutive varints. Streams with a peek window
+// find every terminating byte in the next 8 bytes at once and decode all
+// varints ending there without further stream calls. Longer varints and
+// other streams fall back to decodeVarint.
+template <class ReadStream>
+bool decodeVarintBatch(ReadStream& enc, std::span<uint64_t> out) {
+    size_t idx = 0;
+    if constexpr (requires(uint64_t w) {
+                      enc.peekWindow(w);
+                      enc.advance(size_t{});
+                  }) {
+        while (idx < out.size() && enc.ok()) {
+            uint64_t window;
+            auto const available = enc.peekWindow(window);
+            uint64_t ends = ~window & detail::kVarintContinuation &
+                            maskBits(available * 8);
+            auto const payload = window & ~detail::kVarintContinuation;
+            size_t start = 0;
+            while (ends != 0 && idx < out.size()) {
+                size_t const end = std::countr_zero(ends) / 8 + 1;
+                out[idx++] = detail::compactVarintWord(
+                    (payload >> (start * 8)) & maskBits((end - start) * 8));
+                start = end;
+                ends &= ends - 1;
+            }
+            if (start != 0) {
+                enc.advance(start);
+                continue;
+            }
+            if (!decodeVarint(enc, out[idx++]))
+                return false;
+        }
+        return enc.ok();
+    }
+
+    for (; idx < out.size(); ++idx) {
+        if (!decodeVarint(enc, out[idx]))
+            return false;
+    }
+    return enc.ok();
+}
+
+// Extra bytes after the header byte, indexed by countl_zero of the value.
+// Each extra byte costs one header bit, so a prefix int holds 7 bits per
+// byte up to 56 bits and takes the full 8 extra bytes beyond that.
+inline constexpr auto kPrefixIntExtraBytes = [] {
+    std::array<uint8_t, 65> ret = {};
+    for (int lz = 0; lz <= 64; ++lz) {
+        int const width = std::max(64 - lz, 1);
+        ret[lz] = (uint8_t)std::min((width - 1) / 7, 8);
     }
+    return ret;
+}();
 
-    header |= (v & headerCapacity);
-    assert(headerBits <= std::numeric_limits<uint8_t>::max());
+inline std::tuple<uint8_t, uint8_t, uint8_t> encodePrefixIntHeader(uint64_t v) {
+    uint8_t const extraBytes = kPrefixIntExtraBytes[std::countl_zero(v)];
+    uint8_t const headerBits = extraBytes < 7 ? 7 - extraBytes : 0;
+    uint8_t const header = (uint8_t)((0xFF00u >> extraBytes) |
+                                     (v & ((1u << headerBits) - 1)));
     return {
         header,
-        static_cast<uint8_t>(headerBits),
+        headerBits,
         extraBytes,
     };
 }
@@ -88,34 +187,50 @@ inline std::tuple<uint8_t, uint8_t, uint64_t> decodePrefixIntHeader(
 
 template <class WriteStream>
 bool encodePrefixInt(WriteStream& enc, uint64_t v) {
-    auto [header, shift, extraBytes] = encodePrefixIntHeader(v);
+    auto const [header, shift, extraBytes] = encodePrefixIntHeader(v);
     v >>= shift;
-    auto rest = std::span<std::byte>{(std::byte*)&v, extraBytes};
 
-    std::array<std::byte, sizeof(v) * 8 / 7 + 1> buffer = {};
-    std::fill(buffer.begin(), buffer.end(), std::byte(0));
+    // Bit streams take anything up to 8 bytes as a single field
+    if constexpr (requires { enc.bits(v, size_t{}); }) {
+        if (extraBytes < sizeof(v))
+            return enc.bits(header | (v << 8), (extraBytes + 1) * 8).ok();
+    }
+
+    std::array<std::byte, sizeof(v) + 1> buffer;
     buffer[0] = (std::byte)header;
-    std::copy(rest.begin(), rest.end(), buffer.begin() + 1);
+    storeWord(buffer.data() + 1, sizeof(v), v);
     return enc.bytes(std::span<std::byte>{buffer}, extraBytes + 1).ok();
 }
 
 template <class ReadStream>
 bool decodePrefixInt(ReadStream& enc, uint64_t& out) {
+    // Streams with a peek window decode anything but the 8 extra byte form
+    // from one load, the rest goes through the checked path below
+    if constexpr (requires(uint64_t w) {
+                      enc.peekWindow(w);
+                      enc.advance(size_t{});
+                  }) {
+        uint64_t window;
+        auto const available = enc.peekWindow(window);
+        if (available > 0) {
+            auto const [extra, shift, base] =
+                decodePrefixIntHeader((uint8_t)window);
+            if ((size_t)extra < available) {
+                out = (((window >> 8) & maskBits(extra * 8)) << shift) | base;
+                return enc.advance(extra + 1).ok();
+            }
+        }
+    }
+
     std::byte prefix;
     if (!enc.bytes(std::span<std::byte>{&prefix, 1}, 1).ok())
         return false;
     auto const [extra, shift, base] = decodePrefixIntHeader((uint8_t)prefix);
 
-    uint64_t data;
-    static_assert(sizeof(data) >= 8 * sizeof(std::byte));
-    auto dataBuffer = std::span<std::byte>{(std::byte*)&data, extra};
-    if (!enc.bytes(dataBuffer, extra).ok())
+    std::array<std::byte, sizeof(out)> data;
+    if (!enc.bytes(std::span<std::byte>{data}, extra).ok())
         return false;
-
-    out = 0;
-    auto rest = std::span<std::byte>{(std::byte*)&out, sizeof(uint64_t)};
-    std::copy(dataBuffer.begin(), dataBuffer.end(), rest.begin());
-    out = ((out << shift) | base);
+    out = (loadWord(data.data(), extra) << shift) | base;
     return true;
 }
 
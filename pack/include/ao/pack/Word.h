@@ -0,0 +1,28 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace ao::pack {
+// Loads up to 8 bytes as a little-endian word, missing bytes read as zero
+inline uint64_t loadWord(std::byte const* src, size_t size) {
+    uint64_t ret = 0;
+    std::memcpy(&ret, src, std::min(size, sizeof(ret)));
+    if constexpr (std::endian::native == std::endian::big)
+        ret = std::byteswap(ret);
+    return ret;
+}
+
+// Stores the low `size` bytes of `word` in little-endian order
+inline void storeWord(std::byte* dst, size_t size, uint64_t word) {
+    if constexpr (std::endian::native == std::endian::big)
+        word = std::byteswap(word);
+    std::memcpy(dst, &word, std::min(size, sizeof(word)));
+}
+
+inline uint64_t maskBits(size_t count) {
+    return count >= 64 ? ~uint64_t{0} : (uint64_t{1} << count) - 1;
+}
+}  // namespace ao::pack
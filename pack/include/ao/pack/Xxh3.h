@@ -0,0 +1,42 @@
+#pragma once
+
+#include <array>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace ao::pack::xxh3 {
+// XXH3 128 bit variant with the default secret and a zero seed, matching
+// XXH3_128bits() from the reference xxHash. Not cryptographic, this is for
+// catching corruption.
+struct Hash128 {
+    uint64_t low = 0;
+    uint64_t high = 0;
+
+    auto operator<=>(Hash128 const& other) const = default;
+};
+
+Hash128 hash128(std::span<std::byte const> data);
+
+// Streaming form of hash128(), any split of the input gives the same digest
+class Hasher128 {
+   public:
+    Hasher128() { reset(); }
+
+    void update(std::span<std::byte const> data);
+    Hash128 digest() const;
+    void reset();
+
+   private:
+    static constexpr size_t kBufferSize = 256;
+
+    std::array<uint64_t, 8> m_acc;
+    // Holds the whole input while it is short, afterwards the unconsumed
+    // tail, the last consumed stripe stays at the end for digest()
+    std::array<std::byte, kBufferSize> m_buffer;
+    size_t m_buffered;
+    size_t m_stripesSoFar;
+    uint64_t m_totalSize;
+};
+}  // namespace ao::pack::xxh3
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <span>
 
 namespace ao::pack {
 inline uint64_t encodeZigZag(int64_t n) {
@@ -11,4 +13,44 @@ inline int64_t decodeZigZag(uint64_t n) {
            (static_cast<int64_t>(-(static_cast<int64_t>(n) & 1)));
 }
 
+// Differences wrap, so unsigned values round trip through a signed delta
+inline uint64_t encodeZigZagDelta(uint64_t previous, uint64_t value) {
+    return encodeZigZag(static_cast<int64_t>(value - previous));
+}
+
+/**
+ * @brief Turns zigzag deltas into values in place, returns the last value.
+ *
+ * The zigzag pass has no dependencies between elements. The prefix sum is
+ * done in blocks of four with a log step scan, so only one add per block sits
+ * on the carried dependency chain.
+ */
+inline uint64_t decodeZigZagDeltas(std::span<uint64_t> values,
+                                   uint64_t previous = 0) {
+    for (auto& v : values)
+        v = static_cast<uint64_t>(decodeZigZag(v));
+
+    size_t i = 0;
+    for (; i + 4 <= values.size(); i += 4) {
+        uint64_t a = values[i];
+        uint64_t b = values[i + 1];
+        uint64_t c = values[i + 2];
+        uint64_t d = values[i + 3];
+        b += a;
+        d += c;
+        c += b;
+        d += b;
+        values[i] = previous + a;
+        values[i + 1] = previous + b;
+        values[i + 2] = previous + c;
+        values[i + 3] = previous + d;
+        previous = values[i + 3];
+    }
+    for (; i < values.size(); ++i) {
+        previous += values[i];
+        values[i] = previous;
+    }
+    return previous;
+}
+
 }  // namespace ao::pack
@@ -1,4 +1,5 @@
 #include <ao/pack/BitStream.h>
+#include <ao/pack/Word.h>
 
 #include <limits>
 #include <algorithm>  // for std::copy and std::min
@@ -21,42 +22,18 @@ ReadStream& ReadStream::bits(uint64_t& out, size_t count) {
     if (count > 64)
         return fail(Error::BadArg);
 
-    out = 0;
-    size_t produced = 0;
-
-    if (m_position.bitIndex() != 0 && count > 0) {
-        auto const toAlign = 8 - m_position.bitIndex();
-        auto const take = std::min(count, toAlign);
-
-        std::byte b;
-        for (size_t i = 0; i < take; ++i) {
-            if (!readBit(b))
-                return *this;
-            out |= ((uint64_t)b << produced);
-            ++produced;
+    if (count > m_windowBits) {
+        if (remainingBits() < count) {
+            out = 0;
+            return fail(Error::Eof);
         }
-
-        count -= take;
+        refill();
     }
 
-    while (ok() && count >= 8) {
-        std::byte data;
-        std::span<std::byte> b = {&data, 1};
-        bytes(b, 1);
-        if (!ok())
-            return *this;
-        out |= ((uint64_t)b[0] << produced);
-        produced += 8;
-        count -= 8;
-    }
-
-    for (size_t i = 0; i < count; ++i) {
-        std::byte b;
-        if (!readBit(b))
-            return *this;
-        out |= ((uint64_t)b << produced);
-        ++produced;
-    }
+    out = m_window & maskBits(count);
+    m_window = count >= 64 ? 0 : m_window >> count;
+    m_windowBits -= count;
+    m_position.bitPos += count;
     return *this;
 }
 
@@ -76,6 +53,8 @@ ReadStream& ReadStream::bytes(std::span<std::byte> out, size_t count) {
     if (startByte + requiredSrc > m_data.size())
         return fail(Error::Eof);
 
+    m_windowBits = 0;
+
     // Aligned fast-path: copy directly into caller buffer.
     if (startBit == 0) {
         auto src = m_data.subspan(startByte, count);
@@ -118,6 +97,39 @@ ReadStream& ReadStream::bytes(std::span<std::byte> out, size_t count) {
     return *this;
 }
 
+size_t ReadStream::peekWindow(uint64_t& out) {
+    if (!ok())
+        return 0;
+    if (m_windowBits < 64 && m_windowBits < remainingBits())
+        refill();
+    out = m_window;
+    return m_windowBits / 8;
+}
+
+ReadStream& ReadStream::advance(size_t count) {
+    if (!ok())
+        return *this;
+    if (count * 8 <= m_windowBits) {
+        uint64_t skip;
+        return bits(skip, count * 8);
+    }
+    if (remainingBytes() < count)
+        return fail(Error::Eof);
+    m_position.bitPos += count * 8;
+    m_windowBits = 0;
+    return *this;
+}
+
+ReadStream& ReadStream::seek(BitPosition position) {
+    if (!ok())
+        return *this;
+    if (position.bitPos > m_data.size() * 8)
+        return fail(Error::Eof);
+    m_position = position;
+    m_windowBits = 0;
+    return *this;
+}
+
 ReadStream& ReadStream::require(bool condition, Error err) {
     if (!ok())
         return *this;
@@ -132,17 +144,19 @@ size_t ReadStream::remainingBits() const {
     return (m_data.size() * 8) - m_position.bitPos;
 }
 
-bool ReadStream::readBit(std::byte& out) {
-    if (!ok())
-        return false;
-    if (m_position.byteIndex() >= m_data.size()) {
-        fail(Error::Eof);
-        return false;
+void ReadStream::refill() {
+    auto const shift = m_position.bitIndex();
+    auto const src = m_data.subspan(m_position.byteIndex());
+    auto const wordBytes = std::min(src.size(), sizeof(uint64_t));
+
+    m_window = loadWord(src.data(), wordBytes) >> shift;
+    m_windowBits = wordBytes * 8 - shift;
+    // Top up the bits shifted out above from the next byte so an unaligned
+    // 64 bit field is still served from the window
+    if (shift != 0 && src.size() > sizeof(uint64_t)) {
+        m_window |= uint64_t(src[sizeof(uint64_t)]) << (64 - shift);
+        m_windowBits = 64;
     }
-    out = ((m_data[m_position.byteIndex()] >> m_position.bitIndex()) &
-           std::byte{1});
-    ++m_position.bitPos;
-    return true;
 }
 
 WriteStream& WriteStream::align() {
@@ -151,10 +165,7 @@ WriteStream& WriteStream::align() {
 
     if (m_position.bitIndex() == 0)
         return *this;
-    auto const toAdvance = 8 - m_position.bitIndex();
-    for (size_t i = 0; i < toAdvance; ++i)
-        writeBit(std::byte{0});
-    return *this;
+    return bits(0, 8 - m_position.bitIndex());
 }
 
 WriteStream& WriteStream::bits(uint64_t v, size_t count) {
@@ -162,30 +173,31 @@ WriteStream& WriteStream::bits(uint64_t v, size_t count) {
         return *this;
     if (count > 64)
         return fail(Error::BadArg);
+    if (count == 0)
+        return *this;
+    if (remainingBits() < count)
+        return fail(Error::Overflow);
 
-    while (m_position.bitIndex() != 0 && count > 0) {
-        if (!writeBit(std::byte{v & 1}))
-            return *this;
-        v >>= 1;
-        --count;
-    }
-
-    while (count >= 8) {
-        auto b = std::byte{v & 0xFF};
-        bytes({&b, 1}, 1);
-        if (!ok())
-            return *this;
-        count -= 8;
-        v >>= 8;
-    }
-
-    while (count > 0) {
-        if (!writeBit(std::byte{v & 1}))
-            return *this;
-        v >>= 1;
-        --count;
+    // Merge into the little-endian word at the current byte, the bits past
+    // the end of the field keep whatever the buffer held before.
+    auto const shift = m_position.bitIndex();
+    auto const mask = maskBits(count);
+    v &= mask;
+
+    auto word = m_buffer.subspan(m_position.byteIndex());
+    auto const wordBytes = std::min(word.size(), sizeof(uint64_t));
+    auto const cur = loadWord(word.data(), wordBytes);
+    storeWord(word.data(), wordBytes,
+              (cur & ~(mask << shift)) | (v << shift));
+
+    // A 64 bit field starting mid byte spills into a ninth byte
+    if (shift + count > 64) {
+        auto const spill = 64 - shift;
+        auto& last = word[sizeof(uint64_t)];
+        last = (last & ~std::byte(mask >> spill)) | std::byte(v >> spill);
     }
 
+    m_position.bitPos += count;
     return *this;
 }
 WriteStream& WriteStream::bytes(std::span<std::byte> out, size_t count) {
@@ -297,20 +309,6 @@ size_t WriteStream::byteSize() const {
     return m_position.byteIndex() + 1;
 }
 
-bool WriteStream::writeBit(std::byte byte) {
-    if (!ok())
-        return false;
-    auto idx = m_position.byteIndex();
-    if (idx >= m_buffer.size()) {
-        fail(Error::Overflow);
-        return false;
-    }
-    m_buffer[idx] &= ~std::byte(1 << m_position.bitIndex());
-    m_buffer[idx] |= ((byte & std::byte(1)) << m_position.bitIndex());
-    m_position.bitPos += 1;
-    return true;
-}
-
 SizeWriteStream& SizeWriteStream::align() {
     if (!ok())
         return *this;
@@ -323,35 +321,14 @@ SizeWriteStream& SizeWriteStream::align() {
     return *this;
 }
 
-SizeWriteStream& SizeWriteStream::bits(uint64_t v, size_t count) {
+SizeWriteStream& SizeWriteStream::bits(uint64_t /*v*/, size_t count) {
     if (!ok())
         return *this;
     if (count > 64)
         return fail(Error::BadArg);
-
-    while (m_position.bitIndex() != 0 && count > 0) {
-        if (!writeBit(std::byte{v & 1}))
-            return *this;
-        v >>= 1;
-        --count;
-    }
-
-    while (count >= 8) {
-        auto b = std::byte{v & 0xFF};
-        bytes({&b, 1}, 1);
-        if (!ok())
-            return *this;
-        count -= 8;
-        v >>= 8;
-    }
-
-    while (count > 0) {
-        if (!writeBit(std::byte{v & 1}))
-            return *this;
-        v >>= 1;
-        --count;
-    }
-
+    if (remainingBits() < count)
+        return fail(Error::Overflow);
+    m_position.bitPos += count;
     return *this;
 }
 SizeWriteStream& SizeWriteStream::bytes(std::span<std::byte> out,
@@ -1,4 +1,5 @@
 #include <ao/pack/ByteStream.h>
+#include <ao/pack/Word.h>
 
 #include <algorithm>
 #include <limits>
@@ -26,6 +27,24 @@ bool ReadStream::peek(std::span<std::byte> out, size_t count) {
     std::copy(src.begin(), src.end(), out.begin());
     return true;
 }
+
+size_t ReadStream::peekWindow(uint64_t& out) const {
+    if (!ok())
+        return 0;
+    auto const size = std::min(remainingBytes(), sizeof(uint64_t));
+    out = size == 0 ? 0 : loadWord(m_data.data() + m_position, size);
+    return size;
+}
+
+ReadStream& ReadStream::advance(size_t count) {
+    if (!ok())
+        return *this;
+    if (remainingBytes() < count)
+        return fail(Error::Eof);
+    m_position += count;
+    return *this;
+}
+
 ReadStream& ReadStream::require(bool condition, Error err) {
     if (!ok())
         return *this;
@@ -0,0 +1,135 @@
+#include <ao/pack/ChainStream.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <limits.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace ao::pack::byte {
+namespace {
+#if defined(_WIN32)
+// No gather write for CRT descriptors, segments go out one by one
+bool writeSegments(int fd, std::span<std::span<std::byte const> const> segs) {
+    for (auto segment : segs) {
+        while (!segment.empty()) {
+            auto const size = (unsigned)std::min<size_t>(segment.size(),
+                                                         1u << 30);
+            auto const written = _write(fd, segment.data(), size);
+            if (written < 0)
+                return false;
+            segment = segment.subspan((size_t)written);
+        }
+    }
+    return true;
+}
+#else
+bool writeSegments(int fd, std::span<std::span<std::byte const> const> segs) {
+    constexpr size_t kMaxBatch = IOV_MAX < 1024 ? IOV_MAX : 1024;
+    iovec iov[kMaxBatch];
+    size_t next = 0;
+    // Bytes of segments[next] already written by a partial write
+    size_t skip = 0;
+    while (next < segs.size()) {
+        auto const count = std::min(kMaxBatch, segs.size() - next);
+        for (size_t i = 0; i < count; ++i) {
+            auto const segment = segs[next + i].subspan(i == 0 ? skip : 0);
+            iov[i] = {
+                .iov_base = const_cast<std::byte*>(segment.data()),
+                .iov_len = segment.size(),
+            };
+        }
+        auto written = ::writev(fd, iov, (int)count);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        // Step over the fully written segments, keep the offset into the
+        // first one that was cut short
+        for (size_t i = 0; i < count; ++i) {
+            if ((size_t)written < iov[i].iov_len) {
+                skip += (size_t)written;
+                break;
+            }
+            written -= (ssize_t)iov[i].iov_len;
+            next += 1;
+            skip = 0;
+        }
+    }
+    return true;
+}
+#endif
+}  // namespace
+
+ChainWriteStream& ChainWriteStream::bytes(std::span<std::byte const> data,
+                                          size_t count) {
+    if (!ok())
+        return *this;
+    if (count == 0)
+        return *this;
+    if (data.size() < count)
+        return fail(Error::BadArg);
+
+    data = data.first(count);
+    if (count >= m_referenceThreshold)
+        m_segments.push_back(data);
+    else
+        append(data);
+    m_position += count;
+    return *this;
+}
+
+ChainWriteStream& ChainWriteStream::require(bool condition, Error err) {
+    if (!ok())
+        return *this;
+    if (!condition)
+        m_status = err;
+    return *this;
+}
+
+ChainWriteStream& ChainWriteStream::flush(int fd) {
+    if (!ok())
+        return *this;
+    if (!writeSegments(fd, m_segments))
+        return fail(Error::StreamError);
+    clear();
+    return *this;
+}
+
+void ChainWriteStream::clear() {
+    m_segments.clear();
+    m_blocks.clear();
+    m_blockUsed = kBlockSize;
+    m_position = 0;
+}
+
+void ChainWriteStream::append(std::span<std::byte const> data) {
+    while (!data.empty()) {
+        if (m_blockUsed == kBlockSize) {
+            m_blocks.push_back(std::make_unique<std::byte[]>(kBlockSize));
+            m_blockUsed = 0;
+        }
+        auto const take = std::min(data.size(), kBlockSize - m_blockUsed);
+        auto* dst = m_blocks.back().get() + m_blockUsed;
+        std::memcpy(dst, data.data(), take);
+        m_blockUsed += take;
+        data = data.subspan(take);
+
+        // Copies that follow each other in a block share one segment
+        if (!m_segments.empty() &&
+            m_segments.back().data() + m_segments.back().size() == dst) {
+            auto& last = m_segments.back();
+            last = {last.data(), last.size() + take};
+        } else {
+            m_segments.push_back({dst, take});
+        }
+    }
+}
+}  // namespace ao::pack::byte
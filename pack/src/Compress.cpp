@@ -0,0 +1,249 @@
+#include <ao/pack/CompressStream.h>
+#include <ao/pack/Word.h>
+
+#include <array>
+#include <bit>
+#include <cstring>
+
+#ifndef AO_PACK_HAS_ZSTD
+#define AO_PACK_HAS_ZSTD 0
+#endif
+#if AO_PACK_HAS_ZSTD
+#include <zstd.h>
+#endif
+
+namespace ao::pack::compress {
+namespace {
+// Sequences are a token with 4 bit literal and match lengths, extra length
+// bytes when a nibble is 15, the literals and a 2 byte match offset. The last
+// sequence of a block only carries literals.
+constexpr size_t kMinMatch = 4;
+constexpr size_t kMaxOffset = 0xffff;
+constexpr size_t kHashBits = 12;
+// Misses before the match search starts skipping ahead, this keeps
+// incompressible input cheap
+constexpr size_t kSkipTrigger = 6;
+
+uint32_t hashSequence(uint32_t v) {
+    return (v * 2654435761u) >> (32 - kHashBits);
+}
+uint32_t load32(std::byte const* p) {
+    return (uint32_t)loadWord(p, sizeof(uint32_t));
+}
+
+std::byte* writeLength(std::byte* out, size_t length) {
+    for (; length >= 255; length -= 255)
+        *out++ = std::byte{255};
+    *out++ = (std::byte)length;
+    return out;
+}
+std::byte* writeSequence(std::byte* out,
+                         std::span<std::byte const> literals,
+                         size_t offset,
+                         size_t matchLength) {
+    auto const literalLength = literals.size();
+    auto const matchCode = matchLength - kMinMatch;
+    auto* token = out++;
+    *token = (std::byte)((std::min<size_t>(literalLength, 15) << 4) |
+                         std::min<size_t>(matchCode, 15));
+    if (literalLength >= 15)
+        out = writeLength(out, literalLength - 15);
+    std::memcpy(out, literals.data(), literalLength);
+    out += literalLength;
+    storeWord(out, 2, offset);
+    out += 2;
+    if (matchCode >= 15)
+        out = writeLength(out, matchCode - 15);
+    return out;
+}
+
+// Length of the common prefix of `a` and `b`, `b` being the later position
+size_t matchLength(std::byte const* a, std::byte const* b, size_t limit) {
+    size_t length = 0;
+    for (; length + 8 <= limit; length += 8) {
+        auto const diff = loadWord(a + length, 8) ^ loadWord(b + length, 8);
+        if (diff != 0)
+            return length + std::countr_zero(diff) / 8;
+    }
+    while (length < limit && a[length] == b[length])
+        ++length;
+    return length;
+}
+
+size_t lzMaxCompressedSize(size_t size) {
+    return size + size / 255 + 16;
+}
+
+size_t lzCompress(std::span<std::byte const> in, std::span<std::byte> out) {
+    if (out.size() < lzMaxCompressedSize(in.size()))
+        return 0;
+    std::array<uint32_t, size_t{1} << kHashBits> table{};
+    auto const* src = in.data();
+    auto* dst = out.data();
+    size_t anchor = 0;
+    size_t pos = 0;
+    size_t misses = 0;
+    while (pos + kMinMatch <= in.size()) {
+        auto const sequence = load32(src + pos);
+        auto& slot = table[hashSequence(sequence)];
+        size_t const candidate = slot;
+        slot = (uint32_t)pos;
+        if (candidate >= pos || pos - candidate > kMaxOffset ||
+            load32(src + candidate) != sequence) {
+            pos += 1 + (misses++ >> kSkipTrigger);
+            continue;
+        }
+        auto const length =
+            kMinMatch + matchLength(src + candidate + kMinMatch,
+                                    src + pos + kMinMatch,
+                                    in.size() - pos - kMinMatch);
+        dst = writeSequence(dst, in.subspan(anchor, pos - anchor),
+                            pos - candidate, length);
+        pos += length;
+        anchor = pos;
+        misses = 0;
+    }
+
+    auto const literals = in.subspan(anchor);
+    *dst = (std::byte)(std::min<size_t>(literals.size(), 15) << 4);
+    ++dst;
+    if (literals.size() >= 15)
+        dst = writeLength(dst, literals.size() - 15);
+    if (!literals.empty())
+        std::memcpy(dst, literals.data(), literals.size());
+    dst += literals.size();
+    return (size_t)(dst - out.data());
+}
+
+bool readLength(std::span<std::byte const> in, size_t& pos, size_t& length) {
+    std::byte b;
+    do {
+        if (pos == in.size())
+            return false;
+        b = in[pos++];
+        length += (size_t)b;
+    } while (b == std::byte{255});
+    return true;
+}
+
+bool lzDecompress(std::span<std::byte const> in, std::span<std::byte> out) {
+    size_t pos = 0;
+    size_t written = 0;
+    while (pos < in.size()) {
+        auto const token = (uint8_t)in[pos++];
+        size_t literalLength = token >> 4;
+        if (literalLength == 15 && !readLength(in, pos, literalLength))
+            return false;
+        if (literalLength > in.size() - pos ||
+            literalLength > out.size() - written)
+            return false;
+        if (literalLength != 0)
+            std::memcpy(out.data() + written, in.data() + pos,
+                        literalLength);
+        pos += literalLength;
+        written += literalLength;
+        if (pos == in.size())
+            break;
+
+        if (in.size() - pos < 2)
+            return false;
+        auto const offset = (size_t)loadWord(in.data() + pos, 2);
+        pos += 2;
+        size_t length = token & 0xf;
+        if (length == 15 && !readLength(in, pos, length))
+            return false;
+        length += kMinMatch;
+        if (offset == 0 || offset > written || length > out.size() - written)
+            return false;
+        auto* dst = out.data() + written;
+        auto const* match = dst - offset;
+        if (offset >= length) {
+            std::memcpy(dst, match, length);
+        } else {
+            // Overlapping matches repeat the last `offset` bytes
+            for (size_t i = 0; i < length; ++i)
+                dst[i] = match[i];
+        }
+        written += length;
+    }
+    return written == out.size();
+}
+}  // namespace
+
+bool hasMethod(Method method) {
+    switch (method) {
+        case Method::Stored:
+        case Method::Lz:
+            return true;
+        case Method::Zstd:
+            return AO_PACK_HAS_ZSTD;
+    }
+    return false;
+}
+
+size_t maxCompressedSize(Method method, size_t size) {
+    switch (method) {
+        case Method::Stored:
+            return size;
+        case Method::Lz:
+            return lzMaxCompressedSize(size);
+        case Method::Zstd:
+#if AO_PACK_HAS_ZSTD
+            return ZSTD_compressBound(size);
+#else
+            return 0;
+#endif
+    }
+    return 0;
+}
+
+size_t compressBlock(Method method,
+                     std::span<std::byte const> in,
+                     std::span<std::byte> out) {
+    switch (method) {
+        case Method::Stored:
+            if (out.size() < in.size())
+                return 0;
+            if (!in.empty())
+                std::memcpy(out.data(), in.data(), in.size());
+            return in.size();
+        case Method::Lz:
+            return lzCompress(in, out);
+        case Method::Zstd: {
+#if AO_PACK_HAS_ZSTD
+            auto const size = ZSTD_compress(out.data(), out.size(), in.data(),
+                                            in.size(), ZSTD_CLEVEL_DEFAULT);
+            return ZSTD_isError(size) ? 0 : size;
+#else
+            return 0;
+#endif
+        }
+    }
+    return 0;
+}
+
+bool decompressBlock(Method method,
+                     std::span<std::byte const> in,
+                     std::span<std::byte> out) {
+    switch (method) {
+        case Method::Stored:
+            if (in.size() != out.size())
+                return false;
+            if (!in.empty())
+                std::memcpy(out.data(), in.data(), in.size());
+            return true;
+        case Method::Lz:
+            return lzDecompress(in, out);
+        case Method::Zstd: {
+#if AO_PACK_HAS_ZSTD
+            auto const size = ZSTD_decompress(out.data(), out.size(),
+                                              in.data(), in.size());
+            return !ZSTD_isError(size) && size == out.size();
+#else
+            return false;
+#endif
+        }
+    }
+    return false;
+}
+}  // namespace ao::pack::compress
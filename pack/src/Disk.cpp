@@ -0,0 +1,221 @@
+#include <ao/pack/Disk.h>
+#include <ao/pack/Varint.h>
+#include <ao/pack/Word.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <nmmintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define AO_CRC32C_TARGET
+#else
+#define AO_CRC32C_TARGET __attribute__((target("sse4.2")))
+#endif
+#define AO_CRC32C_X86 1
+#elif defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define AO_CRC32C_ARM 1
+#endif
+
+namespace ao::pack::disk {
+namespace {
+// Reflected Castagnoli polynomial
+constexpr uint32_t kCrc32cPoly = 0x82f63b78;
+
+// Slicing by 8 tables, table k advances a byte through k further zero bytes
+constexpr auto kCrc32cTables = [] {
+    std::array<std::array<uint32_t, 256>, 8> tables{};
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; ++bit)
+            crc = (crc >> 1) ^ ((crc & 1) ? kCrc32cPoly : 0);
+        tables[0][i] = crc;
+    }
+    for (size_t k = 1; k < tables.size(); ++k) {
+        for (size_t i = 0; i < 256; ++i) {
+            auto const prev = tables[k - 1][i];
+            tables[k][i] = (prev >> 8) ^ tables[0][prev & 0xff];
+        }
+    }
+    return tables;
+}();
+
+uint32_t crc32cSoftware(std::byte const* data, size_t size, uint32_t crc) {
+    auto const& t = kCrc32cTables;
+    for (; size >= 8; data += 8, size -= 8) {
+        auto const w = loadWord(data, 8) ^ crc;
+        crc = t[7][w & 0xff] ^ t[6][(w >> 8) & 0xff] ^
+              t[5][(w >> 16) & 0xff] ^ t[4][(w >> 24) & 0xff] ^
+              t[3][(w >> 32) & 0xff] ^ t[2][(w >> 40) & 0xff] ^
+              t[1][(w >> 48) & 0xff] ^ t[0][w >> 56];
+    }
+    for (; size > 0; ++data, --size)
+        crc = (crc >> 8) ^ t[0][(crc ^ (uint8_t)*data) & 0xff];
+    return crc;
+}
+
+#if defined(AO_CRC32C_X86)
+AO_CRC32C_TARGET uint32_t crc32cHardware(std::byte const* data,
+                                         size_t size,
+                                         uint32_t crc) {
+    uint64_t crc64 = crc;
+    for (; size >= 8; data += 8, size -= 8)
+        crc64 = _mm_crc32_u64(crc64, loadWord(data, 8));
+    crc = (uint32_t)crc64;
+    for (; size > 0; ++data, --size)
+        crc = _mm_crc32_u8(crc, (uint8_t)*data);
+    return crc;
+}
+
+bool hasHardwareCrc32c() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 20)) != 0;
+#else
+    return __builtin_cpu_supports("sse4.2");
+#endif
+}
+#elif defined(AO_CRC32C_ARM)
+uint32_t crc32cHardware(std::byte const* data, size_t size, uint32_t crc) {
+    for (; size >= 8; data += 8, size -= 8)
+        crc = __crc32cd(crc, loadWord(data, 8));
+    for (; size > 0; ++data, --size)
+        crc = __crc32cb(crc, (uint8_t)*data);
+    return crc;
+}
+
+bool hasHardwareCrc32c() {
+    return true;
+}
+#endif
+}  // namespace
+
+uint32_t crc32c(std::span<std::byte const> data, uint32_t crc) {
+    crc = ~crc;
+#if defined(AO_CRC32C_X86) || defined(AO_CRC32C_ARM)
+    static bool const hardware = hasHardwareCrc32c();
+    if (hardware)
+        return ~crc32cHardware(data.data(), data.size(), crc);
+#endif
+    return ~crc32cSoftware(data.data(), data.size(), crc);
+}
+
+void CobsWriter::append(std::span<std::byte const> data) {
+    // Runs between zeros are found with memchr and copied in one go
+    while (!data.empty()) {
+        auto const room = std::min(254 - m_run, data.size());
+        auto const zero =
+            static_cast<std::byte const*>(std::memchr(data.data(), 0, room));
+        auto const run = zero ? (size_t)(zero - data.data()) : room;
+        m_out.insert(m_out.end(), data.begin(), data.begin() + run);
+        m_run += run;
+        if (zero) {
+            endBlock();
+            beginBlock();
+            m_afterFull = false;
+            data = data.subspan(run + 1);
+        } else {
+            data = data.subspan(run);
+            if (m_run == 254) {
+                endBlock();
+                beginBlock();
+                m_afterFull = true;
+            }
+        }
+    }
+}
+
+void CobsWriter::finish() {
+    // Data ending on a full block needs no trailing empty block
+    if (m_run == 0 && m_afterFull)
+        m_out.pop_back();
+    else
+        endBlock();
+}
+
+bool cobsDecode(std::span<std::byte const> record,
+                std::vector<std::byte>& out) {
+    out.clear();
+    out.reserve(record.size());
+    size_t pos = 0;
+    while (pos < record.size()) {
+        auto const code = (size_t)record[pos];
+        if (code == 0 || code > record.size() - pos)
+            return false;
+        auto const block = record.subspan(pos + 1, code - 1);
+        if (std::memchr(block.data(), 0, block.size()))
+            return false;
+        out.insert(out.end(), block.begin(), block.end());
+        pos += code;
+        if (code < 0xff && pos < record.size())
+            out.push_back(std::byte{0});
+    }
+    return true;
+}
+
+void Encoder::encode(uint64_t messageId, std::span<std::byte const> payload) {
+    std::array<std::byte, sizeof(uint64_t) + 1> id;
+    byte::WriteStream idStream{id};
+    encodePrefixInt(idStream, messageId);
+    auto const idBytes = std::span<std::byte const>{id}.first(
+        idStream.byteSize());
+
+    std::array<std::byte, sizeof(uint32_t)> crc;
+    storeWord(crc.data(), crc.size(), crc32c(payload, crc32c(idBytes)));
+
+    auto const start = m_ctx.data.size();
+    m_ctx.data.reserve(start + 1 +
+                       cobsMaxEncodedSize(idBytes.size() + payload.size() +
+                                          crc.size()));
+    CobsWriter cobs{m_ctx.data};
+    cobs.append(idBytes);
+    cobs.append(payload);
+    cobs.append(crc);
+    cobs.finish();
+    m_ctx.data.push_back(std::byte{0});
+    m_ctx.sizes.push_back((uint32_t)(m_ctx.data.size() - start));
+}
+
+bool Decoder::next(Record& out) {
+    while (m_position < m_data.size()) {
+        auto const rest = m_data.subspan(m_position);
+        auto const zero = static_cast<std::byte const*>(
+            std::memchr(rest.data(), 0, rest.size()));
+        auto const size = zero ? (size_t)(zero - rest.data()) : rest.size();
+        m_position += zero ? size + 1 : size;
+        // Runs of delimiters are padding
+        if (size == 0)
+            continue;
+        if (zero && decodeRecord(rest.first(size), out))
+            return true;
+        // Resynchronize on the delimiter that ended the bad record
+        ++m_corrupt;
+    }
+    return false;
+}
+
+bool Decoder::decodeRecord(std::span<std::byte const> record, Record& out) {
+    if (!cobsDecode(record, m_buffer) || m_buffer.size() < sizeof(uint32_t))
+        return false;
+    auto const body = std::span<std::byte const>{m_buffer}.first(
+        m_buffer.size() - sizeof(uint32_t));
+    auto const stored = (uint32_t)loadWord(m_buffer.data() + body.size(),
+                                           sizeof(uint32_t));
+    if (crc32c(body) != stored)
+        return false;
+
+    byte::ReadStream stream{body};
+    uint64_t messageId = 0;
+    if (!decodePrefixInt(stream, messageId))
+        return false;
+    out = {
+        .messageId = messageId,
+        .payload = body.subspan(stream.position()),
+    };
+    return true;
+}
+}  // namespace ao::pack::disk
@@ -0,0 +1,253 @@
+#include <ao/pack/FileStream.h>
+
+#include <algorithm>
+#include <cerrno>
+
+#if defined(_WIN32)
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ao::pack::byte {
+namespace {
+// Caps single calls so the count fits the narrower Windows CRT types
+constexpr size_t kMaxIoSize = size_t{1} << 30;
+
+#if defined(_WIN32)
+int openRead(std::filesystem::path const& path) {
+    return _wopen(path.c_str(), _O_RDONLY | _O_BINARY | _O_NOINHERIT);
+}
+int openWrite(std::filesystem::path const& path, FileWriteMode mode) {
+    auto const flags = _O_WRONLY | _O_CREAT | _O_BINARY | _O_NOINHERIT |
+                       (mode == FileWriteMode::Append ? _O_APPEND : _O_TRUNC);
+    return _wopen(path.c_str(), flags, _S_IREAD | _S_IWRITE);
+}
+bool fileSize(int fd, size_t& out) {
+    struct _stat64 st;
+    if (_fstat64(fd, &st) != 0)
+        return false;
+    out = (size_t)st.st_size;
+    return true;
+}
+int64_t readSome(int fd, std::byte* dst, size_t size) {
+    return _read(fd, dst, (unsigned)std::min(size, kMaxIoSize));
+}
+int64_t writeSome(int fd, std::byte const* src, size_t size) {
+    return _write(fd, src, (unsigned)std::min(size, kMaxIoSize));
+}
+void closeFile(int fd) {
+    _close(fd);
+}
+#else
+int openRead(std::filesystem::path const& path) {
+    return ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+}
+int openWrite(std::filesystem::path const& path, FileWriteMode mode) {
+    auto const flags = O_WRONLY | O_CREAT | O_CLOEXEC |
+                       (mode == FileWriteMode::Append ? O_APPEND : O_TRUNC);
+    return ::open(path.c_str(), flags, 0644);
+}
+bool fileSize(int fd, size_t& out) {
+    struct stat st;
+    if (::fstat(fd, &st) != 0)
+        return false;
+    out = (size_t)st.st_size;
+    return true;
+}
+int64_t readSome(int fd, std::byte* dst, size_t size) {
+    int64_t ret;
+    do {
+        ret = ::read(fd, dst, std::min(size, kMaxIoSize));
+    } while (ret < 0 && errno == EINTR);
+    return ret;
+}
+int64_t writeSome(int fd, std::byte const* src, size_t size) {
+    int64_t ret;
+    do {
+        ret = ::write(fd, src, std::min(size, kMaxIoSize));
+    } while (ret < 0 && errno == EINTR);
+    return ret;
+}
+void closeFile(int fd) {
+    ::close(fd);
+}
+#endif
+
+bool writeAll(int fd, std::byte const* src, size_t size) {
+    while (size > 0) {
+        auto const written = writeSome(fd, src, size);
+        if (written <= 0)
+            return false;
+        src += written;
+        size -= (size_t)written;
+    }
+    return true;
+}
+}  // namespace
+
+FileReadStream::FileReadStream(std::filesystem::path const& path,
+                               size_t bufferSize)
+    : m_bufferSize(std::max(bufferSize, sizeof(uint64_t))) {
+    m_fd = openRead(path);
+    if (m_fd < 0 || !fileSize(m_fd, m_fileSize)) {
+        fail(Error::StreamError);
+        return;
+    }
+    m_buffer = detail::allocateAligned(m_bufferSize);
+}
+
+FileReadStream::~FileReadStream() {
+    if (m_fd >= 0)
+        closeFile(m_fd);
+}
+
+bool FileReadStream::peek(std::span<std::byte> out, size_t count) {
+    if (!ok() || out.size() < count || count > m_bufferSize)
+        return false;
+    if (buffered() < count)
+        fill(count);
+    if (!ok() || buffered() < count)
+        return false;
+    std::memcpy(out.data(), m_buffer.get() + m_begin, count);
+    return true;
+}
+
+FileReadStream& FileReadStream::advance(size_t count) {
+    if (!ok())
+        return *this;
+    if (remainingBytes() < count)
+        return fail(Error::Eof);
+    auto const skip = std::min(count, buffered());
+    m_begin += skip;
+    count -= skip;
+    while (count > 0 && ok()) {
+        fill(std::min(count, m_bufferSize));
+        auto const take = std::min(count, buffered());
+        if (take == 0)
+            return fail(Error::Eof);
+        m_begin += take;
+        count -= take;
+    }
+    return *this;
+}
+
+FileReadStream& FileReadStream::readSlow(std::span<std::byte> out,
+                                         size_t count) {
+    if (!ok())
+        return *this;
+    if (out.size() < count)
+        return fail(Error::BadArg);
+    if (remainingBytes() < count)
+        return fail(Error::Eof);
+
+    auto const head = buffered();
+    std::memcpy(out.data(), m_buffer.get() + m_begin, head);
+    m_begin = m_end = 0;
+    auto* dst = out.data() + head;
+    count -= head;
+
+    // Large reads skip the buffer
+    if (count >= m_bufferSize) {
+        while (count > 0) {
+            auto const got = readSome(m_fd, dst, count);
+            if (got <= 0)
+                return fail(got < 0 ? Error::StreamError : Error::Eof);
+            dst += got;
+            count -= (size_t)got;
+            m_fileOffset += (size_t)got;
+        }
+        return *this;
+    }
+
+    fill(count);
+    if (!ok())
+        return *this;
+    if (buffered() < count)
+        return fail(Error::Eof);
+    std::memcpy(dst, m_buffer.get() + m_begin, count);
+    m_begin += count;
+    return *this;
+}
+
+void FileReadStream::fill(size_t want) {
+    auto const kept = buffered();
+    if (m_begin > 0) {
+        std::memmove(m_buffer.get(), m_buffer.get() + m_begin, kept);
+        m_begin = 0;
+        m_end = kept;
+    }
+    while (m_end < want && m_fileOffset < m_fileSize) {
+        auto const got =
+            readSome(m_fd, m_buffer.get() + m_end, m_bufferSize - m_end);
+        if (got < 0) {
+            fail(Error::StreamError);
+            return;
+        }
+        if (got == 0)
+            return;
+        m_end += (size_t)got;
+        m_fileOffset += (size_t)got;
+    }
+}
+
+FileWriteStream::FileWriteStream(std::filesystem::path const& path,
+                                 FileWriteMode mode,
+                                 size_t bufferSize)
+    : m_bufferSize(std::max<size_t>(bufferSize, 1)) {
+    m_fd = openWrite(path, mode);
+    if (m_fd < 0) {
+        fail(Error::StreamError);
+        return;
+    }
+    m_buffer = detail::allocateAligned(m_bufferSize);
+}
+
+FileWriteStream::~FileWriteStream() {
+    if (m_fd < 0)
+        return;
+    flush();
+    closeFile(m_fd);
+}
+
+FileWriteStream& FileWriteStream::flush() {
+    if (!ok() || m_used == 0)
+        return *this;
+    if (!writeAll(m_fd, m_buffer.get(), m_used))
+        return fail(Error::StreamError);
+    m_used = 0;
+    return *this;
+}
+
+FileWriteStream& FileWriteStream::writeSlow(std::span<std::byte const> data,
+                                            size_t count) {
+    if (!ok())
+        return *this;
+    if (data.size() < count)
+        return fail(Error::BadArg);
+
+    // Top up the buffer first so the descriptor sees full buffers
+    auto const head = std::min(count, m_bufferSize - m_used);
+    std::memcpy(m_buffer.get() + m_used, data.data(), head);
+    m_used += head;
+    m_position += head;
+    auto rest = data.subspan(head, count - head);
+    if (!flush().ok() || rest.empty())
+        return *this;
+
+    // Large writes skip the buffer
+    if (rest.size() >= m_bufferSize) {
+        if (!writeAll(m_fd, rest.data(), rest.size()))
+            return fail(Error::StreamError);
+    } else {
+        std::memcpy(m_buffer.get(), rest.data(), rest.size());
+        m_used = rest.size();
+    }
+    m_position += rest.size();
+    return *this;
+}
+}  // namespace ao::pack::byte
@@ -0,0 +1,102 @@
+#include <ao/pack/MmapStream.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ao::pack {
+std::shared_ptr<MappedFile const> MappedFile::open(
+    std::filesystem::path const& path) {
+    auto file = std::make_shared<MappedFile>();
+#ifdef _WIN32
+    HANDLE handle =
+        CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE)
+        return nullptr;
+    LARGE_INTEGER size{};
+    bool mapped = GetFileSizeEx(handle, &size) != 0;
+    // Windows refuses to map empty files
+    if (mapped && size.QuadPart > 0) {
+        file->m_mapping =
+            CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (file->m_mapping != nullptr)
+            file->m_data =
+                MapViewOfFile(file->m_mapping, FILE_MAP_READ, 0, 0, 0);
+        mapped = file->m_data != nullptr;
+        if (mapped)
+            file->m_size = (size_t)size.QuadPart;
+    }
+    CloseHandle(handle);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return nullptr;
+    struct stat st{};
+    bool mapped = fstat(fd, &st) == 0;
+    // mmap refuses empty files
+    if (mapped && st.st_size > 0) {
+        void* data =
+            mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        mapped = data != MAP_FAILED;
+        if (mapped) {
+            file->m_data = data;
+            file->m_size = (size_t)st.st_size;
+        }
+    }
+    ::close(fd);
+#endif
+    if (!mapped)
+        return nullptr;
+    return file;
+}
+
+MappedFile::~MappedFile() {
+#ifdef _WIN32
+    if (m_data != nullptr)
+        UnmapViewOfFile(m_data);
+    if (m_mapping != nullptr)
+        CloseHandle(m_mapping);
+#else
+    if (m_data != nullptr)
+        munmap(m_data, m_size);
+#endif
+}
+
+void MappedFile::advise(AccessHint hint) const {
+    if (m_data == nullptr)
+        return;
+#ifdef _WIN32
+#if _WIN32_WINNT >= 0x0602
+    if (hint == AccessHint::WillNeed) {
+        WIN32_MEMORY_RANGE_ENTRY range{m_data, m_size};
+        PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+    }
+#endif
+#else
+    int advice = MADV_NORMAL;
+    switch (hint) {
+        case AccessHint::Normal:
+            advice = MADV_NORMAL;
+            break;
+        case AccessHint::Sequential:
+            advice = MADV_SEQUENTIAL;
+            break;
+        case AccessHint::Random:
+            advice = MADV_RANDOM;
+            break;
+        case AccessHint::WillNeed:
+            advice = MADV_WILLNEED;
+            break;
+    }
+    madvise(m_data, m_size, advice);
+#endif
+}
+}  // namespace ao::pack
@@ -0,0 +1,392 @@
+#include <ao/pack/Word.h>
+#include <ao/pack/Xxh3.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#if defined(_MSC_VER) && !defined(__clang__) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+namespace ao::pack::xxh3 {
+namespace {
+constexpr uint32_t kPrime32_1 = 0x9E3779B1U;
+constexpr uint32_t kPrime32_2 = 0x85EBCA77U;
+constexpr uint32_t kPrime32_3 = 0xC2B2AE3DU;
+constexpr uint64_t kPrime64_1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t kPrime64_2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr uint64_t kPrime64_3 = 0x165667B19E3779F9ULL;
+constexpr uint64_t kPrime64_4 = 0x85EBCA77C2B2AE63ULL;
+constexpr uint64_t kPrime64_5 = 0x27D4EB2F165667C5ULL;
+constexpr uint64_t kPrimeMx1 = 0x165667919E3779F9ULL;
+constexpr uint64_t kPrimeMx2 = 0x9FB21C651E98DF25ULL;
+
+constexpr size_t kStripeSize = 64;
+constexpr size_t kSecretConsumeRate = 8;
+constexpr size_t kMidSizeMax = 240;
+constexpr size_t kSecretSizeMin = 136;
+constexpr size_t kMidSizeStartOffset = 3;
+constexpr size_t kMidSizeLastOffset = 17;
+constexpr size_t kSecretLastAccStart = 7;
+constexpr size_t kSecretMergeAccsStart = 11;
+
+constexpr uint8_t kSecret[192] = {
+    0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c,
+    0xf7, 0x21, 0xad, 0x1c, 0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb,
+    0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f, 0xcb, 0x79, 0xe6, 0x4e,
+    0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+    0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6,
+    0x81, 0x3a, 0x26, 0x4c, 0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb,
+    0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3, 0x71, 0x64, 0x48, 0x97,
+    0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+    0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7,
+    0xc7, 0x0b, 0x4f, 0x1d, 0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31,
+    0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64, 0xea, 0xc5, 0xac, 0x83,
+    0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+    0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26,
+    0x29, 0xd4, 0x68, 0x9e, 0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc,
+    0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce, 0x45, 0xcb, 0x3a, 0x8f,
+    0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+};
+constexpr size_t kSecretLimit = sizeof(kSecret) - kStripeSize;
+constexpr size_t kStripesPerBlock = kSecretLimit / kSecretConsumeRate;
+
+constexpr std::array<uint64_t, 8> kInitAcc = {
+    kPrime32_3, kPrime64_1, kPrime64_2, kPrime64_3,
+    kPrime64_4, kPrime32_2, kPrime64_5, kPrime32_1,
+};
+
+uint64_t read64(void const* src) {
+    return loadWord(static_cast<std::byte const*>(src), 8);
+}
+uint32_t read32(void const* src) {
+    return (uint32_t)loadWord(static_cast<std::byte const*>(src), 4);
+}
+uint64_t secret64(size_t offset) {
+    return read64(kSecret + offset);
+}
+uint32_t secret32(size_t offset) {
+    return read32(kSecret + offset);
+}
+
+Hash128 mult64to128(uint64_t lhs, uint64_t rhs) {
+#if defined(__SIZEOF_INT128__)
+    auto const product = (unsigned __int128)lhs * rhs;
+    return {.low = (uint64_t)product, .high = (uint64_t)(product >> 64)};
+#elif defined(_MSC_VER) && defined(_M_X64)
+    uint64_t high;
+    uint64_t const low = _umul128(lhs, rhs, &high);
+    return {.low = low, .high = high};
+#else
+    auto const loLo = (lhs & 0xFFFFFFFF) * (rhs & 0xFFFFFFFF);
+    auto const hiLo = (lhs >> 32) * (rhs & 0xFFFFFFFF);
+    auto const loHi = (lhs & 0xFFFFFFFF) * (rhs >> 32);
+    auto const hiHi = (lhs >> 32) * (rhs >> 32);
+    auto const cross = (loLo >> 32) + (hiLo & 0xFFFFFFFF) + loHi;
+    return {
+        .low = (cross << 32) | (loLo & 0xFFFFFFFF),
+        .high = (hiLo >> 32) + (cross >> 32) + hiHi,
+    };
+#endif
+}
+
+uint64_t mul128Fold64(uint64_t lhs, uint64_t rhs) {
+    auto const product = mult64to128(lhs, rhs);
+    return product.low ^ product.high;
+}
+
+uint64_t xorShift64(uint64_t v, int shift) {
+    return v ^ (v >> shift);
+}
+
+uint64_t avalanche(uint64_t h) {
+    h = xorShift64(h, 37);
+    h *= kPrimeMx1;
+    return xorShift64(h, 32);
+}
+
+uint64_t xxh64Avalanche(uint64_t h) {
+    h ^= h >> 33;
+    h *= kPrime64_2;
+    h ^= h >> 29;
+    h *= kPrime64_3;
+    h ^= h >> 32;
+    return h;
+}
+
+uint64_t mix16(std::byte const* input, size_t secretOffset) {
+    return mul128Fold64(read64(input) ^ secret64(secretOffset),
+                        read64(input + 8) ^ secret64(secretOffset + 8));
+}
+
+Hash128 mix32(Hash128 acc,
+              std::byte const* input1,
+              std::byte const* input2,
+              size_t secretOffset) {
+    acc.low += mix16(input1, secretOffset);
+    acc.low ^= read64(input2) + read64(input2 + 8);
+    acc.high += mix16(input2, secretOffset + 16);
+    acc.high ^= read64(input1) + read64(input1 + 8);
+    return acc;
+}
+
+Hash128 finishMid(Hash128 acc, size_t size) {
+    Hash128 ret;
+    ret.low = avalanche(acc.low + acc.high);
+    ret.high = 0 - avalanche(acc.low * kPrime64_1 + acc.high * kPrime64_4 +
+                             size * kPrime64_2);
+    return ret;
+}
+
+Hash128 hash1to3(std::byte const* input, size_t size) {
+    auto const c1 = (uint32_t)input[0];
+    auto const c2 = (uint32_t)input[size >> 1];
+    auto const c3 = (uint32_t)input[size - 1];
+    uint32_t const combinedLow =
+        (c1 << 16) | (c2 << 24) | c3 | ((uint32_t)size << 8);
+    uint32_t const combinedHigh =
+        std::rotl(std::byteswap(combinedLow), 13);
+    uint64_t const flipLow = secret32(0) ^ secret32(4);
+    uint64_t const flipHigh = secret32(8) ^ secret32(12);
+    return {
+        .low = xxh64Avalanche(combinedLow ^ flipLow),
+        .high = xxh64Avalanche(combinedHigh ^ flipHigh),
+    };
+}
+
+Hash128 hash4to8(std::byte const* input, size_t size) {
+    uint64_t const inputLow = read32(input);
+    uint64_t const inputHigh = read32(input + size - 4);
+    uint64_t const input64 = inputLow + (inputHigh << 32);
+    uint64_t const keyed = input64 ^ (secret64(16) ^ secret64(24));
+
+    auto m = mult64to128(keyed, kPrime64_1 + (size << 2));
+    m.high += m.low << 1;
+    m.low ^= m.high >> 3;
+    m.low = xorShift64(m.low, 35);
+    m.low *= kPrimeMx2;
+    m.low = xorShift64(m.low, 28);
+    m.high = avalanche(m.high);
+    return m;
+}
+
+Hash128 hash9to16(std::byte const* input, size_t size) {
+    uint64_t const flipLow = secret64(32) ^ secret64(40);
+    uint64_t const flipHigh = secret64(48) ^ secret64(56);
+    uint64_t const inputLow = read64(input);
+    uint64_t inputHigh = read64(input + size - 8);
+    auto m = mult64to128(inputLow ^ inputHigh ^ flipLow, kPrime64_1);
+    m.low += (uint64_t)(size - 1) << 54;
+    inputHigh ^= flipHigh;
+    m.high += inputHigh +
+              (uint64_t)(uint32_t)inputHigh * (uint64_t)(kPrime32_2 - 1);
+    m.low ^= std::byteswap(m.high);
+
+    auto h = mult64to128(m.low, kPrime64_2);
+    h.high += m.high * kPrime64_2;
+    h.low = avalanche(h.low);
+    h.high = avalanche(h.high);
+    return h;
+}
+
+Hash128 hash0to16(std::byte const* input, size_t size) {
+    if (size > 8)
+        return hash9to16(input, size);
+    if (size >= 4)
+        return hash4to8(input, size);
+    if (size > 0)
+        return hash1to3(input, size);
+    return {
+        .low = xxh64Avalanche(secret64(64) ^ secret64(72)),
+        .high = xxh64Avalanche(secret64(80) ^ secret64(88)),
+    };
+}
+
+Hash128 hash17to128(std::byte const* input, size_t size) {
+    Hash128 acc{.low = size * kPrime64_1, .high = 0};
+    if (size > 32) {
+        if (size > 64) {
+            if (size > 96)
+                acc = mix32(acc, input + 48, input + size - 64, 96);
+            acc = mix32(acc, input + 32, input + size - 48, 64);
+        }
+        acc = mix32(acc, input + 16, input + size - 32, 32);
+    }
+    acc = mix32(acc, input, input + size - 16, 0);
+    return finishMid(acc, size);
+}
+
+Hash128 hash129to240(std::byte const* input, size_t size) {
+    Hash128 acc{.low = size * kPrime64_1, .high = 0};
+    for (size_t i = 32; i < 160; i += 32)
+        acc = mix32(acc, input + i - 32, input + i - 16, i - 32);
+    acc.low = avalanche(acc.low);
+    acc.high = avalanche(acc.high);
+    for (size_t i = 160; i <= size; i += 32) {
+        acc = mix32(acc, input + i - 32, input + i - 16,
+                    kMidSizeStartOffset + i - 160);
+    }
+    acc = mix32(acc, input + size - 16, input + size - 32,
+                kSecretSizeMin - kMidSizeLastOffset - 16);
+    return finishMid(acc, size);
+}
+
+Hash128 hashShort(std::byte const* input, size_t size) {
+    if (size <= 16)
+        return hash0to16(input, size);
+    if (size <= 128)
+        return hash17to128(input, size);
+    return hash129to240(input, size);
+}
+
+void accumulateStripe(std::array<uint64_t, 8>& acc,
+                      std::byte const* input,
+                      uint8_t const* secret) {
+    for (size_t lane = 0; lane < acc.size(); ++lane) {
+        auto const value = read64(input + lane * 8);
+        auto const key = value ^ read64(secret + lane * 8);
+        acc[lane ^ 1] += value;
+        acc[lane] += (key & 0xFFFFFFFF) * (key >> 32);
+    }
+}
+
+void accumulate(std::array<uint64_t, 8>& acc,
+                std::byte const* input,
+                uint8_t const* secret,
+                size_t stripes) {
+    for (size_t n = 0; n < stripes; ++n) {
+        accumulateStripe(acc, input + n * kStripeSize,
+                         secret + n * kSecretConsumeRate);
+    }
+}
+
+void scramble(std::array<uint64_t, 8>& acc) {
+    for (size_t lane = 0; lane < acc.size(); ++lane) {
+        auto value = xorShift64(acc[lane], 47);
+        value ^= secret64(kSecretLimit + lane * 8);
+        acc[lane] = value * kPrime32_1;
+    }
+}
+
+// Feeds whole stripes, scrambling at every block boundary. `stripesSoFar`
+// is the position inside the current block.
+std::byte const* consumeStripes(std::array<uint64_t, 8>& acc,
+                                size_t& stripesSoFar,
+                                std::byte const* input,
+                                size_t stripes) {
+    while (stripes > 0) {
+        auto const take = std::min(stripes, kStripesPerBlock - stripesSoFar);
+        accumulate(acc, input, kSecret + stripesSoFar * kSecretConsumeRate,
+                   take);
+        input += take * kStripeSize;
+        stripes -= take;
+        stripesSoFar += take;
+        if (stripesSoFar == kStripesPerBlock) {
+            scramble(acc);
+            stripesSoFar = 0;
+        }
+    }
+    return input;
+}
+
+uint64_t mergeAccs(std::array<uint64_t, 8> const& acc,
+                   size_t secretOffset,
+                   uint64_t start) {
+    auto result = start;
+    for (size_t i = 0; i < 4; ++i) {
+        result += mul128Fold64(acc[2 * i] ^ secret64(secretOffset + 16 * i),
+                               acc[2 * i + 1] ^
+                                   secret64(secretOffset + 16 * i + 8));
+    }
+    return avalanche(result);
+}
+
+Hash128 finishLong(std::array<uint64_t, 8> const& acc, uint64_t size) {
+    return {
+        .low = mergeAccs(acc, kSecretMergeAccsStart, size * kPrime64_1),
+        .high = mergeAccs(acc,
+                          sizeof(kSecret) - sizeof(acc) -
+                              kSecretMergeAccsStart,
+                          ~(size * kPrime64_2)),
+    };
+}
+}  // namespace
+
+Hash128 hash128(std::span<std::byte const> data) {
+    auto const* input = data.data();
+    auto const size = data.size();
+    if (size <= kMidSizeMax)
+        return hashShort(input, size);
+
+    auto acc = kInitAcc;
+    size_t stripesSoFar = 0;
+    // The last stripe is always handled separately, even when whole
+    consumeStripes(acc, stripesSoFar, input, (size - 1) / kStripeSize);
+    accumulateStripe(acc, input + size - kStripeSize,
+                     kSecret + kSecretLimit - kSecretLastAccStart);
+    return finishLong(acc, size);
+}
+
+void Hasher128::reset() {
+    m_acc = kInitAcc;
+    m_buffered = 0;
+    m_stripesSoFar = 0;
+    m_totalSize = 0;
+}
+
+void Hasher128::update(std::span<std::byte const> data) {
+    auto const* input = data.data();
+    auto const* const end = input + data.size();
+    m_totalSize += data.size();
+    if (data.size() <= kBufferSize - m_buffered) {
+        if (!data.empty())
+            std::memcpy(m_buffer.data() + m_buffered, input, data.size());
+        m_buffered += data.size();
+        return;
+    }
+
+    // Only consume once more input is known to follow, the final stripe is
+    // special cased in digest()
+    constexpr size_t kBufferStripes = kBufferSize / kStripeSize;
+    if (m_buffered > 0) {
+        auto const load = kBufferSize - m_buffered;
+        std::memcpy(m_buffer.data() + m_buffered, input, load);
+        input += load;
+        consumeStripes(m_acc, m_stripesSoFar, m_buffer.data(), kBufferStripes);
+        m_buffered = 0;
+    }
+    if ((size_t)(end - input) > kBufferSize) {
+        auto const stripes = (size_t)(end - 1 - input) / kStripeSize;
+        input = consumeStripes(m_acc, m_stripesSoFar, input, stripes);
+        std::memcpy(m_buffer.data() + kBufferSize - kStripeSize,
+                    input - kStripeSize, kStripeSize);
+    }
+    m_buffered = (size_t)(end - input);
+    std::memcpy(m_buffer.data(), input, m_buffered);
+}
+
+Hash128 Hasher128::digest() const {
+    if (m_totalSize <= kMidSizeMax)
+        return hashShort(m_buffer.data(), (size_t)m_totalSize);
+
+    auto acc = m_acc;
+    std::byte lastStripe[kStripeSize];
+    std::byte const* last;
+    if (m_buffered >= kStripeSize) {
+        auto stripesSoFar = m_stripesSoFar;
+        consumeStripes(acc, stripesSoFar, m_buffer.data(),
+                       (m_buffered - 1) / kStripeSize);
+        last = m_buffer.data() + m_buffered - kStripeSize;
+    } else {
+        // Stitch the tail of the previous stripe onto the buffered bytes
+        auto const catchup = kStripeSize - m_buffered;
+        std::memcpy(lastStripe, m_buffer.data() + kBufferSize - catchup,
+                    catchup);
+        std::memcpy(lastStripe + catchup, m_buffer.data(), m_buffered);
+        last = lastStripe;
+    }
+    accumulateStripe(acc, last, kSecret + kSecretLimit - kSecretLastAccStart);
+    return finishLong(acc, m_totalSize);
+}
+}  // namespace ao::pack::xxh3
@@ -0,0 +1,76 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <ao/pack/AlignedStream.h>
+#include <ao/pack/ByteStream.h>
+#include <ao/pack/Varint.h>
+
+using namespace ao::pack;
+using namespace ao::pack::byte;
+
+using AlignedWrite = AlignedWriteStream<WriteStream>;
+using AlignedRead = AlignedReadStream<ReadStream>;
+
+TEST_CASE("AlignedWriteStream rounds bit fields up to whole bytes") {
+    std::array<std::byte, 16> data{};
+    AlignedWrite ws{std::span{data}};
+    ws.bits(1, 1);
+    ws.bits(0x3ff, 10);
+    ws.bits(~0ull, 3);
+    ws.bits(0x0102030405060708ull, 64);
+    REQUIRE(ws.ok());
+    REQUIRE(ws.byteSize() == 1 + 2 + 1 + 8);
+
+    std::array<uint8_t, 12> expected{0x01, 0xff, 0x03, 0x07, 0x08, 0x07,
+                                     0x06, 0x05, 0x04, 0x03, 0x02, 0x01};
+    for (size_t i = 0; i < expected.size(); ++i)
+        REQUIRE(data[i] == std::byte{expected[i]});
+}
+
+TEST_CASE("AlignedReadStream reads back what AlignedWriteStream wrote") {
+    std::vector<std::byte> data(512);
+    AlignedWrite ws{std::span{data}};
+    std::vector<std::pair<uint64_t, size_t>> fields;
+    for (size_t count = 1; count <= 64; ++count)
+        fields.push_back({0x9e3779b97f4a7c15ull >> (64 - count), count});
+    for (auto [value, count] : fields)
+        ws.bits(value, count);
+    encodePrefixInt(ws, 300);
+    REQUIRE(ws.ok());
+
+    AlignedRead rs{std::span<std::byte const>{data.data(), ws.byteSize()}};
+    for (auto [value, count] : fields) {
+        uint64_t out = 0;
+        rs.bits(out, count);
+        REQUIRE(out == value);
+    }
+    uint64_t prefix = 0;
+    REQUIRE(decodePrefixInt(rs, prefix));
+    REQUIRE(prefix == 300);
+    REQUIRE(rs.ok());
+    REQUIRE(rs.remainingBytes() == 0);
+
+    SECTION("reading past the end is a sticky Eof") {
+        uint64_t out = 1;
+        rs.bits(out, 8);
+        REQUIRE(out == 0);
+        REQUIRE(rs.error() == Error::Eof);
+    }
+}
+
+TEST_CASE("Aligned streams reject fields wider than 64 bits") {
+    std::array<std::byte, 16> data{};
+    AlignedWrite ws{std::span{data}};
+    ws.bits(0, 65);
+    REQUIRE(ws.error() == Error::BadArg);
+
+    AlignedRead rs{std::span<std::byte const>{data}};
+    uint64_t out = 0;
+    rs.bits(out, 65);
+    REQUIRE(rs.error() == Error::BadArg);
+}
@@ -805,3 +805,149 @@ TEST_CASE(
     REQUIRE_FALSE(rs.ok());
     REQUIRE(rs.error() == Error::Eof);
 }
+
+TEST_CASE(
+    "WriteStream bits() at every offset matches a bit by bit reference and "
+    "keeps neighbouring bits",
+    "[WriteStream][bits]") {
+    auto const offset = GENERATE(range(size_t{0}, size_t{16}));
+    auto const count = GENERATE(size_t{1}, size_t{3}, size_t{8}, size_t{13},
+                                size_t{32}, size_t{57}, size_t{63}, size_t{64});
+    uint64_t const value = 0xF0E1D2C3B4A59687ULL;
+
+    // Sized so the field ends exactly at the end of the buffer
+    std::vector<std::byte> buf((offset + count + 7) / 8);
+    fillPattern(buf);
+    auto expected = buf;
+    for (size_t i = 0; i < count; ++i) {
+        auto const bit = offset + i;
+        auto const b = std::byte(1u << (bit % 8));
+        expected[bit / 8] &= ~b;
+        if ((value >> i) & 1)
+            expected[bit / 8] |= b;
+    }
+
+    // Rewrite the leading bits with their current values to reach the offset
+    uint64_t lead = 0;
+    for (size_t i = 0; i < offset; ++i)
+        lead |= uint64_t((buf[i / 8] >> (i % 8)) & std::byte{1}) << i;
+
+    WriteStream ws{std::span<std::byte>(buf)};
+    ws.bits(lead, offset);
+    ws.bits(value, count);
+    REQUIRE(ws.ok());
+    REQUIRE(ws.bitSize() == offset + count);
+    REQUIRE(buf == expected);
+
+    if ((offset + count) % 8 == 0) {
+        ws.bits(0, 1);
+        REQUIRE(ws.error() == Error::Overflow);
+    }
+}
+
+TEST_CASE(
+    "ReadStream bits() matches a bit by bit reference across refills and "
+    "bytes() calls",
+    "[ReadStream][bits]") {
+    auto const size = GENERATE(size_t{1}, size_t{7}, size_t{9}, size_t{17},
+                               size_t{40});
+    auto const step = GENERATE(size_t{1}, size_t{5}, size_t{13}, size_t{31},
+                               size_t{60}, size_t{64});
+
+    std::vector<std::byte> data(size);
+    fillPattern(data);
+    auto const refBits = [&](size_t pos, size_t n) {
+        uint64_t ret = 0;
+        for (size_t i = 0; i < n; ++i) {
+            auto const bit = pos + i;
+            ret |= uint64_t((data[bit / 8] >> (bit % 8)) & std::byte{1}) << i;
+        }
+        return ret;
+    };
+
+    ReadStream rs{std::span<std::byte>(data)};
+    size_t pos = 0;
+    size_t count = step;
+    while (pos + count <= size * 8) {
+        uint64_t out = 0;
+        rs.bits(out, count);
+        REQUIRE(rs.ok());
+        REQUIRE(out == refBits(pos, count));
+        pos += count;
+        REQUIRE(rs.position().bitPos == pos);
+
+        // Interleave unaligned byte reads to drop the window mid stream
+        if (rs.remainingBytes() > 2 && pos % 3 == 0) {
+            std::array<std::byte, 1> byte{};
+            rs.bytes(byte, 1);
+            REQUIRE(rs.ok());
+            REQUIRE(uint64_t(byte[0]) == refBits(pos, 8));
+            pos += 8;
+        }
+        count = count % 64 + 1;
+    }
+
+    uint64_t out = 0;
+    rs.bits(out, size * 8 - pos + 1);
+    REQUIRE(rs.error() == Error::Eof);
+}
+
+TEST_CASE("TrustedReadStream reads the same bits as ReadStream",
+          "[TrustedReadStream][bits]") {
+    auto const size = GENERATE(size_t{1}, size_t{7}, size_t{9}, size_t{17},
+                               size_t{40});
+    auto const step = GENERATE(size_t{1}, size_t{5}, size_t{13}, size_t{31},
+                               size_t{60}, size_t{64});
+
+    std::vector<std::byte> data(size);
+    fillPattern(data);
+
+    ReadStream rs{std::span<std::byte>(data)};
+    TrustedReadStream ts{data};
+    size_t count = step;
+    while (count <= ts.remainingBits()) {
+        uint64_t expected = 0;
+        uint64_t out = 0;
+        rs.bits(expected, count);
+        ts.bits(out, count);
+        REQUIRE(out == expected);
+        REQUIRE(ts.position().bitPos == rs.position().bitPos);
+
+        uint64_t expectedWindow = 0;
+        uint64_t window = 0;
+        auto const available = ts.peekWindow(window);
+        REQUIRE(available == rs.peekWindow(expectedWindow));
+        REQUIRE((window & ao::pack::maskBits(available * 8)) ==
+                (expectedWindow & ao::pack::maskBits(available * 8)));
+        count = count % 64 + 1;
+    }
+    REQUIRE(ts.ok());
+}
+
+TEST_CASE("TrustedReadStream hands its position back to ReadStream",
+          "[TrustedReadStream]") {
+    std::vector<std::byte> data(16);
+    fillPattern(data);
+    ReadStream rs{std::span<std::byte>(data)};
+    uint64_t skip = 0;
+    rs.bits(skip, 3);
+
+    TrustedReadStream ts{rs.data(), rs.position()};
+    std::array<std::byte, 2> bytes{};
+    ts.bytes(bytes, 2);
+    ts.align();
+    REQUIRE(ts.position().bitPos == 24);
+
+    rs.seek(ts.position());
+    REQUIRE(rs.ok());
+    uint64_t out = 0;
+    rs.bits(out, 8);
+    REQUIRE(std::byte(out) == data[3]);
+
+    rs.seek({data.size() * 8 + 1});
+    REQUIRE(rs.error() == Error::Eof);
+
+    ts.require(false, Error::BadArg);
+    ts.require(false, Error::Eof);
+    REQUIRE(ts.error() == Error::BadArg);
+}
@@ -0,0 +1,89 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <ao/pack/ByteStream.h>
+#include <ao/pack/ChainStream.h>
+#include <ao/pack/Varint.h>
+
+#include "Helpers.h"
+
+using namespace ao::pack;
+using namespace ao::pack::byte;
+
+TEST_CASE("ChainWriteStream references large writes and copies small ones") {
+    auto large = pattern(64, 1);
+    auto small = pattern(8, 2);
+    ChainWriteStream ws{32};
+    ws.bytes(small, small.size());
+    ws.bytes(small, small.size());
+    ws.bytes(large, large.size());
+    ws.bytes(small, 4);
+    REQUIRE(ws.ok());
+    REQUIRE(ws.byteSize() == 8 + 8 + 64 + 4);
+
+    auto segments = ws.segments();
+    REQUIRE(segments.size() == 3);
+    // Back to back copies share a segment
+    REQUIRE(segments[0].size() == 16);
+    REQUIRE(segments[0].data() != small.data());
+    REQUIRE(segments[1].data() == large.data());
+    REQUIRE(segments[1].size() == 64);
+    REQUIRE(segments[2].size() == 4);
+}
+
+TEST_CASE("ChainWriteStream flushes the chain in order") {
+    TempFile file{"chain_flush"};
+    auto large = pattern(100000, 3);
+    std::vector<std::byte> expected;
+
+    ChainWriteStream ws;
+    for (uint64_t v : {1ull, 300ull, 1ull << 40}) {
+        encodePrefixInt(ws, v);
+        std::vector<std::byte> tmp(16);
+        WriteStream flat{tmp};
+        encodePrefixInt(flat, v);
+        expected.insert(expected.end(), tmp.begin(),
+                        tmp.begin() + flat.byteSize());
+    }
+    ws.bytes(large, large.size());
+    expected.insert(expected.end(), large.begin(), large.end());
+    // Enough small copies to span several owned blocks
+    auto small = pattern(100, 4);
+    for (int i = 0; i < 500; ++i) {
+        ws.bytes(small, small.size());
+        expected.insert(expected.end(), small.begin(), small.end());
+    }
+
+    REQUIRE(ws.flush(file.fd()).ok());
+    REQUIRE(ws.byteSize() == 0);
+    REQUIRE(ws.segments().empty());
+    REQUIRE(file.contents() == expected);
+}
+
+TEST_CASE("ChainWriteStream writes more segments than one gather call takes") {
+    TempFile file{"chain_gather"};
+    auto source = pattern(6000, 5);
+    std::vector<std::byte> expected;
+
+    // Every other byte so no two references are adjacent
+    ChainWriteStream ws{1};
+    for (size_t i = 0; i < source.size(); i += 2) {
+        ws.bytes(std::span{source}.subspan(i), 1);
+        expected.push_back(source[i]);
+    }
+    REQUIRE(ws.segments().size() == 3000);
+    REQUIRE(ws.flush(file.fd()).ok());
+    REQUIRE(file.contents() == expected);
+}
+
+TEST_CASE("ChainWriteStream reports failed writes") {
+    auto data = pattern(16, 6);
+    ChainWriteStream ws;
+    ws.bytes(data, data.size());
+    ws.flush(-1);
+    REQUIRE(ws.error() == Error::StreamError);
+}
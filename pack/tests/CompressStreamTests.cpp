@@ -0,0 +1,209 @@
+#include <catch2/catch_all.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include <ao/pack/ByteStream.h>
+#include <ao/pack/CompressStream.h>
+#include <ao/pack/Varint.h>
+
+using namespace ao::pack;
+using compress::Method;
+
+namespace {
+std::vector<std::byte> randomBytes(size_t size, uint32_t seed) {
+    std::vector<std::byte> ret(size);
+    for (auto& b : ret) {
+        seed = seed * 1103515245 + 12345;
+        b = std::byte(seed >> 16);
+    }
+    return ret;
+}
+
+// Log like text, repetitive but not trivially so
+std::vector<std::byte> textBytes(size_t size) {
+    std::string_view words[] = {"position", "velocity", "entity", "frame",
+                                "=", " ", "\n", "12", "0.5", "-3"};
+    std::vector<std::byte> ret;
+    uint32_t seed = 7;
+    while (ret.size() < size) {
+        seed = seed * 1103515245 + 12345;
+        for (auto c : words[(seed >> 16) % std::size(words)])
+            ret.push_back(std::byte(c));
+    }
+    ret.resize(size);
+    return ret;
+}
+
+std::vector<std::byte> roundTripBlock(Method method,
+                                      std::span<std::byte const> in,
+                                      size_t& compressedSize) {
+    std::vector<std::byte> compressed(
+        compress::maxCompressedSize(method, in.size()));
+    compressedSize = compress::compressBlock(method, in, compressed);
+    compressed.resize(compressedSize);
+    std::vector<std::byte> out(in.size());
+    REQUIRE(compress::decompressBlock(method, compressed, out));
+    return out;
+}
+}  // namespace
+
+TEST_CASE("Lz blocks round trip") {
+    std::vector<std::vector<std::byte>> inputs{
+        {},
+        randomBytes(3, 1),
+        std::vector<std::byte>(1000, std::byte{0}),
+        textBytes(20000),
+        randomBytes(20000, 2),
+    };
+    // Matches overlapping their own output and long literal runs
+    auto mixed = randomBytes(300, 3);
+    mixed.insert(mixed.end(), 700, std::byte{0x41});
+    auto tail = randomBytes(500, 4);
+    mixed.insert(mixed.end(), tail.begin(), tail.end());
+    mixed.insert(mixed.end(), tail.begin(), tail.end());
+    inputs.push_back(mixed);
+
+    for (auto const& in : inputs) {
+        size_t compressedSize = 0;
+        REQUIRE(roundTripBlock(Method::Lz, in, compressedSize) == in);
+        REQUIRE(compressedSize > 0);
+    }
+
+    size_t textSize = 0;
+    roundTripBlock(Method::Lz, textBytes(65536), textSize);
+    REQUIRE(textSize < 65536 / 2);
+    size_t zeroSize = 0;
+    roundTripBlock(Method::Lz, std::vector<std::byte>(65536), zeroSize);
+    REQUIRE(zeroSize < 512);
+}
+
+TEST_CASE("Lz decoder rejects malformed blocks") {
+    auto in = textBytes(4096);
+    std::vector<std::byte> compressed(
+        compress::maxCompressedSize(Method::Lz, in.size()));
+    compressed.resize(compress::compressBlock(Method::Lz, in, compressed));
+    std::vector<std::byte> out(in.size());
+
+    SECTION("truncated input") {
+        auto cut = std::span<std::byte const>{compressed}.first(
+            compressed.size() / 2);
+        REQUIRE_FALSE(compress::decompressBlock(Method::Lz, cut, out));
+    }
+    SECTION("wrong output size") {
+        out.pop_back();
+        REQUIRE_FALSE(compress::decompressBlock(Method::Lz, compressed, out));
+    }
+    SECTION("match before the start of the block") {
+        // One literal followed by a match 2 bytes back
+        std::vector<std::byte> bad{std::byte{0x10}, std::byte{'a'},
+                                   std::byte{0x02}, std::byte{0x00}};
+        std::vector<std::byte> small(5);
+        REQUIRE_FALSE(compress::decompressBlock(Method::Lz, bad, small));
+    }
+}
+
+TEST_CASE("Compress streams round trip across blocks") {
+    auto method = GENERATE(Method::Stored, Method::Lz, Method::Zstd);
+    if (!compress::hasMethod(method)) {
+        std::vector<std::byte> data(16);
+        byte::WriteStream ws{data};
+        CompressWriteStream cs{ws, method};
+        REQUIRE(cs.error() == Error::BadArg);
+        return;
+    }
+
+    auto input = textBytes(10000);
+    std::vector<std::byte> data(20000);
+    byte::WriteStream ws{data};
+    CompressWriteStream cs{ws, method, 4096};
+    // Uneven writes so chunks straddle block boundaries
+    for (size_t pos = 0, step = 1; pos < input.size(); step = step * 3 % 997) {
+        auto const count = std::min(step, input.size() - pos);
+        cs.bytes(std::span{input}.subspan(pos), count);
+        pos += count;
+    }
+    REQUIRE(cs.byteSize() == input.size());
+    encodePrefixInt(cs, 123456);
+    REQUIRE(cs.flush().ok());
+    if (method != Method::Stored)
+        REQUIRE(ws.byteSize() < input.size() / 2);
+
+    byte::ReadStream rs{std::span<std::byte const>{data.data(), ws.byteSize()}};
+    DecompressReadStream ds{rs};
+    std::vector<std::byte> output(input.size());
+    for (size_t pos = 0, step = 5; pos < output.size();
+         step = step * 7 % 1013) {
+        auto const count = std::min(step, output.size() - pos);
+        ds.bytes(std::span{output}.subspan(pos), count);
+        pos += count;
+    }
+    REQUIRE(output == input);
+    uint64_t trailer = 0;
+    REQUIRE(decodePrefixInt(ds, trailer));
+    REQUIRE(trailer == 123456);
+    REQUIRE(ds.remainingBytes() == 0);
+
+    std::byte extra;
+    ds.bytes(std::span{&extra, 1}, 1);
+    REQUIRE(ds.error() == Error::Eof);
+}
+
+TEST_CASE("Compress stream stores incompressible blocks") {
+    auto input = randomBytes(5000, 9);
+    std::vector<std::byte> data(6000);
+    byte::WriteStream ws{data};
+    CompressWriteStream cs{ws, Method::Lz, 4096};
+    cs.bytes(input, input.size());
+    REQUIRE(cs.flush().ok());
+    // Two blocks, each a method byte and two small prefix ints of overhead
+    REQUIRE(ws.byteSize() <= input.size() + 2 * 5);
+    REQUIRE(data[0] == std::byte(Method::Stored));
+
+    byte::ReadStream rs{std::span<std::byte const>{data.data(), ws.byteSize()}};
+    DecompressReadStream ds{rs};
+    std::vector<std::byte> output(input.size());
+    REQUIRE(ds.bytes(output, output.size()).ok());
+    REQUIRE(output == input);
+}
+
+TEST_CASE("Decompress stream rejects corrupted block headers") {
+    auto input = textBytes(1000);
+    std::vector<std::byte> data(2000);
+    byte::WriteStream ws{data};
+    CompressWriteStream cs{ws};
+    cs.bytes(input, input.size());
+    REQUIRE(cs.flush().ok());
+
+    data[0] = std::byte{0x7f};
+    byte::ReadStream rs{std::span<std::byte const>{data.data(), ws.byteSize()}};
+    DecompressReadStream ds{rs};
+    std::vector<std::byte> output(input.size());
+    ds.bytes(output, output.size());
+    REQUIRE(ds.error() == Error::BadData);
+}
+
+TEST_CASE("Decompress stream peeks across block boundaries") {
+    auto input = textBytes(12);
+    std::vector<std::byte> data(64);
+    byte::WriteStream ws{data};
+    CompressWriteStream cs{ws, Method::Lz, 4};
+    cs.bytes(input, input.size());
+    REQUIRE(cs.flush().ok());
+
+    byte::ReadStream rs{std::span<std::byte const>{data.data(), ws.byteSize()}};
+    DecompressReadStream ds{rs};
+    std::vector<std::byte> peeked(10);
+    REQUIRE(ds.peek(peeked, peeked.size()));
+    REQUIRE(std::equal(peeked.begin(), peeked.end(), input.begin()));
+
+    std::vector<std::byte> output(input.size());
+    REQUIRE(ds.bytes(output, output.size()).ok());
+    REQUIRE(output == input);
+    REQUIRE_FALSE(ds.peek(peeked, 1));
+    REQUIRE(ds.ok());
+}
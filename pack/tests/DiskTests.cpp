@@ -0,0 +1,180 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include <ao/pack/Disk.h>
+
+using namespace ao::pack::disk;
+
+static std::vector<std::byte> bytesOf(std::initializer_list<int> values) {
+    std::vector<std::byte> ret;
+    for (auto v : values)
+        ret.push_back(std::byte(v));
+    return ret;
+}
+
+static std::vector<std::byte> cobsEncode(std::span<std::byte const> data) {
+    std::vector<std::byte> out;
+    CobsWriter cobs{out};
+    cobs.append(data);
+    cobs.finish();
+    return out;
+}
+
+// Bit at a time reference the table and hardware paths are checked against
+static uint32_t referenceCrc32c(std::span<std::byte const> data) {
+    uint32_t crc = ~0u;
+    for (auto b : data) {
+        crc ^= (uint8_t)b;
+        for (int bit = 0; bit < 8; ++bit)
+            crc = (crc >> 1) ^ ((crc & 1) ? 0x82f63b78 : 0);
+    }
+    return ~crc;
+}
+
+TEST_CASE("crc32c matches the Castagnoli check values") {
+    std::string_view check = "123456789";
+    auto data = std::as_bytes(std::span{check});
+    REQUIRE(crc32c(data) == 0xe3069283);
+    std::vector<std::byte> zeros(32);
+    REQUIRE(crc32c(zeros) == 0x8a9136aa);
+    REQUIRE(crc32c({}) == 0);
+}
+
+TEST_CASE("crc32c agrees with the reference at any length and offset") {
+    std::vector<std::byte> data(300);
+    uint32_t state = 1;
+    for (auto& b : data) {
+        state = state * 1103515245 + 12345;
+        b = std::byte(state >> 16);
+    }
+    for (size_t offset = 0; offset < 8; ++offset) {
+        for (size_t size = 0; size + offset <= data.size(); size += 7) {
+            auto slice = std::span<std::byte const>{data}.subspan(offset, size);
+            REQUIRE(crc32c(slice) == referenceCrc32c(slice));
+        }
+    }
+
+    auto all = std::span<std::byte const>{data};
+    REQUIRE(crc32c(all.subspan(100), crc32c(all.first(100))) ==
+            crc32c(all));
+}
+
+TEST_CASE("COBS encodes the reference vectors") {
+    REQUIRE(cobsEncode(bytesOf({})) == bytesOf({0x01}));
+    REQUIRE(cobsEncode(bytesOf({0x00})) == bytesOf({0x01, 0x01}));
+    REQUIRE(cobsEncode(bytesOf({0x00, 0x00})) ==
+            bytesOf({0x01, 0x01, 0x01}));
+    REQUIRE(cobsEncode(bytesOf({0x11, 0x22, 0x00, 0x33})) ==
+            bytesOf({0x03, 0x11, 0x22, 0x02, 0x33}));
+    REQUIRE(cobsEncode(bytesOf({0x11, 0x00, 0x00, 0x00})) ==
+            bytesOf({0x02, 0x11, 0x01, 0x01, 0x01}));
+
+    // A full run of 254 non-zero bytes needs no trailing block
+    std::vector<std::byte> run;
+    for (int i = 1; i <= 0xfe; ++i)
+        run.push_back(std::byte(i));
+    auto encoded = cobsEncode(run);
+    REQUIRE(encoded.size() == 255);
+    REQUIRE(encoded[0] == std::byte{0xff});
+
+    // One more byte starts a second block
+    run.push_back(std::byte{0xff});
+    encoded = cobsEncode(run);
+    REQUIRE(encoded.size() == 257);
+    REQUIRE(encoded[255] == std::byte{0x02});
+    REQUIRE(encoded[256] == std::byte{0xff});
+}
+
+TEST_CASE("COBS round trips data around block boundaries") {
+    for (size_t size : {0, 1, 253, 254, 255, 508, 509, 1000}) {
+        for (size_t zeroEvery : {0, 1, 3, 254, 255}) {
+            std::vector<std::byte> data(size);
+            for (size_t i = 0; i < size; ++i) {
+                bool zero = zeroEvery != 0 && i % zeroEvery == 0;
+                data[i] = zero ? std::byte{0} : std::byte(i % 255 + 1);
+            }
+            auto encoded = cobsEncode(data);
+            REQUIRE(encoded.size() <= cobsMaxEncodedSize(size));
+            for (auto b : encoded)
+                REQUIRE(b != std::byte{0});
+
+            std::vector<std::byte> decoded;
+            REQUIRE(cobsDecode(encoded, decoded));
+            REQUIRE(decoded == data);
+        }
+    }
+}
+
+TEST_CASE("COBS rejects malformed records") {
+    std::vector<std::byte> out;
+    REQUIRE_FALSE(cobsDecode(bytesOf({0x05, 0x11, 0x22}), out));
+    REQUIRE_FALSE(cobsDecode(bytesOf({0x03, 0x11, 0x00}), out));
+    REQUIRE_FALSE(cobsDecode(bytesOf({0x00}), out));
+}
+
+TEST_CASE("Disk records round trip through the encoder and decoder") {
+    EncoderContext ctx;
+    Encoder encoder{ctx};
+    std::vector<std::vector<std::byte>> payloads{
+        {},
+        bytesOf({0x00}),
+        bytesOf({0x01, 0x00, 0x02}),
+        std::vector<std::byte>(600, std::byte{0x7f}),
+    };
+    for (size_t i = 0; i < payloads.size(); ++i)
+        encoder.encode(i * 1000, payloads[i]);
+    REQUIRE(ctx.sizes.size() == payloads.size());
+
+    size_t total = 0;
+    for (auto size : ctx.sizes) {
+        total += size;
+        REQUIRE(ctx.data[total - 1] == std::byte{0});
+    }
+    REQUIRE(total == ctx.data.size());
+
+    Decoder decoder{ctx.data};
+    Record record;
+    for (size_t i = 0; i < payloads.size(); ++i) {
+        REQUIRE(decoder.next(record));
+        REQUIRE(record.messageId == i * 1000);
+        REQUIRE(std::vector(record.payload.begin(), record.payload.end()) ==
+                payloads[i]);
+    }
+    REQUIRE_FALSE(decoder.next(record));
+    REQUIRE(decoder.corruptRecords() == 0);
+}
+
+TEST_CASE("Disk decoder resynchronizes after corrupted records") {
+    EncoderContext ctx;
+    Encoder encoder{ctx};
+    auto payload = bytesOf({0x10, 0x20, 0x30, 0x40});
+    for (uint64_t id = 1; id <= 4; ++id)
+        encoder.encode(id, payload);
+
+    // Flip a payload bit in the second record and cut the last one short
+    auto data = ctx.data;
+    data[ctx.sizes[0] + 3] ^= std::byte{0x01};
+    data.pop_back();
+
+    // Garbage without a delimiter in front spoils the first record too
+    auto garbage = bytesOf({0x42, 0x13, 0x37});
+    data.insert(data.begin(), garbage.begin(), garbage.end());
+
+    Decoder decoder{data};
+    Record record;
+    std::vector<uint64_t> ids;
+    while (decoder.next(record)) {
+        REQUIRE(std::vector(record.payload.begin(), record.payload.end()) ==
+                payload);
+        ids.push_back(record.messageId);
+    }
+    REQUIRE(ids == std::vector<uint64_t>{3});
+    REQUIRE(decoder.corruptRecords() == 3);
+    REQUIRE(decoder.position() == data.size());
+}
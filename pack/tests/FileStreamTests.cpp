@@ -0,0 +1,81 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+#include <ao/pack/FileStream.h>
+#include <ao/pack/Varint.h>
+
+#include "Helpers.h"
+
+using namespace ao::pack;
+using namespace ao::pack::byte;
+
+TEST_CASE("File streams round trip small and large writes") {
+    TempFile file{"round_trip"};
+    auto large = pattern(100000);
+    std::vector<uint64_t> values;
+    for (uint64_t i = 0; i < 5000; ++i)
+        values.push_back(i * i * 977);
+
+    {
+        // A small buffer so writes straddle it and large ones bypass it
+        FileWriteStream ws{file.path, FileWriteMode::Truncate, 256};
+        for (auto v : values)
+            encodePrefixInt(ws, v);
+        ws.bytes(large, large.size());
+        ws.bytes(large, 10);
+        REQUIRE(ws.flush().ok());
+        REQUIRE(std::filesystem::file_size(file.path) == ws.byteSize());
+    }
+
+    FileReadStream rs{file.path, 256};
+    REQUIRE(rs.ok());
+    for (auto v : values) {
+        uint64_t out = 0;
+        REQUIRE(decodePrefixInt(rs, out));
+        REQUIRE(out == v);
+    }
+    std::vector<std::byte> out(large.size());
+    REQUIRE(rs.bytes(out, out.size()).ok());
+    REQUIRE(out == large);
+
+    std::vector<std::byte> peeked(10);
+    REQUIRE(rs.peek(peeked, peeked.size()));
+    REQUIRE(rs.remainingBytes() == 10);
+    REQUIRE(rs.advance(4).ok());
+    REQUIRE(rs.bytes(out, 6).ok());
+    REQUIRE(std::equal(out.begin(), out.begin() + 6, large.begin() + 4));
+    REQUIRE(rs.remainingBytes() == 0);
+
+    rs.bytes(out, 1);
+    REQUIRE(rs.error() == Error::Eof);
+}
+
+TEST_CASE("FileWriteStream appends and flushes on destruction") {
+    TempFile file{"append"};
+    auto data = pattern(1000);
+    {
+        FileWriteStream ws{file.path};
+        ws.bytes(data, 600);
+    }
+    {
+        FileWriteStream ws{file.path, FileWriteMode::Append};
+        ws.bytes(std::span{data}.subspan(600), 400);
+    }
+
+    REQUIRE(file.contents() == data);
+}
+
+TEST_CASE("File streams report files that cannot be opened") {
+    auto missing = std::filesystem::temp_directory_path() / "ao_pack_missing" /
+                   "file.bin";
+    FileReadStream rs{missing};
+    REQUIRE(rs.error() == Error::StreamError);
+    FileWriteStream ws{missing};
+    REQUIRE(ws.error() == Error::StreamError);
+}
@@ -0,0 +1,120 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <ao/pack/ByteStream.h>
+#include <ao/pack/Disk.h>
+#include <ao/pack/HashingStream.h>
+
+#include "Helpers.h"
+
+using ao::pack::HashingStream;
+using ao::pack::byte::ReadStream;
+using ao::pack::byte::WriteStream;
+
+namespace {
+// Order sensitive hash that also records how it was fed
+struct RecordingHasher {
+    void update(std::span<std::byte const> data) {
+        crc = ao::pack::disk::crc32c(data, crc);
+        if (updates)
+            updates->push_back(data.size());
+    }
+    uint32_t digest() const { return crc; }
+    void reset() {
+        crc = 0;
+        if (updates)
+            updates->clear();
+    }
+
+    uint32_t crc = 0;
+    std::vector<size_t>* updates = nullptr;
+};
+}  // namespace
+
+TEST_CASE("HashingStream gathers small writes into chunks") {
+    using Hashing = HashingStream<WriteStream, RecordingHasher>;
+    auto const data = pattern(3 * Hashing::kChunkSize + 100);
+    std::vector<std::byte> buf(data.size());
+    WriteStream writer{buf};
+    std::vector<size_t> updates;
+    Hashing stream{writer, RecordingHasher{.updates = &updates}};
+    stream.enableHashing();
+
+    for (size_t i = 0; i < data.size(); i += 4)
+        stream.bytes(std::span(data).subspan(i), 4);
+    REQUIRE(writer.ok());
+    REQUIRE(stream.digest() == ao::pack::disk::crc32c(data));
+    REQUIRE(buf == data);
+    REQUIRE(updates == std::vector<size_t>{Hashing::kChunkSize,
+                                           Hashing::kChunkSize,
+                                           Hashing::kChunkSize, 100});
+}
+
+TEST_CASE("HashingStream passes large spans straight to the hasher") {
+    using Hashing = HashingStream<WriteStream, RecordingHasher>;
+    auto const data = pattern(Hashing::kChunkSize * 2 + 7);
+    std::vector<std::byte> buf(data.size());
+    WriteStream writer{buf};
+    std::vector<size_t> updates;
+    Hashing stream{writer, RecordingHasher{.updates = &updates}};
+    stream.enableHashing();
+
+    stream.bytes(std::span(data).first(3), 3);
+    stream.bytes(std::span(data).subspan(3), Hashing::kChunkSize * 2);
+    stream.bytes(std::span(data).last(4), 4);
+    REQUIRE(stream.digest() == ao::pack::disk::crc32c(data));
+    REQUIRE(updates ==
+            std::vector<size_t>{3, Hashing::kChunkSize * 2, 4});
+}
+
+TEST_CASE("HashingStream only hashes while enabled") {
+    using Hashing = HashingStream<ReadStream, RecordingHasher>;
+    auto const data = pattern(64);
+    ReadStream reader{data};
+    Hashing stream{reader};
+    std::vector<std::byte> out(data.size());
+
+    stream.bytes(std::span(out), 8);
+    stream.enableHashing();
+    stream.bytes(std::span(out).subspan(8), 16);
+    auto const first = stream.digest();
+    stream.bytes(std::span(out).subspan(24), 16);
+    stream.disableHashing();
+    stream.bytes(std::span(out).subspan(40), 24);
+
+    REQUIRE(reader.ok());
+    REQUIRE(out == data);
+    REQUIRE(first == ao::pack::disk::crc32c(std::span(data).subspan(8, 16)));
+    REQUIRE(stream.digest() ==
+            ao::pack::disk::crc32c(std::span(data).subspan(8, 32)));
+
+    // Enabling again starts from scratch and drops anything pending
+    stream.enableHashing();
+    REQUIRE(stream.digest() == 0);
+}
+
+TEST_CASE("HashingStream gathers into a caller provided buffer") {
+    using Hashing = HashingStream<WriteStream, RecordingHasher>;
+    auto const data = pattern(200);
+    std::vector<std::byte> pending(64);
+
+    // Streams built one after another share the buffer
+    for (int round = 0; round < 2; ++round) {
+        std::vector<std::byte> buf(data.size());
+        WriteStream writer{buf};
+        std::vector<size_t> updates;
+        Hashing stream{writer, RecordingHasher{.updates = &updates},
+                       pending};
+        stream.enableHashing();
+
+        for (size_t i = 0; i < data.size(); i += 4)
+            stream.bytes(std::span(data).subspan(i), 4);
+        REQUIRE(stream.digest() == ao::pack::disk::crc32c(data));
+        REQUIRE(buf == data);
+        REQUIRE(updates == std::vector<size_t>{64, 64, 64, 8});
+    }
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <system_error>
+#include <vector>
+
+// Deterministic bytes that do not repeat with a short period. The xxh3
+// reference vectors are computed over pattern(size) with seed 0.
+inline std::vector<std::byte> pattern(size_t size, uint8_t seed = 0) {
+    std::vector<std::byte> ret(size);
+    for (size_t i = 0; i < size; ++i)
+        ret[i] = std::byte(seed + i * 131 + (i >> 8));
+    return ret;
+}
+
+// A file in the temp directory that is removed again on destruction
+struct TempFile {
+    explicit TempFile(std::string const& name)
+        : path(std::filesystem::temp_directory_path() /
+               ("ao_pack_" + name + ".bin")) {
+        std::filesystem::remove(path);
+    }
+    TempFile(std::string const& name, std::vector<std::byte> const& data)
+        : TempFile(name) {
+        std::ofstream out{path, std::ios::binary | std::ios::trunc};
+        out.write(reinterpret_cast<char const*>(data.data()),
+                  (std::streamsize)data.size());
+    }
+    TempFile(TempFile const&) = delete;
+    TempFile& operator=(TempFile const&) = delete;
+    ~TempFile() {
+        if (file)
+            std::fclose(file);
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+    }
+
+    // Opens the file for raw descriptor writes on first use
+    int fd() {
+        if (!file)
+            file = std::fopen(path.string().c_str(), "w+b");
+        if (!file)
+            return -1;
+#if defined(_WIN32)
+        return _fileno(file);
+#else
+        return fileno(file);
+#endif
+    }
+    std::vector<std::byte> contents() const {
+        std::ifstream in{path, std::ios::binary};
+        std::vector<char> data{std::istreambuf_iterator<char>{in}, {}};
+        auto const* begin = reinterpret_cast<std::byte const*>(data.data());
+        return {begin, begin + data.size()};
+    }
+
+    std::filesystem::path path;
+    std::FILE* file = nullptr;
+};
@@ -0,0 +1,77 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include <ao/pack/MmapStream.h>
+#include <ao/pack/Varint.h>
+
+#include "Helpers.h"
+
+using namespace ao::pack;
+using namespace ao::pack::byte;
+
+TEST_CASE("MmapReadStream reads and views a mapped file") {
+    std::vector<std::byte> data(64);
+    WriteStream ws{data};
+    encodePrefixInt(ws, 300);
+    std::vector<std::byte> payload(40);
+    for (size_t i = 0; i < payload.size(); ++i)
+        payload[i] = std::byte(i + 1);
+    ws.bytes(payload, payload.size());
+    data.resize(ws.byteSize());
+    TempFile file{"mmap_read", data};
+
+    MmapReadStream rs{file.path};
+    REQUIRE(rs.ok());
+    REQUIRE(rs.remainingBytes() == data.size());
+    uint64_t length = 0;
+    REQUIRE(decodePrefixInt(rs, length));
+    REQUIRE(length == 300);
+
+    auto view = rs.view(10);
+    REQUIRE(view.size() == 10);
+    // Views point into the mapping rather than a copy
+    REQUIRE(view.data() == rs.file()->bytes().data() + rs.position() - 10);
+    REQUIRE(std::equal(view.begin(), view.end(), payload.begin()));
+
+    std::vector<std::byte> out(30);
+    REQUIRE(rs.bytes(out, out.size()).ok());
+    REQUIRE(std::equal(out.begin(), out.end(), payload.begin() + 10));
+    REQUIRE(rs.remainingBytes() == 0);
+
+    REQUIRE(rs.view(1).empty());
+    REQUIRE(rs.error() == Error::Eof);
+}
+
+TEST_CASE("MmapReadStream views outlive the stream through file()") {
+    std::vector<std::byte> data{std::byte{1}, std::byte{2}, std::byte{3}};
+    TempFile file{"mmap_keep", data};
+
+    std::shared_ptr<MappedFile const> mapping;
+    std::span<std::byte const> view;
+    {
+        MmapReadStream rs{file.path, AccessHint::Random};
+        view = rs.view(3);
+        mapping = rs.file();
+    }
+    REQUIRE(std::vector(view.begin(), view.end()) == data);
+}
+
+TEST_CASE("MmapReadStream handles empty and missing files") {
+    TempFile file{"mmap_empty", {}};
+    MmapReadStream empty{file.path};
+    REQUIRE(empty.ok());
+    REQUIRE(empty.remainingBytes() == 0);
+    REQUIRE(empty.view(0).empty());
+    REQUIRE(empty.ok());
+
+    MmapReadStream missing{std::filesystem::temp_directory_path() /
+                           "ao_pack_missing" / "file.bin"};
+    REQUIRE(missing.error() == Error::StreamError);
+}
@@ -8,8 +8,9 @@
 #include <span>
 #include <vector>
 
+#include <ao/pack/BitStream.h>
 #include <ao/pack/ByteStream.h>
-#include <ao/pack/VarInt.h>
+#include <ao/pack/Varint.h>
 
 using namespace ao::pack;
 using namespace ao::pack::byte;
@@ -671,3 +672,128 @@ TEST_CASE("FUZZ: WriteStream overflow boundary using sizing oracle") {
         REQUIRE(ws.error() == Error::Overflow);
     }
 }
+
+TEST_CASE("PrefixInt: bit streams match the byte encoding at any bit offset") {
+    std::mt19937_64 rng(0xB175B175ULL);
+    std::vector<uint64_t> values = {
+        0ULL,
+        127ULL,
+        128ULL,
+        16384ULL,
+        (1ULL << 49),
+        (1ULL << 56) - 1,
+        (1ULL << 56),
+        std::numeric_limits<uint64_t>::max(),
+    };
+    for (int i = 0; i < 64; ++i)
+        values.push_back(rng() >> (i % 64));
+
+    for (uint64_t v : values) {
+        std::array<std::uint8_t, 16> expected{};
+        WriteStream ws(asBytes(std::span{expected}));
+        REQUIRE(encodePrefixInt(ws, v));
+        size_t const n = ws.byteSize();
+
+        for (size_t offset = 0; offset < 8; ++offset) {
+            INFO("Value: " << v << " offset: " << offset);
+            std::array<std::byte, 16> buf{};
+            bit::WriteStream bws{buf};
+            bws.bits(0, offset);
+            REQUIRE(encodePrefixInt(bws, v));
+            REQUIRE(bws.bitSize() == offset + n * 8);
+
+            std::array<std::byte, 16> encoded{};
+            uint64_t skip = 0;
+            bit::ReadStream raw{buf};
+            raw.bits(skip, offset).bytes(encoded, n);
+            REQUIRE(raw.ok());
+            REQUIRE(std::equal(encoded.begin(), encoded.begin() + n,
+                               asConstBytes(expected).begin()));
+
+            uint64_t out = 0;
+            bit::ReadStream rs{{buf.data(), bws.byteSize()}};
+            rs.bits(skip, offset);
+            REQUIRE(decodePrefixInt(rs, out));
+            REQUIRE(out == v);
+            REQUIRE(rs.position().bitPos == offset + n * 8);
+
+            bit::ReadStream truncated{{buf.data(), bws.byteSize() - 1}};
+            truncated.bits(skip, offset);
+            REQUIRE_FALSE(decodePrefixInt(truncated, out));
+            REQUIRE(truncated.error() == Error::Eof);
+        }
+    }
+}
+
+TEST_CASE("Varint batch: matches the scalar encoding and decoding") {
+    std::mt19937_64 rng(0xBA7C4ULL);
+    std::vector<uint64_t> values = {
+        0ULL,
+        127ULL,
+        128ULL,
+        (1ULL << 56) - 1,
+        (1ULL << 56),
+        (1ULL << 63),
+        std::numeric_limits<uint64_t>::max(),
+    };
+    for (int i = 0; i < 2000; ++i)
+        values.push_back(rng() >> (rng() % 64));
+
+    std::vector<std::uint8_t> expected(values.size() * 10);
+    WriteStream scalar(asBytes(std::span{expected}));
+    for (uint64_t v : values)
+        REQUIRE(encodeVarint(scalar, v));
+    expected.resize(scalar.byteSize());
+
+    std::vector<std::uint8_t> buf(values.size() * 10);
+    WriteStream ws(asBytes(std::span{buf}));
+    REQUIRE(encodeVarintBatch(ws, std::span<uint64_t const>{values}));
+    REQUIRE(ws.byteSize() == expected.size());
+    buf.resize(ws.byteSize());
+    REQUIRE(buf == expected);
+
+    SECTION("byte stream") {
+        std::vector<uint64_t> out(values.size());
+        ReadStream rs(asConstBytes(std::span<std::uint8_t const>{buf}));
+        REQUIRE(decodeVarintBatch(rs, std::span{out}));
+        REQUIRE(out == values);
+        REQUIRE(rs.remainingBytes() == 0);
+    }
+
+    SECTION("unaligned bit stream") {
+        std::vector<std::byte> bits(buf.size() + 1);
+        bit::WriteStream bws{bits};
+        bws.bits(0b101, 3);
+        REQUIRE(encodeVarintBatch(bws, std::span<uint64_t const>{values}));
+
+        std::vector<uint64_t> out(values.size());
+        uint64_t prefix = 0;
+        bit::ReadStream rs{bits};
+        rs.bits(prefix, 3);
+        REQUIRE(decodeVarintBatch(rs, std::span{out}));
+        REQUIRE(out == values);
+        REQUIRE(rs.position().bitPos == bws.bitSize());
+    }
+
+    SECTION("truncated input fails with Eof") {
+        std::vector<uint64_t> out(values.size());
+        ReadStream rs(asConstBytes(
+            std::span<std::uint8_t const>{buf.data(), buf.size() - 1}));
+        REQUIRE_FALSE(decodeVarintBatch(rs, std::span{out}));
+        REQUIRE(rs.error() == Error::Eof);
+    }
+}
+
+TEST_CASE("Varint batch: rejects overlong varints like decodeVarint") {
+    std::vector<std::uint8_t> buf = {0x01, 0x02};
+    for (int i = 0; i < 10; ++i)
+        buf.push_back(0x80);
+    buf.push_back(0x00);
+
+    std::array<uint64_t, 3> out{};
+    ReadStream rs(asConstBytes(std::span<std::uint8_t const>{buf}));
+    REQUIRE_FALSE(decodeVarintBatch(rs, std::span{out}));
+    REQUIRE(out[0] == 1);
+    REQUIRE(out[1] == 2);
+    REQUIRE(rs.error() == Error::BadData);
+}
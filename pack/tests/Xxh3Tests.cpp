@@ -0,0 +1,75 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <ao/pack/Xxh3.h>
+
+#include "Helpers.h"
+
+using namespace ao::pack::xxh3;
+
+namespace {
+struct Vector {
+    size_t size;
+    uint64_t low;
+    uint64_t high;
+};
+
+// Produced by XXH3_128bits() from the reference xxHash over pattern(size),
+// one size on each side of every length class
+constexpr Vector kVectors[] = {
+    {0, 0x6001c324468d497fULL, 0x99aa06d3014798d8ULL},
+    {1, 0xc44bdff4074eecdbULL, 0xa6cd5e9392000f6aULL},
+    {3, 0x6811538b444fc6dcULL, 0xc925ae1797c3998fULL},
+    {4, 0xdb9cecd5eb59a7f1ULL, 0x6ae518c60df23fcaULL},
+    {8, 0x5b3f49d0f38f9d7dULL, 0x63f350efc0ba3e2eULL},
+    {9, 0xd8a20b5b7aa68a37ULL, 0x83c871b1014e6f76ULL},
+    {16, 0xadebb1d9d080b69cULL, 0x248181305d3c1039ULL},
+    {17, 0xcfea252f6b7ed7e9ULL, 0x825a0db7d0afe2c0ULL},
+    {128, 0x5cfea347ea4bb687ULL, 0x08df79f520370b52ULL},
+    {129, 0x821740ece8839b64ULL, 0xfc1d02037be48a62ULL},
+    {240, 0x687f00a7f64e46dbULL, 0x8406fbd017acdf4eULL},
+    {241, 0x44dbd3180a664e27ULL, 0xd894c74b1b3ea28fULL},
+    {1024, 0xc6c700c409d40c4bULL, 0x866814b8303d6907ULL},
+    {1025, 0x3ef78c3256f23450ULL, 0xf91cd5a698df6097ULL},
+    {100000, 0x45169176f633139fULL, 0x222a45d78d28b136ULL},
+};
+}  // namespace
+
+TEST_CASE("xxh3 hash128 matches the reference implementation") {
+    for (auto const& v : kVectors) {
+        INFO("size " << v.size);
+        auto const hash = hash128(pattern(v.size));
+        REQUIRE(hash.low == v.low);
+        REQUIRE(hash.high == v.high);
+    }
+}
+
+TEST_CASE("xxh3 streaming digest does not depend on how input is split") {
+    for (auto const& v : kVectors) {
+        auto const data = pattern(v.size);
+        for (size_t step : {1, 7, 64, 255, 256, 257, 5000}) {
+            INFO("size " << v.size << " step " << step);
+            Hasher128 hasher;
+            for (size_t i = 0; i < data.size(); i += step) {
+                hasher.update(
+                    std::span(data).subspan(i, std::min(step, v.size - i)));
+            }
+            REQUIRE(hasher.digest() == Hash128{.low = v.low, .high = v.high});
+        }
+    }
+}
+
+TEST_CASE("xxh3 digest leaves the hasher usable") {
+    auto const data = pattern(1000);
+    Hasher128 hasher;
+    hasher.update(std::span(data).first(500));
+    REQUIRE(hasher.digest() == hash128(std::span(data).first(500)));
+    hasher.update(std::span(data).subspan(500));
+    REQUIRE(hasher.digest() == hash128(data));
+    hasher.reset();
+    REQUIRE(hasher.digest() == hash128({}));
+}
@@ -1,6 +1,7 @@
 #include <cstdint>
 #include <limits>
 #include <random>
+#include <vector>
 
 #include "ao/pack/ZigZag.h"
 #include <catch2/catch_all.hpp>
@@ -169,3 +170,46 @@ TEST_CASE("ZigZag randomized round-trip with extra weight near limits",
         check(dist(rng));
     }
 }
+
+TEST_CASE("ZigZag deltas round trip through the batch decode",
+          "[zigzag][delta]") {
+    std::mt19937_64 rng(0xDE17AULL);
+
+    // Every tail length for the blocked prefix sum
+    for (size_t size = 0; size < 13; ++size) {
+        std::vector<uint64_t> values(size);
+        for (auto& v : values)
+            v = rng();
+        if (size > 2) {
+            values[1] = 0;
+            values[2] = U64_MAX;
+        }
+
+        std::vector<uint64_t> deltas;
+        uint64_t previous = 0;
+        for (auto v : values) {
+            deltas.push_back(encodeZigZagDelta(previous, v));
+            previous = v;
+        }
+
+        INFO("size = " << size);
+        REQUIRE(decodeZigZagDeltas(deltas) == previous);
+        REQUIRE(deltas == values);
+    }
+}
+
+TEST_CASE("ZigZag deltas of monotone values stay small", "[zigzag][delta]") {
+    std::vector<uint64_t> deltas;
+    uint64_t previous = 0;
+    for (uint64_t v = 1000; v < 1010; ++v) {
+        deltas.push_back(encodeZigZagDelta(previous, v));
+        previous = v;
+    }
+    REQUIRE(deltas[0] == 2000ULL);
+    for (size_t i = 1; i < deltas.size(); ++i)
+        REQUIRE(deltas[i] == 2ULL);
+
+    REQUIRE(decodeZigZagDeltas(deltas, 0) == 1009ULL);
+    REQUIRE(deltas.front() == 1000ULL);
+    REQUIRE(deltas.back() == 1009ULL);
+}